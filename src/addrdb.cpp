@@ -104,6 +104,24 @@ bool DeserializeFileDB(const fs::path& path, Data& data)
     return DeserializeDB(filein, data);
 }
 
+// The checksum SerializeDB ends a file with, which identifies the data written
+bool ReadFileDBChecksum(const fs::path& path, uint256& hash)
+{
+    FILE *file = fsbridge::fopen(path, "rb");
+    CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("%s: Failed to open file %s", __func__, path.string());
+
+    try {
+        if (fseek(filein.Get(), -(long)sizeof(hash), SEEK_END) != 0)
+            return error("%s: Failed to seek in file %s", __func__, path.string());
+        filein >> hash;
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    }
+    return true;
+}
+
 }
 
 CBanDB::CBanDB()
@@ -124,16 +142,117 @@ bool CBanDB::Read(banmap_t& banSet)
 CAddrDB::CAddrDB()
 {
     pathAddr = GetDataDir() / "peers.dat";
+    pathLog = GetDataDir() / "peers.log";
 }
 
-bool CAddrDB::Write(const CAddrMan& addr)
+bool CAddrDB::Write(CAddrMan& addr)
 {
-    return SerializeFileDB("peers", pathAddr, addr);
+    // Everything changed so far is part of the snapshot
+    std::vector<CAddrLogEntry> vChanges;
+    addr.TakeChanges(vChanges);
+
+    if (!SerializeFileDB("peers", pathAddr, addr)) {
+        addr.ReturnChanges(vChanges);
+        return false;
+    }
+
+    // Batches left in the log are stamped with the previous snapshot's checksum, so replay skips them even if
+    // this fails or is cut short
+    try {
+        fs::remove(pathLog);
+    } catch (const fs::filesystem_error& e) {
+        LogPrintf("%s: Failed to remove %s: %s\n", __func__, pathLog.string(), e.what());
+    }
+    return true;
+}
+
+bool CAddrDB::Append(CAddrMan& addr)
+{
+    std::vector<CAddrLogEntry> vChanges;
+    addr.TakeChanges(vChanges);
+    if (vChanges.empty())
+        return true;
+
+    uint256 hashSnapshot;
+    if (!ReadFileDBChecksum(pathAddr, hashSnapshot)) {
+        addr.ReturnChanges(vChanges);
+        return false;
+    }
+
+    // Each batch is framed like a snapshot: magic, data, checksum. The data starts with the checksum of the
+    // snapshot it applies to
+    CDataStream ssBatch(SER_DISK, CLIENT_VERSION);
+    if (!SerializeDB(ssBatch, std::make_pair(hashSnapshot, vChanges))) {
+        addr.ReturnChanges(vChanges);
+        return false;
+    }
+
+    FILE *file = fsbridge::fopen(pathLog, "ab");
+    CAutoFile fileout(file, SER_DISK, CLIENT_VERSION);
+    if (fileout.IsNull()) {
+        addr.ReturnChanges(vChanges);
+        return error("%s: Failed to open file %s", __func__, pathLog.string());
+    }
+
+    // Unbuffered, so no part of a failed batch can be written out after it is truncated away below
+    setvbuf(fileout.Get(), nullptr, _IONBF, 0);
+    long nSize = fseek(fileout.Get(), 0, SEEK_END) == 0 ? ftell(fileout.Get()) : -1;
+    bool fWritten = nSize >= 0 && fwrite(ssBatch.data(), 1, ssBatch.size(), fileout.Get()) == ssBatch.size();
+    if (!fWritten) {
+        // Drop a partly written batch, replay would stop at it and miss the batches appended after
+        if (nSize >= 0)
+            TruncateFile(fileout.Get(), nSize);
+        addr.ReturnChanges(vChanges);
+        return error("%s: Failed to append to %s", __func__, pathLog.string());
+    }
+    FileCommit(fileout.Get());
+    return true;
 }
 
 bool CAddrDB::Read(CAddrMan& addr)
 {
-    return DeserializeFileDB(pathAddr, addr);
+    if (!DeserializeFileDB(pathAddr, addr))
+        return false;
+
+    uint256 hashSnapshot;
+    if (!ReadFileDBChecksum(pathAddr, hashSnapshot))
+        return false;
+    return ReadLog(addr, hashSnapshot);
+}
+
+bool CAddrDB::ReadLog(CAddrMan& addr, const uint256& hashSnapshot)
+{
+    FILE *file = fsbridge::fopen(pathLog, "rb");
+    CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return true; // nothing changed since the snapshot
+
+    int nBatches = 0;
+    int nStale = 0;
+    while (true) {
+        int c = fgetc(filein.Get());
+        if (c == EOF)
+            break;
+        ungetc(c, filein.Get());
+
+        std::pair<uint256, std::vector<CAddrLogEntry>> batch;
+        if (!DeserializeDB(filein, batch)) {
+            // A batch cut short by an unclean shutdown; the ones before it are intact
+            LogPrintf("Ignoring the rest of %s after %d batches\n", pathLog.string(), nBatches);
+            break;
+        }
+
+        // Left over from before the snapshot was rewritten, its changes are already in there
+        if (batch.first != hashSnapshot) {
+            nStale++;
+            continue;
+        }
+        addr.ApplyChanges(batch.second);
+        nBatches++;
+    }
+    if (nStale)
+        LogPrintf("Ignored %d batches of %s written for an older peers.dat\n", nStale, pathLog.string());
+    return true;
 }
 
 bool CAddrDB::Read(CAddrMan& addr, CDataStream& ssPeers)
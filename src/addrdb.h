@@ -16,6 +16,7 @@
 class CSubNet;
 class CAddrMan;
 class CDataStream;
+class uint256;
 
 typedef enum BanReason
 {
@@ -77,14 +78,24 @@ public:
 
 typedef std::map<CSubNet, CBanEntry> banmap_t;
 
-/** Access to the (IP) address database (peers.dat) */
+/**
+ * Access to the (IP) address database: a full snapshot (peers.dat) and a log
+ * of the entries changed since it was written (peers.log)
+ */
 class CAddrDB
 {
 private:
     fs::path pathAddr;
+    fs::path pathLog;
+
+    bool ReadLog(CAddrMan& addr, const uint256& hashSnapshot);
 public:
     CAddrDB();
-    bool Write(const CAddrMan& addr);
+    //! Write a new snapshot, which replaces the change log
+    bool Write(CAddrMan& addr);
+    //! Append the entries changed since the last Write or Append to the change log
+    bool Append(CAddrMan& addr);
+    //! Read the snapshot and replay the change log over it
     bool Read(CAddrMan& addr);
     static bool Read(CAddrMan& addr, CDataStream& ssPeers);
 };
@@ -91,6 +91,7 @@ CAddrInfo* CAddrMan::Create(const CAddress& addr, const CNetAddr& addrSource, in
     int nId = nIdCount++;
     mapInfo[nId] = CAddrInfo(addr, addrSource);
     mapAddr[addr] = nId;
+    setDeleted.erase(addr);
     mapInfo[nId].nRandomPos = vRandom.size();
     vRandom.push_back(nId);
     if (pnId)
@@ -128,10 +129,37 @@ void CAddrMan::Delete(int nId)
     SwapRandom(info.nRandomPos, vRandom.size() - 1);
     vRandom.pop_back();
     mapAddr.erase(info);
+    setDirty.erase(nId);
+    setDeleted.insert(info);
     mapInfo.erase(nId);
     nNew--;
 }
 
+void CAddrMan::Remove(int nId)
+{
+    CAddrInfo& info = mapInfo[nId];
+
+    if (info.fInTried) {
+        int nKBucket = info.GetTriedBucket(nKey);
+        int nKBucketPos = info.GetBucketPosition(nKey, false, nKBucket);
+        assert(vvTried[nKBucket][nKBucketPos] == nId);
+        SetTried(nKBucket, nKBucketPos, -1);
+        info.fInTried = false;
+        nTried--;
+        nNew++; // Delete counts it out of the new table
+    } else {
+        for (int bucket = 0; bucket < ADDRMAN_NEW_BUCKET_COUNT && info.nRefCount > 0; bucket++) {
+            int pos = info.GetBucketPosition(nKey, true, bucket);
+            if (vvNew[bucket][pos] == nId) {
+                SetNew(bucket, pos, -1);
+                info.nRefCount--;
+            }
+        }
+    }
+
+    Delete(nId);
+}
+
 void CAddrMan::ClearNew(int nUBucket, int nUBucketPos)
 {
     // if there is an entry in the specified bucket, delete it.
@@ -140,7 +168,7 @@ void CAddrMan::ClearNew(int nUBucket, int nUBucketPos)
         CAddrInfo& infoDelete = mapInfo[nIdDelete];
         assert(infoDelete.nRefCount > 0);
         infoDelete.nRefCount--;
-        vvNew[nUBucket][nUBucketPos] = -1;
+        SetNew(nUBucket, nUBucketPos, -1);
         if (infoDelete.nRefCount == 0) {
             Delete(nIdDelete);
         }
@@ -153,7 +181,7 @@ void CAddrMan::MakeTried(CAddrInfo& info, int nId)
     for (int bucket = 0; bucket < ADDRMAN_NEW_BUCKET_COUNT; bucket++) {
         int pos = info.GetBucketPosition(nKey, true, bucket);
         if (vvNew[bucket][pos] == nId) {
-            vvNew[bucket][pos] = -1;
+            SetNew(bucket, pos, -1);
             info.nRefCount--;
         }
     }
@@ -174,7 +202,8 @@ void CAddrMan::MakeTried(CAddrInfo& info, int nId)
 
         // Remove the to-be-evicted item from the tried set.
         infoOld.fInTried = false;
-        vvTried[nKBucket][nKBucketPos] = -1;
+        SetTried(nKBucket, nKBucketPos, -1);
+        setDirty.insert(nIdEvict);
         nTried--;
 
         // find which new bucket it belongs to
@@ -185,14 +214,15 @@ void CAddrMan::MakeTried(CAddrInfo& info, int nId)
 
         // Enter it into the new set again.
         infoOld.nRefCount = 1;
-        vvNew[nUBucket][nUBucketPos] = nIdEvict;
+        SetNew(nUBucket, nUBucketPos, nIdEvict);
         nNew++;
     }
     assert(vvTried[nKBucket][nKBucketPos] == -1);
 
-    vvTried[nKBucket][nKBucketPos] = nId;
+    SetTried(nKBucket, nKBucketPos, nId);
     nTried++;
     info.fInTried = true;
+    setDirty.insert(nId);
 }
 
 void CAddrMan::Good_(const CService& addr, int64_t nTime)
@@ -214,6 +244,7 @@ void CAddrMan::Good_(const CService& addr, int64_t nTime)
         return;
 
     // update info
+    setDirty.insert(nId);
     info.nLastSuccess = nTime;
     info.nLastTry = nTime;
     info.nAttempts = 0;
@@ -262,6 +293,8 @@ bool CAddrMan::Add_(const CAddress& addr, const CNetAddr& source, int64_t nTimeP
     }
 
     if (pinfo) {
+        setDirty.insert(nId);
+
         // periodically update nTime
         bool fCurrentlyOnline = (GetAdjustedTime() - addr.nTime < 24 * 60 * 60);
         int64_t nUpdateInterval = (fCurrentlyOnline ? 60 * 60 : 24 * 60 * 60);
@@ -294,6 +327,7 @@ bool CAddrMan::Add_(const CAddress& addr, const CNetAddr& source, int64_t nTimeP
         pinfo->nTime = std::max((int64_t)0, (int64_t)pinfo->nTime - nTimePenalty);
         nNew++;
         fNew = true;
+        setDirty.insert(nId);
     }
 
     int nUBucket = pinfo->GetNewBucket(nKey, source);
@@ -310,7 +344,7 @@ bool CAddrMan::Add_(const CAddress& addr, const CNetAddr& source, int64_t nTimeP
         if (fInsert) {
             ClearNew(nUBucket, nUBucketPos);
             pinfo->nRefCount++;
-            vvNew[nUBucket][nUBucketPos] = nId;
+            SetNew(nUBucket, nUBucketPos, nId);
         } else {
             if (pinfo->nRefCount == 0) {
                 Delete(nId);
@@ -322,7 +356,8 @@ bool CAddrMan::Add_(const CAddress& addr, const CNetAddr& source, int64_t nTimeP
 
 void CAddrMan::Attempt_(const CService& addr, bool fCountFailure, int64_t nTime)
 {
-    CAddrInfo* pinfo = Find(addr);
+    int nId;
+    CAddrInfo* pinfo = Find(addr, &nId);
 
     // if not found, bail out
     if (!pinfo)
@@ -335,6 +370,7 @@ void CAddrMan::Attempt_(const CService& addr, bool fCountFailure, int64_t nTime)
         return;
 
     // update info
+    setDirty.insert(nId);
     info.nLastTry = nTime;
     if (fCountFailure && info.nLastCountAttempt < nLastGood) {
         info.nLastCountAttempt = nTime;
@@ -356,12 +392,9 @@ CAddrInfo CAddrMan::Select_(bool newOnly)
         // use a tried node
         double fChanceFactor = 1.0;
         while (1) {
-            int nKBucket = RandomInt(ADDRMAN_TRIED_BUCKET_COUNT);
-            int nKBucketPos = RandomInt(ADDRMAN_BUCKET_SIZE);
-            while (vvTried[nKBucket][nKBucketPos] == -1) {
-                nKBucket = (nKBucket + insecure_rand.randbits(ADDRMAN_TRIED_BUCKET_COUNT_LOG2)) % ADDRMAN_TRIED_BUCKET_COUNT;
-                nKBucketPos = (nKBucketPos + insecure_rand.randbits(ADDRMAN_BUCKET_SIZE_LOG2)) % ADDRMAN_BUCKET_SIZE;
-            }
+            // pick a random non-empty bucket, then a random entry in it
+            int nKBucket = triedOccupancy.UsedBucket(RandomInt(triedOccupancy.UsedBuckets()));
+            int nKBucketPos = triedOccupancy.Position(nKBucket, RandomInt(triedOccupancy.Count(nKBucket)));
             int nId = vvTried[nKBucket][nKBucketPos];
             assert(mapInfo.count(nId) == 1);
             CAddrInfo& info = mapInfo[nId];
@@ -373,12 +406,9 @@ CAddrInfo CAddrMan::Select_(bool newOnly)
         // use a new node
         double fChanceFactor = 1.0;
         while (1) {
-            int nUBucket = RandomInt(ADDRMAN_NEW_BUCKET_COUNT);
-            int nUBucketPos = RandomInt(ADDRMAN_BUCKET_SIZE);
-            while (vvNew[nUBucket][nUBucketPos] == -1) {
-                nUBucket = (nUBucket + insecure_rand.randbits(ADDRMAN_NEW_BUCKET_COUNT_LOG2)) % ADDRMAN_NEW_BUCKET_COUNT;
-                nUBucketPos = (nUBucketPos + insecure_rand.randbits(ADDRMAN_BUCKET_SIZE_LOG2)) % ADDRMAN_BUCKET_SIZE;
-            }
+            // pick a random non-empty bucket, then a random entry in it
+            int nUBucket = newOccupancy.UsedBucket(RandomInt(newOccupancy.UsedBuckets()));
+            int nUBucketPos = newOccupancy.Position(nUBucket, RandomInt(newOccupancy.Count(nUBucket)));
             int nId = vvNew[nUBucket][nUBucketPos];
             assert(mapInfo.count(nId) == 1);
             CAddrInfo& info = mapInfo[nId];
@@ -490,7 +520,8 @@ void CAddrMan::GetAddr_(std::vector<CAddress>& vAddr)
 
 void CAddrMan::Connected_(const CService& addr, int64_t nTime)
 {
-    CAddrInfo* pinfo = Find(addr);
+    int nId;
+    CAddrInfo* pinfo = Find(addr, &nId);
 
     // if not found, bail out
     if (!pinfo)
@@ -504,13 +535,16 @@ void CAddrMan::Connected_(const CService& addr, int64_t nTime)
 
     // update info
     int64_t nUpdateInterval = 20 * 60;
-    if (nTime - info.nTime > nUpdateInterval)
+    if (nTime - info.nTime > nUpdateInterval) {
         info.nTime = nTime;
+        setDirty.insert(nId);
+    }
 }
 
 void CAddrMan::SetServices_(const CService& addr, ServiceFlags nServices)
 {
-    CAddrInfo* pinfo = Find(addr);
+    int nId;
+    CAddrInfo* pinfo = Find(addr, &nId);
 
     // if not found, bail out
     if (!pinfo)
@@ -524,6 +558,65 @@ void CAddrMan::SetServices_(const CService& addr, ServiceFlags nServices)
 
     // update info
     info.nServices = nServices;
+    setDirty.insert(nId);
+}
+
+void CAddrMan::Restore_(const CAddrLogEntry& entry)
+{
+    const CAddrInfo& infoIn = entry.info;
+    int nId;
+    CAddrInfo* pinfo = Find(infoIn, &nId);
+
+    if (entry.fDeleted) {
+        if (pinfo)
+            Remove(nId);
+        return;
+    }
+
+    if (!pinfo) {
+        if (!infoIn.IsRoutable())
+            return;
+
+        // enter it into the new table at its source's bucket, as if it had just been announced
+        pinfo = Create(infoIn, infoIn.source, &nId);
+        nNew++;
+        int nUBucket = pinfo->GetNewBucket(nKey);
+        int nUBucketPos = pinfo->GetBucketPosition(nKey, true, nUBucket);
+        ClearNew(nUBucket, nUBucketPos);
+        pinfo->nRefCount = 1;
+        SetNew(nUBucket, nUBucketPos, nId);
+    }
+
+    CAddrInfo& info = *pinfo;
+
+    // check whether we are talking about the exact same CService (including same port)
+    if (info != infoIn)
+        return;
+
+    info.nTime = infoIn.nTime;
+    info.nServices = infoIn.nServices;
+    info.nLastTry = infoIn.nLastTry;
+    info.nLastSuccess = infoIn.nLastSuccess;
+    info.nAttempts = infoIn.nAttempts;
+
+    if (entry.fInTried && !info.fInTried && info.nLastSuccess) {
+        MakeTried(info, nId);
+    } else if (!entry.fInTried && info.fInTried) {
+        // evicted from "tried" since the snapshot, move it back to a new bucket as MakeTried does
+        int nKBucket = info.GetTriedBucket(nKey);
+        int nKBucketPos = info.GetBucketPosition(nKey, false, nKBucket);
+        SetTried(nKBucket, nKBucketPos, -1);
+        info.fInTried = false;
+        nTried--;
+
+        int nUBucket = info.GetNewBucket(nKey);
+        int nUBucketPos = info.GetBucketPosition(nKey, true, nUBucket);
+        ClearNew(nUBucket, nUBucketPos);
+        assert(vvNew[nUBucket][nUBucketPos] == -1);
+        info.nRefCount = 1;
+        SetNew(nUBucket, nUBucketPos, nId);
+        nNew++;
+    }
 }
 
 int CAddrMan::RandomInt(int nMax){
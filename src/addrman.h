@@ -177,6 +177,114 @@ public:
 #define ADDRMAN_NEW_BUCKET_COUNT (1 << ADDRMAN_NEW_BUCKET_COUNT_LOG2)
 #define ADDRMAN_BUCKET_SIZE (1 << ADDRMAN_BUCKET_SIZE_LOG2)
 
+/** An address table entry as recorded in the address change log, or a tombstone for a deleted address */
+class CAddrLogEntry
+{
+public:
+    CAddrInfo info;
+    bool fInTried;
+    bool fDeleted;
+
+    CAddrLogEntry() : fInTried(false), fDeleted(false) {}
+    CAddrLogEntry(const CAddrInfo& infoIn, bool fInTriedIn, bool fDeletedIn = false) : info(infoIn), fInTried(fInTriedIn), fDeleted(fDeletedIn) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(info);
+        READWRITE(fInTried);
+        READWRITE(fDeleted);
+    }
+};
+
+static_assert(ADDRMAN_BUCKET_SIZE <= 64, "bucket occupancy is kept in a 64-bit mask");
+
+/**
+ * Occupancy of one address table: a bitmap of the filled positions of every
+ * bucket, and the list of buckets holding at least one entry, so a random
+ * entry can be picked without probing empty positions.
+ */
+template <int BUCKET_COUNT>
+class CAddrTableOccupancy
+{
+private:
+    //! filled positions of each bucket
+    uint64_t vMask[BUCKET_COUNT];
+
+    //! index of each bucket in vUsed, or -1 if the bucket is empty
+    int vUsedPos[BUCKET_COUNT];
+
+    //! buckets with at least one filled position, in no particular order
+    std::vector<int> vUsed;
+
+    static int CountBits(uint64_t n)
+    {
+        int nCount = 0;
+        for (; n; n &= n - 1)
+            nCount++;
+        return nCount;
+    }
+
+public:
+    CAddrTableOccupancy() { Clear(); }
+
+    void Clear()
+    {
+        for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+            vMask[bucket] = 0;
+            vUsedPos[bucket] = -1;
+        }
+        vUsed.clear();
+    }
+
+    void Set(int nBucket, int nPos, bool fFilled)
+    {
+        uint64_t nBit = ((uint64_t)1) << nPos;
+        if (fFilled) {
+            if (vMask[nBucket] == 0) {
+                vUsedPos[nBucket] = vUsed.size();
+                vUsed.push_back(nBucket);
+            }
+            vMask[nBucket] |= nBit;
+        } else if (vMask[nBucket] & nBit) {
+            vMask[nBucket] &= ~nBit;
+            if (vMask[nBucket] == 0) {
+                // Fill the hole with the last used bucket
+                int nLast = vUsed.back();
+                vUsed[vUsedPos[nBucket]] = nLast;
+                vUsedPos[nLast] = vUsedPos[nBucket];
+                vUsed.pop_back();
+                vUsedPos[nBucket] = -1;
+            }
+        }
+    }
+
+    //! Number of buckets with at least one entry
+    int UsedBuckets() const { return vUsed.size(); }
+
+    //! The nth non-empty bucket
+    int UsedBucket(int n) const { return vUsed[n]; }
+
+    //! Number of filled positions in a bucket
+    int Count(int nBucket) const { return CountBits(vMask[nBucket]); }
+
+    //! The nth filled position of a bucket, counting from position 0
+    int Position(int nBucket, int n) const
+    {
+        uint64_t nMask = vMask[nBucket];
+        for (; n > 0; n--)
+            nMask &= nMask - 1;
+        assert(nMask != 0);
+        int nPos = 0;
+        while (!(nMask & 1)) {
+            nMask >>= 1;
+            nPos++;
+        }
+        return nPos;
+    }
+};
+
 /** 
  * Stochastical (IP) address manager 
  */
@@ -210,9 +318,19 @@ private:
     //! list of "new" buckets
     int vvNew[ADDRMAN_NEW_BUCKET_COUNT][ADDRMAN_BUCKET_SIZE];
 
+    //! filled positions of vvTried and vvNew
+    CAddrTableOccupancy<ADDRMAN_TRIED_BUCKET_COUNT> triedOccupancy;
+    CAddrTableOccupancy<ADDRMAN_NEW_BUCKET_COUNT> newOccupancy;
+
     //! last time Good was called (memory only)
     int64_t nLastGood;
 
+    //! nIds changed since the last call to TakeChanges (memory only)
+    std::set<int> setDirty;
+
+    //! addresses deleted since the last call to TakeChanges (memory only)
+    std::set<CService> setDeleted;
+
 protected:
     //! secret key to randomize bucket select with
     uint256 nKey;
@@ -227,6 +345,20 @@ protected:
     //! nTime and nServices of the found node are updated, if necessary.
     CAddrInfo* Create(const CAddress &addr, const CNetAddr &addrSource, int *pnId = nullptr);
 
+    //! Point a "tried" table position at an entry, or at nothing with -1.
+    void SetTried(int nKBucket, int nKBucketPos, int nId)
+    {
+        vvTried[nKBucket][nKBucketPos] = nId;
+        triedOccupancy.Set(nKBucket, nKBucketPos, nId != -1);
+    }
+
+    //! Point a "new" table position at an entry, or at nothing with -1.
+    void SetNew(int nUBucket, int nUBucketPos, int nId)
+    {
+        vvNew[nUBucket][nUBucketPos] = nId;
+        newOccupancy.Set(nUBucket, nUBucketPos, nId != -1);
+    }
+
     //! Swap two elements in vRandom.
     void SwapRandom(unsigned int nRandomPos1, unsigned int nRandomPos2);
 
@@ -268,6 +400,12 @@ protected:
     //! Update an entry's service bits.
     void SetServices_(const CService &addr, ServiceFlags nServices);
 
+    //! Take an entry out of whichever table holds it and delete it.
+    void Remove(int nId);
+
+    //! Bring an entry to the state recorded in the change log, adding it if it is unknown or deleting it for a tombstone.
+    void Restore_(const CAddrLogEntry &entry);
+
 public:
     /**
      * serialized format:
@@ -390,7 +528,7 @@ public:
                 int nUBucket = info.GetNewBucket(nKey);
                 int nUBucketPos = info.GetBucketPosition(nKey, true, nUBucket);
                 if (vvNew[nUBucket][nUBucketPos] == -1) {
-                    vvNew[nUBucket][nUBucketPos] = n;
+                    SetNew(nUBucket, nUBucketPos, n);
                     info.nRefCount++;
                 }
             }
@@ -410,7 +548,7 @@ public:
                 vRandom.push_back(nIdCount);
                 mapInfo[nIdCount] = info;
                 mapAddr[info] = nIdCount;
-                vvTried[nKBucket][nKBucketPos] = nIdCount;
+                SetTried(nKBucket, nKBucketPos, nIdCount);
                 nIdCount++;
             } else {
                 nLost++;
@@ -430,7 +568,7 @@ public:
                     int nUBucketPos = info.GetBucketPosition(nKey, true, bucket);
                     if (nVersion == 1 && nUBuckets == ADDRMAN_NEW_BUCKET_COUNT && vvNew[bucket][nUBucketPos] == -1 && info.nRefCount < ADDRMAN_NEW_BUCKETS_PER_ADDRESS) {
                         info.nRefCount++;
-                        vvNew[bucket][nUBucketPos] = nIndex;
+                        SetNew(bucket, nUBucketPos, nIndex);
                     }
                 }
             }
@@ -468,6 +606,8 @@ public:
                 vvTried[bucket][entry] = -1;
             }
         }
+        newOccupancy.Clear();
+        triedOccupancy.Clear();
 
         nIdCount = 0;
         nTried = 0;
@@ -475,6 +615,8 @@ public:
         nLastGood = 1; //Initially at 1 so that "never" is strictly worse.
         mapInfo.clear();
         mapAddr.clear();
+        setDirty.clear();
+        setDeleted.clear();
     }
 
     CAddrMan()
@@ -601,6 +743,50 @@ public:
         Check();
     }
 
+    //! Return tombstones for the addresses deleted and the entries changed since the last call, in their current state, and forget them.
+    void TakeChanges(std::vector<CAddrLogEntry> &vChanges)
+    {
+        LOCK(cs);
+        vChanges.clear();
+        vChanges.reserve(setDeleted.size() + setDirty.size());
+        // Tombstones go first, so an address deleted and then added again is replayed as added
+        for (const CService &addr : setDeleted)
+            vChanges.emplace_back(CAddrInfo(CAddress(addr, NODE_NONE), CNetAddr()), false, true);
+        for (int nId : setDirty) {
+            const CAddrInfo &info = mapInfo[nId];
+            vChanges.emplace_back(info, info.fInTried);
+        }
+        setDeleted.clear();
+        setDirty.clear();
+    }
+
+    //! Mark changes taken by TakeChanges as pending again, after they failed to be written.
+    void ReturnChanges(const std::vector<CAddrLogEntry> &vChanges)
+    {
+        LOCK(cs);
+        for (const CAddrLogEntry &entry : vChanges) {
+            // Whatever happened to the address since was recorded by then, only its current state needs writing
+            int nId;
+            if (Find(entry.info, &nId))
+                setDirty.insert(nId);
+            else
+                setDeleted.insert(entry.info);
+        }
+    }
+
+    //! Replay entries from the change log over the tables.
+    void ApplyChanges(const std::vector<CAddrLogEntry> &vChanges)
+    {
+        LOCK(cs);
+        Check();
+        for (const CAddrLogEntry &entry : vChanges)
+            Restore_(entry);
+        Check();
+        // The log already holds these
+        setDeleted.clear();
+        setDirty.clear();
+    }
+
 };
 
 #endif // RAVEN_ADDRMAN_H
@@ -174,6 +174,8 @@ public:
     }
 
     base_uint& operator*=(uint32_t b32);
+    /** Divide by a 32-bit value, with the same result as operator/= but word at a time */
+    base_uint& DivideBy(uint32_t b32);
     base_uint& operator*=(const base_uint& b);
     base_uint& operator/=(const base_uint& b);
 
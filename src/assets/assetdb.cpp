@@ -8,6 +8,8 @@
 #include <tinyformat.h>
 #include "assetdb.h"
 #include "assets.h"
+#include "memusage.h"
+#include "txdb.h"
 #include "validation.h"
 
 #include <boost/thread.hpp>
@@ -18,25 +20,48 @@ static const char ADDRESS_ASSET_QUANTITY_FLAG = 'C';
 static const char MY_ASSET_FLAG = 'M';
 static const char BLOCK_ASSET_UNDO_DATA = 'U';
 static const char MEMPOOL_REISSUED_TX = 'Z';
+static const char ADDRESS_HOLDING_COUNT_FLAG = 'D';
+static const char DB_FLAG = 'F';
+
+static const std::string ADDRESS_HOLDING_COUNTS = "addressholdingcounts";
 
 static size_t MAX_DATABASE_RESULTS = 50000;
 
-CAssetsDB::CAssetsDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "assets", nCacheSize, fMemory, fWipe) {
+// Longer than any asset name; sorts after every record of one address or asset
+// because the serialized length comes first
+static const std::string END_OF_RECORDS(252, '\xff');
+
+CAssetsDB::CAssetsDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "assets", nCacheSize, fMemory, fWipe), nPendingBlockUndoUsage(0) {
+    // A new database keeps its holding counts from the start
+    char ch;
+    fAddressHoldingCounts = Read(std::make_pair(DB_FLAG, ADDRESS_HOLDING_COUNTS), ch);
+    if (!fAddressHoldingCounts && IsEmpty())
+        fAddressHoldingCounts = Write(std::make_pair(DB_FLAG, ADDRESS_HOLDING_COUNTS), '1');
 }
 
 bool CAssetsDB::WriteAssetData(const CNewAsset &asset, const int nHeight, const uint256& blockHash)
 {
     CDatabasedAssetData data(asset, nHeight, blockHash);
-    return Write(std::make_pair(ASSET_FLAG, asset.strName), data);
+    return BatchWrite(std::make_pair(ASSET_FLAG, asset.strName), data);
 }
 
 bool CAssetsDB::WriteAssetAddressQuantity(const std::string &assetName, const std::string &address, const CAmount &quantity)
 {
-    return Write(std::make_pair(ASSET_ADDRESS_QUANTITY_FLAG, std::make_pair(assetName, address)), quantity);
+    return BatchWrite(std::make_pair(ASSET_ADDRESS_QUANTITY_FLAG, std::make_pair(assetName, address)), quantity);
 }
 
 bool CAssetsDB::WriteAddressAssetQuantity(const std::string &address, const std::string &assetName, const CAmount& quantity) {
-    return Write(std::make_pair(ADDRESS_ASSET_QUANTITY_FLAG, std::make_pair(address, assetName)), quantity);
+    auto key = std::make_pair(ADDRESS_ASSET_QUANTITY_FLAG, std::make_pair(address, assetName));
+    CDBBatch batch(*this);
+    CDBBatch& target = pbatchFlush ? *pbatchFlush : batch;
+    if (!HasAddressAssetQuantity(address, assetName) && !AddAddressHoldingCount(target, address, 1))
+        return false;
+    target.Write(key, quantity);
+    if (pbatchFlush) {
+        mapFlushHoldings[key.second] = true;
+        return true;
+    }
+    return WriteBatch(batch);
 }
 
 bool CAssetsDB::ReadAssetData(const std::string& strName, CNewAsset& asset, int& nHeight, uint256& blockHash)
@@ -65,31 +90,209 @@ bool CAssetsDB::ReadAddressAssetQuantity(const std::string &address, const std::
 
 bool CAssetsDB::EraseAssetData(const std::string& assetName)
 {
-    return Erase(std::make_pair(ASSET_FLAG, assetName));
+    return BatchErase(std::make_pair(ASSET_FLAG, assetName));
 }
 
 bool CAssetsDB::EraseMyAssetData(const std::string& assetName)
 {
-    return Erase(std::make_pair(MY_ASSET_FLAG, assetName));
+    return BatchErase(std::make_pair(MY_ASSET_FLAG, assetName));
 }
 
 bool CAssetsDB::EraseAssetAddressQuantity(const std::string &assetName, const std::string &address) {
-    return Erase(std::make_pair(ASSET_ADDRESS_QUANTITY_FLAG, std::make_pair(assetName, address)));
+    return BatchErase(std::make_pair(ASSET_ADDRESS_QUANTITY_FLAG, std::make_pair(assetName, address)));
 }
 
 bool CAssetsDB::EraseAddressAssetQuantity(const std::string &address, const std::string &assetName) {
-    return Erase(std::make_pair(ADDRESS_ASSET_QUANTITY_FLAG, std::make_pair(address, assetName)));
+    auto key = std::make_pair(ADDRESS_ASSET_QUANTITY_FLAG, std::make_pair(address, assetName));
+    CDBBatch batch(*this);
+    CDBBatch& target = pbatchFlush ? *pbatchFlush : batch;
+    if (HasAddressAssetQuantity(address, assetName) && !AddAddressHoldingCount(target, address, -1))
+        return false;
+    target.Erase(key);
+    if (pbatchFlush) {
+        mapFlushHoldings[key.second] = false;
+        return true;
+    }
+    return WriteBatch(batch);
+}
+
+bool CAssetsDB::HasAddressAssetQuantity(const std::string& address, const std::string& assetName)
+{
+    auto it = mapFlushHoldings.find(std::make_pair(address, assetName));
+    if (it != mapFlushHoldings.end())
+        return it->second;
+    return Exists(std::make_pair(ADDRESS_ASSET_QUANTITY_FLAG, std::make_pair(address, assetName)));
+}
+
+bool CAssetsDB::AddAddressHoldingCount(CDBBatch& batch, const std::string& address, int nChange)
+{
+    int count = 0;
+    auto it = mapFlushHoldingCounts.find(address);
+    if (it != mapFlushHoldingCounts.end())
+        count = it->second;
+    else if (Exists(std::make_pair(ADDRESS_HOLDING_COUNT_FLAG, address)) && !Read(std::make_pair(ADDRESS_HOLDING_COUNT_FLAG, address), count))
+        return error("%s: failed to read holding count of %s", __func__, address);
+
+    count += nChange;
+    if (count > 0)
+        batch.Write(std::make_pair(ADDRESS_HOLDING_COUNT_FLAG, address), count);
+    else
+        batch.Erase(std::make_pair(ADDRESS_HOLDING_COUNT_FLAG, address));
+    if (pbatchFlush)
+        mapFlushHoldingCounts[address] = count;
+    return true;
+}
+
+void CAssetsDB::BeginFlushBatch()
+{
+    AbortFlushBatch();
+    pbatchFlush.reset(new CDBBatch(*this));
+}
+
+bool CAssetsDB::CommitFlushBatch()
+{
+    if (!pbatchFlush)
+        return true;
+    bool ret = WriteBatch(*pbatchFlush);
+    AbortFlushBatch();
+    return ret;
+}
+
+void CAssetsDB::AbortFlushBatch()
+{
+    pbatchFlush.reset();
+    mapFlushHoldings.clear();
+    mapFlushHoldingCounts.clear();
+}
+
+// Count the (flag, (strFirst, *)) records without leaving them
+static int CountRecords(CDBIterator& cursor, const char flag, const std::string& strFirst)
+{
+    int count = 0;
+    cursor.Seek(std::make_pair(flag, std::make_pair(strFirst, std::string())));
+    while (cursor.Valid()) {
+        boost::this_thread::interruption_point();
+
+        std::pair<char, std::pair<std::string, std::string> > key;
+        if (!cursor.GetKey(key) || key.first != flag || key.second.first != strFirst)
+            break;
+        count++;
+        cursor.Next();
+    }
+    return count;
+}
+
+bool CAssetsDB::ReadAddressHoldingCount(const std::string& address, int& count)
+{
+    if (!fAddressHoldingCounts) {
+        std::unique_ptr<CDBIterator> pcursor(NewIterator());
+        count = CountRecords(*pcursor, ADDRESS_ASSET_QUANTITY_FLAG, address);
+        return true;
+    }
+
+    count = 0;
+    if (!Exists(std::make_pair(ADDRESS_HOLDING_COUNT_FLAG, address)))
+        return true;
+    return Read(std::make_pair(ADDRESS_HOLDING_COUNT_FLAG, address), count);
+}
+
+bool CAssetsDB::CountAddressHoldings()
+{
+    if (fAddressHoldingCounts)
+        return true;
+
+    LogPrintf("Counting asset holdings per address...\n");
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(ADDRESS_ASSET_QUANTITY_FLAG, std::make_pair(std::string(), std::string())));
+
+    // Records are in address order, so each address's count is done when the address changes
+    CDBBatch batch(*this);
+    std::string address;
+    int count = 0;
+    size_t nAddresses = 0;
+    while (true) {
+        boost::this_thread::interruption_point();
+
+        std::pair<char, std::pair<std::string, std::string> > key;
+        bool fRecord = pcursor->Valid() && pcursor->GetKey(key) && key.first == ADDRESS_ASSET_QUANTITY_FLAG;
+        if (count > 0 && (!fRecord || key.second.first != address)) {
+            batch.Write(std::make_pair(ADDRESS_HOLDING_COUNT_FLAG, address), count);
+            nAddresses++;
+            count = 0;
+            if (batch.SizeEstimate() > (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize)) {
+                if (!WriteBatch(batch))
+                    return error("%s: failed to write holding counts", __func__);
+                batch.Clear();
+            }
+        }
+        if (!fRecord)
+            break;
+
+        address = key.second.first;
+        count++;
+        pcursor->Next();
+    }
+
+    batch.Write(std::make_pair(DB_FLAG, ADDRESS_HOLDING_COUNTS), '1');
+    if (!WriteBatch(batch, true))
+        return error("%s: failed to write holding counts", __func__);
+
+    LogPrintf("Counted asset holdings of %u addresses\n", nAddresses);
+    fAddressHoldingCounts = true;
+    return true;
 }
 
 bool EraseAddressAssetQuantity(const std::string &address, const std::string &assetName);
 
 bool CAssetsDB::WriteBlockUndoAssetData(const uint256& blockhash, const std::vector<std::pair<std::string, CBlockAssetUndo> >& assetUndoData)
 {
-    return Write(std::make_pair(BLOCK_ASSET_UNDO_DATA, blockhash), assetUndoData);
+    return BatchWrite(std::make_pair(BLOCK_ASSET_UNDO_DATA, blockhash), assetUndoData);
+}
+
+// Estimated memory of one block's undo data, counting string capacity as heap even when it fits inline
+static size_t BlockUndoDynamicUsage(const std::vector<std::pair<std::string, CBlockAssetUndo> >& assetUndoData)
+{
+    size_t nUsage = memusage::DynamicUsage(assetUndoData);
+    for (const auto& item : assetUndoData)
+        nUsage += item.first.capacity() + item.second.strIPFS.capacity() + item.second.verifierString.capacity();
+    return nUsage;
+}
+
+void CAssetsDB::AddPendingBlockUndoAssetData(const uint256& blockhash, const std::vector<std::pair<std::string, CBlockAssetUndo> >& assetUndoData)
+{
+    auto it = mapPendingBlockUndo.find(blockhash);
+    if (it == mapPendingBlockUndo.end()) {
+        it = mapPendingBlockUndo.emplace(blockhash, std::vector<std::pair<std::string, CBlockAssetUndo> >()).first;
+        nPendingBlockUndoUsage += memusage::IncrementalDynamicUsage(mapPendingBlockUndo);
+    }
+    nPendingBlockUndoUsage -= BlockUndoDynamicUsage(it->second);
+    it->second = assetUndoData;
+    nPendingBlockUndoUsage += BlockUndoDynamicUsage(it->second);
+}
+
+bool CAssetsDB::WritePendingBlockUndoAssetData()
+{
+    if (mapPendingBlockUndo.empty())
+        return true;
+
+    CDBBatch batch(*this);
+    for (const auto& item : mapPendingBlockUndo)
+        batch.Write(std::make_pair(BLOCK_ASSET_UNDO_DATA, item.first), item.second);
+    if (!WriteBatch(batch))
+        return false;
+    mapPendingBlockUndo.clear();
+    nPendingBlockUndoUsage = 0;
+    return true;
 }
 
 bool CAssetsDB::ReadBlockUndoAssetData(const uint256 &blockhash, std::vector<std::pair<std::string, CBlockAssetUndo> > &assetUndoData)
 {
+    auto it = mapPendingBlockUndo.find(blockhash);
+    if (it != mapPendingBlockUndo.end()) {
+        assetUndoData = it->second;
+        return true;
+    }
+
     // If it exists, return the read value.
     if (Exists(std::make_pair(BLOCK_ASSET_UNDO_DATA, blockhash)))
            return Read(std::make_pair(BLOCK_ASSET_UNDO_DATA, blockhash), assetUndoData);
@@ -244,74 +447,64 @@ bool CAssetsDB::AssetDir(std::vector<CDatabasedAssetData>& assets, const std::st
     return true;
 }
 
-bool CAssetsDB::AddressDir(std::vector<std::pair<std::string, CAmount> >& vecAssetAmount, int& totalEntries, const bool& fGetTotal, const std::string& address, const size_t count, const long start)
+// Page through the (flag, (strFirst, second)) -> quantity records of one strFirst in key order. A
+// negative start counts back from the last record, so only the page asked for is walked.
+static bool ReadRecords(CDBIterator& cursor, const char flag, const std::string& strFirst, std::vector<std::pair<std::string, CAmount> >& vecAmounts, const size_t count, const long start)
 {
-    FlushStateToDisk();
-
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-    pcursor->Seek(std::make_pair(ADDRESS_ASSET_QUANTITY_FLAG, std::make_pair(address, std::string())));
+    std::pair<char, std::pair<std::string, std::string> > key;
+    auto fInRange = [&]() {
+        return cursor.Valid() && cursor.GetKey(key) && key.first == flag && key.second.first == strFirst;
+    };
 
-    if (fGetTotal) {
-        totalEntries = 0;
-        while (pcursor->Valid()) {
+    if (start >= 0) {
+        cursor.Seek(std::make_pair(flag, std::make_pair(strFirst, std::string())));
+        for (long skipped = 0; skipped < start && fInRange(); skipped++)
+            cursor.Next();
+    } else {
+        cursor.Seek(std::make_pair(flag, std::make_pair(strFirst, END_OF_RECORDS)));
+        if (cursor.Valid())
+            cursor.Prev();
+        else
+            cursor.SeekToLast();
+        for (long back = 1; back < -start && fInRange(); back++) {
             boost::this_thread::interruption_point();
-
-            std::pair<char, std::pair<std::string, std::string> > key;
-            if (pcursor->GetKey(key) && key.first == ADDRESS_ASSET_QUANTITY_FLAG && key.second.first == address) {
-                totalEntries++;
-            }
-            pcursor->Next();
+            cursor.Prev();
         }
-        return true;
+        // Asked for more records than there are
+        if (!fInRange())
+            return true;
     }
 
-    size_t skip = 0;
-    if (start >= 0) {
-        skip = start;
-    }
-    else {
-        // compute table size for backwards offset
-        long table_size = 0;
-        while (pcursor->Valid()) {
-            boost::this_thread::interruption_point();
+    size_t loaded = 0;
+    while (loaded < count && loaded < MAX_DATABASE_RESULTS && fInRange()) {
+        boost::this_thread::interruption_point();
 
-            std::pair<char, std::pair<std::string, std::string> > key;
-            if (pcursor->GetKey(key) && key.first == ADDRESS_ASSET_QUANTITY_FLAG && key.second.first == address) {
-                table_size += 1;
-            }
-            pcursor->Next();
-        }
-        skip = table_size + start;
-        pcursor->SeekToFirst();
+        CAmount amount;
+        if (!cursor.GetValue(amount))
+            return false;
+        vecAmounts.emplace_back(std::make_pair(key.second.second, amount));
+        loaded++;
+        cursor.Next();
     }
 
+    return true;
+}
 
-    size_t loaded = 0;
-    size_t offset = 0;
+bool CAssetsDB::AddressDir(std::vector<std::pair<std::string, CAmount> >& vecAssetAmount, int& totalEntries, const bool& fGetTotal, const std::string& address, const size_t count, const long start)
+{
+    FlushStateToDisk();
 
-    // Load assets
-    while (pcursor->Valid() && loaded < count && loaded < MAX_DATABASE_RESULTS) {
-        boost::this_thread::interruption_point();
+    if (fGetTotal)
+        return ReadAddressHoldingCount(address, totalEntries);
 
-        std::pair<char, std::pair<std::string, std::string> > key;
-        if (pcursor->GetKey(key) && key.first == ADDRESS_ASSET_QUANTITY_FLAG && key.second.first == address) {
-                if (offset < skip) {
-                    offset += 1;
-                }
-                else {
-                    CAmount amount;
-                    if (pcursor->GetValue(amount)) {
-                        vecAssetAmount.emplace_back(std::make_pair(key.second.second, amount));
-                        loaded += 1;
-                    } else {
-                        return error("%s: failed to Address Asset Quanity", __func__);
-                    }
-                }
-            pcursor->Next();
-        } else {
-            break;
-        }
-    }
+    return ReadAddressAssetQuantities(address, vecAssetAmount, count, start);
+}
+
+bool CAssetsDB::ReadAddressAssetQuantities(const std::string& address, std::vector<std::pair<std::string, CAmount> >& vecAssetAmount, const size_t count, const long start)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    if (!ReadRecords(*pcursor, ADDRESS_ASSET_QUANTITY_FLAG, address, vecAssetAmount, count, start))
+        return error("%s: failed to Address Asset Quanity", __func__);
 
     return true;
 }
@@ -322,68 +515,13 @@ bool CAssetsDB::AssetAddressDir(std::vector<std::pair<std::string, CAmount> >& v
     FlushStateToDisk();
 
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
-    pcursor->Seek(std::make_pair(ASSET_ADDRESS_QUANTITY_FLAG, std::make_pair(assetName, std::string())));
-
     if (fGetTotal) {
-        totalEntries = 0;
-        while (pcursor->Valid()) {
-            boost::this_thread::interruption_point();
-
-            std::pair<char, std::pair<std::string, std::string> > key;
-            if (pcursor->GetKey(key) && key.first == ASSET_ADDRESS_QUANTITY_FLAG && key.second.first == assetName) {
-                totalEntries += 1;
-            }
-            pcursor->Next();
-        }
+        totalEntries = CountRecords(*pcursor, ASSET_ADDRESS_QUANTITY_FLAG, assetName);
         return true;
     }
 
-    size_t skip = 0;
-    if (start >= 0) {
-        skip = start;
-    }
-    else {
-        // compute table size for backwards offset
-        long table_size = 0;
-        while (pcursor->Valid()) {
-            boost::this_thread::interruption_point();
-
-            std::pair<char, std::pair<std::string, std::string> > key;
-            if (pcursor->GetKey(key) && key.first == ASSET_ADDRESS_QUANTITY_FLAG && key.second.first == assetName) {
-                table_size += 1;
-            }
-            pcursor->Next();
-        }
-        skip = table_size + start;
-        pcursor->SeekToFirst();
-    }
-
-    size_t loaded = 0;
-    size_t offset = 0;
-
-    // Load assets
-    while (pcursor->Valid() && loaded < count && loaded < MAX_DATABASE_RESULTS) {
-        boost::this_thread::interruption_point();
-
-        std::pair<char, std::pair<std::string, std::string> > key;
-        if (pcursor->GetKey(key) && key.first == ASSET_ADDRESS_QUANTITY_FLAG && key.second.first == assetName) {
-            if (offset < skip) {
-                offset += 1;
-            }
-            else {
-                CAmount amount;
-                if (pcursor->GetValue(amount)) {
-                    vecAddressAmount.emplace_back(std::make_pair(key.second.second, amount));
-                    loaded += 1;
-                } else {
-                    return error("%s: failed to Asset Address Quanity", __func__);
-                }
-            }
-            pcursor->Next();
-        } else {
-            break;
-        }
-    }
+    if (!ReadRecords(*pcursor, ASSET_ADDRESS_QUANTITY_FLAG, assetName, vecAddressAmount, count, start))
+        return error("%s: failed to Asset Address Quanity", __func__);
 
     return true;
 }
@@ -5,9 +5,13 @@
 #ifndef RAVEN_ASSETDB_H
 #define RAVEN_ASSETDB_H
 
+#include "amount.h"
 #include "fs.h"
 #include "serialize.h"
 
+#include "uint256.h"
+
+#include <memory>
 #include <string>
 #include <map>
 #include <dbwrapper.h>
@@ -15,7 +19,6 @@
 const int8_t ASSET_UNDO_INCLUDES_VERIFIER_STRING = -1;
 
 class CNewAsset;
-class uint256;
 class COutPoint;
 class CDatabasedAssetData;
 
@@ -59,6 +62,40 @@ struct CBlockAssetUndo
 /** Access to the block database (blocks/index/) */
 class CAssetsDB : public CDBWrapper
 {
+private:
+    bool fAddressHoldingCounts;
+
+    // Open between BeginFlushBatch and CommitFlushBatch, with the holdings and
+    // counts it changes so later writes in the same flush see them
+    std::unique_ptr<CDBBatch> pbatchFlush;
+    std::map<std::pair<std::string, std::string>, bool> mapFlushHoldings;
+    std::map<std::string, int> mapFlushHoldingCounts;
+
+    // Block undo data held back during initial block download, and the memory it takes
+    std::map<uint256, std::vector<std::pair<std::string, CBlockAssetUndo> > > mapPendingBlockUndo;
+    size_t nPendingBlockUndoUsage;
+
+    template <typename K, typename V>
+    bool BatchWrite(const K& key, const V& value)
+    {
+        if (!pbatchFlush)
+            return Write(key, value);
+        pbatchFlush->Write(key, value);
+        return true;
+    }
+
+    template <typename K>
+    bool BatchErase(const K& key)
+    {
+        if (!pbatchFlush)
+            return Erase(key);
+        pbatchFlush->Erase(key);
+        return true;
+    }
+
+    bool HasAddressAssetQuantity(const std::string& address, const std::string& assetName);
+    bool AddAddressHoldingCount(CDBBatch& batch, const std::string& address, int nChange);
+
 public:
     explicit CAssetsDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
 
@@ -85,12 +122,30 @@ public:
     bool EraseAssetAddressQuantity(const std::string &assetName, const std::string &address);
     bool EraseAddressAssetQuantity(const std::string &address, const std::string &assetName);
 
+    // Writes and erases made between these reach the database as a single batch at
+    // CommitFlushBatch; AbortFlushBatch drops them. Reads do not see them until then.
+    void BeginFlushBatch();
+    bool CommitFlushBatch();
+    void AbortFlushBatch();
+
+    // During initial block download, block undo data waits in memory until the block index is written
+    void AddPendingBlockUndoAssetData(const uint256& blockhash, const std::vector<std::pair<std::string, CBlockAssetUndo> >& assetUndoData);
+    bool WritePendingBlockUndoAssetData();
+    size_t PendingBlockUndoDynamicMemoryUsage() const { return nPendingBlockUndoUsage; }
+
+    // Number of assets an address holds, kept current by WriteAddressAssetQuantity and EraseAddressAssetQuantity
+    bool ReadAddressHoldingCount(const std::string& address, int& count);
+    // Count the holdings of every address, once, for databases written before the counts were kept
+    bool CountAddressHoldings();
+
     // Helper functions
     bool LoadAssets();
     bool AssetDir(std::vector<CDatabasedAssetData>& assets, const std::string filter, const size_t count, const long start);
     bool AssetDir(std::vector<CDatabasedAssetData>& assets);
 
     bool AddressDir(std::vector<std::pair<std::string, CAmount> >& vecAssetAmount, int& totalEntries, const bool& fGetTotal, const std::string& address, const size_t count, const long start);
+    // AddressDir's page of holdings, as of the last flush of the assets cache
+    bool ReadAddressAssetQuantities(const std::string& address, std::vector<std::pair<std::string, CAmount> >& vecAssetAmount, const size_t count, const long start);
     bool AssetAddressDir(std::vector<std::pair<std::string, CAmount> >& vecAddressAmount, int& totalEntries, const bool& fGetTotal, const std::string& assetName, const size_t count, const long start);
 };
 
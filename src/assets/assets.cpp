@@ -10,6 +10,8 @@
 #include <iostream>
 #include <script/standard.h>
 #include <util.h>
+#include <hash.h>
+#include <random.h>
 #include <chainparams.h>
 #include <base58.h>
 #include <validation.h>
@@ -29,6 +31,7 @@
 #include "coins.h"
 #include "wallet/wallet.h"
 #include "LibBoolEE.h"
+#include "ui_interface.h"
 
 #define SIX_MONTHS 15780000 // Six months worth of seconds
 
@@ -2266,11 +2269,40 @@ bool CAssetsCache::RemoveRestrictedVerifier(const std::string& assetName, const
     return true;
 }
 
+// Collects everything one dump writes into a batch per database. Whatever was
+// not committed is dropped when it goes out of scope, so a failed dump leaves
+// the databases as they were.
+class CAssetsFlushBatches
+{
+public:
+    CAssetsFlushBatches()
+    {
+        if (passetsdb)
+            passetsdb->BeginFlushBatch();
+        if (prestricteddb)
+            prestricteddb->BeginFlushBatch();
+    }
+
+    ~CAssetsFlushBatches()
+    {
+        if (passetsdb)
+            passetsdb->AbortFlushBatch();
+        if (prestricteddb)
+            prestricteddb->AbortFlushBatch();
+    }
+
+    bool Commit()
+    {
+        return (!passetsdb || passetsdb->CommitFlushBatch()) && (!prestricteddb || prestricteddb->CommitFlushBatch());
+    }
+};
+
 bool CAssetsCache::DumpCacheToDatabase()
 {
     try {
         bool dirty = false;
         std::string message;
+        CAssetsFlushBatches batches;
 
         // Remove new assets from the database
         for (auto newAsset : setNewAssetsToRemove) {
@@ -2799,6 +2831,9 @@ bool CAssetsCache::DumpCacheToDatabase()
             }
         }
 
+        if (!batches.Commit())
+            return error("%s : %s", __func__, "_Failed Writing the asset cache batches to database");
+
         ClearDirtyCache();
 
         return true;
@@ -2816,6 +2851,24 @@ bool CAssetsCache::Flush()
         return error("%s: Couldn't find passets pointer while trying to flush assets cache", __func__);
 
     try {
+        // Serialized assetdata answers for assets created, removed or reissued here are stale from now on
+        std::set<std::string> setChangedAssets;
+        for (const auto &item : setNewAssetsToAdd)
+            setChangedAssets.insert(item.asset.strName);
+        for (const auto &item : setNewAssetsToRemove)
+            setChangedAssets.insert(item.asset.strName);
+        for (const auto &item : setNewReissueToAdd)
+            setChangedAssets.insert(item.reissue.strName);
+        for (const auto &item : setNewReissueToRemove)
+            setChangedAssets.insert(item.reissue.strName);
+        for (const auto &item : mapReissuedAssetData)
+            setChangedAssets.insert(item.first);
+
+        if (passetsDataPayloadCache) {
+            for (const auto &name : setChangedAssets)
+                passetsDataPayloadCache->Erase(name);
+        }
+
         for (auto &item : setNewAssetsToAdd) {
             if (passets->setNewAssetsToRemove.count(item))
                 passets->setNewAssetsToRemove.erase(item);
@@ -2986,6 +3039,9 @@ bool CAssetsCache::Flush()
             }
         }
 
+        if (!setChangedAssets.empty())
+            uiInterface.NotifyAssetDataChanged(setChangedAssets);
+
         return true;
 
     } catch (const std::runtime_error& e) {
@@ -3499,19 +3555,50 @@ bool GetAssetInfoFromCoin(const Coin& coin, std::string& strName, CAmount& nAmou
     return GetAssetInfoFromScript(coin.out.scriptPubKey, strName, nAmount);
 }
 
-bool GetAssetData(const CScript& script, CAssetOutputEntry& data)
+namespace {
+
+class SaltedScriptHasher
 {
-    // Placeholder strings that will get set if you successfully get the transfer or asset from the script
-    std::string address = "";
-    std::string assetName = "";
+private:
+    /** Salt */
+    const uint64_t k0, k1;
 
-    int nType = 0;
-    bool fIsOwner = false;
-    if (!script.IsAssetScript(nType, fIsOwner)) {
-        return false;
+public:
+    SaltedScriptHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+    size_t operator()(const CScript& script) const {
+        return CSipHasher(k0, k1).Write(script.data(), script.size()).Finalize();
+    }
+};
+
+// An output is parsed when its transaction enters the mempool, when its block is connected and again when it
+// is spent. The result only depends on the script, so the ones parsed successfully are kept here.
+CCriticalSection cs_assetOutputCache;
+
+CLRUCache<CScript, CAssetOutputEntry, SaltedScriptHasher>& AssetOutputCache()
+{
+    static CLRUCache<CScript, CAssetOutputEntry, SaltedScriptHasher> cache(MAX_CACHE_ASSET_OUTPUTS_SIZE);
+    return cache;
+}
+
+// The fields a successful parse sets; the others keep what the caller had in them
+void CopyParsedAssetData(const CAssetOutputEntry& from, CAssetOutputEntry& to)
+{
+    to.type = from.type;
+    to.nAmount = from.nAmount;
+    to.destination = from.destination;
+    to.assetName = from.assetName;
+    if (from.type == TX_TRANSFER_ASSET) {
+        to.message = from.message;
+        to.expireTime = from.expireTime;
     }
+}
 
-    txnouttype type = txnouttype(nType);
+bool ParseAssetData(const CScript& script, txnouttype type, bool fIsOwner, CAssetOutputEntry& data)
+{
+    // Placeholder strings that will get set if you successfully get the transfer or asset from the script
+    std::string address = "";
+    std::string assetName = "";
 
     // Get the New Asset or Transfer Asset from the scriptPubKey
     if (type == TX_NEW_ASSET && !fIsOwner) {
@@ -3573,6 +3660,35 @@ bool GetAssetData(const CScript& script, CAssetOutputEntry& data)
     return false;
 }
 
+}
+
+bool GetAssetData(const CScript& script, CAssetOutputEntry& data)
+{
+    int nType = 0;
+    bool fIsOwner = false;
+    if (!script.IsAssetScript(nType, fIsOwner)) {
+        return false;
+    }
+
+    {
+        LOCK(cs_assetOutputCache);
+        auto& cache = AssetOutputCache();
+        if (cache.Exists(script)) {
+            CopyParsedAssetData(cache.Get(script), data);
+            return true;
+        }
+    }
+
+    if (!ParseAssetData(script, txnouttype(nType), fIsOwner, data))
+        return false;
+
+    CAssetOutputEntry parsed;
+    CopyParsedAssetData(data, parsed);
+    LOCK(cs_assetOutputCache);
+    AssetOutputCache().Put(script, parsed);
+    return true;
+}
+
 #ifdef ENABLE_WALLET
 void GetAllAdministrativeAssets(CWallet *pwallet, std::vector<std::string> &names, int nMinConf)
 {
@@ -66,6 +66,9 @@ class COutput;
 // 2500 * 82 Bytes == 205 KB (kilobytes) of memory
 #define MAX_CACHE_ASSETS_SIZE 2500
 
+// Parsed asset outputs kept by GetAssetData, about 400 bytes each
+#define MAX_CACHE_ASSET_OUTPUTS_SIZE 10000
+
 // Create map that store that state of current reissued transaction that the mempool as accepted.
 // If an asset name is in this map, any other reissue transactions wont be accepted into the mempool
 extern std::map<uint256, std::string> mapReissuedTx;
@@ -535,7 +535,7 @@ struct CAssetCacheRestrictedVerifiers
 };
 
 // Least Recently Used Cache
-template<typename cache_key_t, typename cache_value_t>
+template<typename cache_key_t, typename cache_value_t, typename cache_hasher_t = std::hash<cache_key_t>>
 class CLRUCache
 {
 public:
@@ -628,7 +628,7 @@ public:
         maxSize = size;
     }
 
-   const std::unordered_map<cache_key_t, list_iterator_t>& GetItemsMap()
+   const std::unordered_map<cache_key_t, list_iterator_t, cache_hasher_t>& GetItemsMap()
     {
         return cacheItemsMap;
     };
@@ -648,7 +648,7 @@ public:
 
 private:
     std::list<key_value_pair_t> cacheItemsList;
-    std::unordered_map<cache_key_t, list_iterator_t> cacheItemsMap;
+    std::unordered_map<cache_key_t, list_iterator_t, cache_hasher_t> cacheItemsMap;
     size_t maxSize;
 };
 
@@ -127,6 +127,76 @@ bool GetMessage(const COutPoint& out, CMessage& message)
     return false;
 }
 
+bool LoadMessages(const CMessageQuery& query, std::vector<CMessage>& vMessages, bool& fMore)
+{
+    vMessages.clear();
+    fMore = false;
+
+    if (!pmessagedb)
+        return false;
+
+    LOCK(cs_messaging);
+
+    auto fnMatches = [&query](const CMessage& message) {
+        if (!query.strChannel.empty() && message.strName != query.strChannel)
+            return false;
+        if (!query.strStatus.empty() && MessageStatusToString(message.status) != query.strStatus)
+            return false;
+        CMessageCursor cursor(message);
+        return !(cursor < query.start || (query.fAfterStart && cursor == query.start));
+    };
+
+    // Unflushed messages replace their database copies. Only the ones matching the query are copied out of the
+    // dirty caches, sorted into cursor order and merged with the database walk below
+    std::vector<CMessage> vDirty;
+    for (const auto& pair : mapDirtyMessagesAdd) {
+        if (fnMatches(pair.second))
+            vDirty.push_back(pair.second);
+    }
+    for (const auto& pair : mapDirtyMessagesOrphaned) {
+        if (setDirtyMessagesRemove.count(pair.first))
+            continue;
+        CMessage message = pair.second;
+        message.status = MessageStatus::ORPHAN;
+        if (fnMatches(message))
+            vDirty.push_back(message);
+    }
+    std::sort(vDirty.begin(), vDirty.end(), [](const CMessage& a, const CMessage& b) {
+        return CMessageCursor(a) < CMessageCursor(b);
+    });
+
+    auto itDirty = vDirty.begin();
+    auto fnEmit = [&](const CMessage& message) {
+        if (query.nLimit && vMessages.size() >= query.nLimit) {
+            fMore = true;
+            return false;
+        }
+        vMessages.push_back(message);
+        return true;
+    };
+
+    pmessagedb->ForEachIndexedMessage(query.strChannel, query.strStatus, query.start, [&](const CMessage& message) {
+        if (setDirtyMessagesRemove.count(message.out) || mapDirtyMessagesAdd.count(message.out) || mapDirtyMessagesOrphaned.count(message.out))
+            return true;
+
+        // The channel index is also used for status queries on a channel, so the status still has to be checked
+        if (!fnMatches(message))
+            return true;
+
+        CMessageCursor cursor(message);
+        while (itDirty != vDirty.end() && CMessageCursor(*itDirty) < cursor) {
+            if (!fnEmit(*itDirty++))
+                return false;
+        }
+        return fnEmit(message);
+    });
+
+    while (!fMore && itDirty != vDirty.end())
+        fnEmit(*itDirty++);
+
+    return true;
+}
+
 void AddChannel(const std::string &name)
 {
     // Add channel to dirty cache to add
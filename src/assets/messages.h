@@ -8,6 +8,7 @@
 
 #include <uint256.h>
 #include <serialize.h>
+#include "myassetsdb.h"
 
 class CMessage;
 class COutPoint;
@@ -34,6 +35,19 @@ bool IsChannelSubscribed(const std::string &name); // Is this channel marked as
 
 bool GetMessage(const COutPoint &out, CMessage &message);
 
+/** Selects a page of messages for LoadMessages */
+struct CMessageQuery {
+    std::string strChannel;     // Only messages on this channel, empty for all channels
+    std::string strStatus;      // Only messages with this status, empty for any status
+    CMessageCursor start;       // Position of the first message to return
+    bool fAfterStart = false;   // Skip a message sitting exactly at start, used when resuming from a returned cursor
+    size_t nLimit = 0;          // Maximum number of messages to return, 0 for no limit
+};
+
+/** Load the messages selected by query in cursor order, overlaying the unflushed message caches on the database.
+ *  fMore is set when further matching messages exist past the returned page */
+bool LoadMessages(const CMessageQuery& query, std::vector<CMessage>& vMessages, bool& fMore);
+
 void AddChannel(const std::string &name);
 
 void RemoveChannel(const std::string &name);
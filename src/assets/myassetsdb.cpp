@@ -4,6 +4,8 @@
 #include "validation.h"
 #include "myassetsdb.h"
 #include "messages.h"
+#include "txdb.h"
+#include "utilstrencodings.h"
 #include <boost/thread.hpp>
 
 #include <boost/thread.hpp>
@@ -13,15 +15,96 @@ static const char MY_MESSAGE_CHANNEL = 'C'; // My followed Channels
 static const char MY_SEEN_ADDRESSES = 'S'; // Addresses that have been seen on the chain
 static const char DB_FLAG = 'D'; // Database Flags
 
+static const char MESSAGE_HEIGHT_INDEX = 'h'; // Messages by height
+static const char MESSAGE_CHANNEL_INDEX = 'c'; // Messages by channel and height
+static const char MESSAGE_STATUS_INDEX = 's'; // Messages by status and height
+
 static const char MY_TAGGED_ADDRESSES = 'T'; // Addresses that have been tagged
 static const char MY_RESTRICTED_ADDRESSES = 'R'; // Addresses that have been restricted
 
+/** Key of a secondary message index entry. The height and output index are stored big endian so that LevelDB iterates a group in cursor order */
+struct CMessageIndexKey {
+    char prefix;
+    std::string group;
+    CMessageCursor cursor;
+
+    CMessageIndexKey() : prefix(0) {}
+    CMessageIndexKey(char prefixIn, const std::string& groupIn, const CMessageCursor& cursorIn) : prefix(prefixIn), group(groupIn), cursor(cursorIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        s << prefix << group;
+        ser_writedata32be(s, cursor.nHeight);
+        s << cursor.out.hash;
+        ser_writedata32be(s, cursor.out.n);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        s >> prefix >> group;
+        cursor.nHeight = ser_readdata32be(s);
+        s >> cursor.out.hash;
+        cursor.out.n = ser_readdata32be(s);
+    }
+};
+
+static void WriteMessageIndexes(CDBBatch& batch, const CMessage& message)
+{
+    CMessageCursor cursor(message);
+    batch.Write(CMessageIndexKey(MESSAGE_HEIGHT_INDEX, "", cursor), '1');
+    batch.Write(CMessageIndexKey(MESSAGE_CHANNEL_INDEX, message.strName, cursor), '1');
+    batch.Write(CMessageIndexKey(MESSAGE_STATUS_INDEX, MessageStatusToString(message.status), cursor), '1');
+}
+
+static void EraseMessageIndexes(CDBBatch& batch, const CMessage& message)
+{
+    CMessageCursor cursor(message);
+    batch.Erase(CMessageIndexKey(MESSAGE_HEIGHT_INDEX, "", cursor));
+    batch.Erase(CMessageIndexKey(MESSAGE_CHANNEL_INDEX, message.strName, cursor));
+    batch.Erase(CMessageIndexKey(MESSAGE_STATUS_INDEX, MessageStatusToString(message.status), cursor));
+}
+
+CMessageCursor::CMessageCursor(const CMessage& message) : nHeight(message.nBlockHeight), out(message.out)
+{
+}
+
+std::string CMessageCursor::ToString() const
+{
+    return strprintf("%u-%s-%u", nHeight, out.hash.GetHex(), out.n);
+}
+
+bool CMessageCursor::FromString(const std::string& str, CMessageCursor& cursor)
+{
+    size_t nFirst = str.find('-');
+    size_t nLast = str.rfind('-');
+    if (nFirst == std::string::npos || nFirst == nLast)
+        return false;
+
+    int32_t nHeight, nOut;
+    std::string strHash = str.substr(nFirst + 1, nLast - nFirst - 1);
+    if (!ParseInt32(str.substr(0, nFirst), &nHeight) || nHeight < 0 || !IsHex(strHash) || strHash.size() != 64 ||
+        !ParseInt32(str.substr(nLast + 1), &nOut) || nOut < 0)
+        return false;
+
+    cursor = CMessageCursor(nHeight, COutPoint(uint256S(strHash), nOut));
+    return true;
+}
+
 CMessageDB::CMessageDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "messages" / "messages", nCacheSize, fMemory, fWipe) {
 }
 
 bool CMessageDB::WriteMessage(const CMessage &message)
 {
-    return Write(std::make_pair(MESSAGE_FLAG, message.out), message);
+    CDBBatch batch(*this);
+
+    // A rewritten message (e.g. one that was orphaned) may have moved within the indexes
+    CMessage oldMessage;
+    if (ReadMessage(message.out, oldMessage))
+        EraseMessageIndexes(batch, oldMessage);
+
+    batch.Write(std::make_pair(MESSAGE_FLAG, message.out), message);
+    WriteMessageIndexes(batch, message);
+    return WriteBatch(batch);
 }
 
 bool CMessageDB::ReadMessage(const COutPoint &out, CMessage &message)
@@ -31,32 +114,89 @@ bool CMessageDB::ReadMessage(const COutPoint &out, CMessage &message)
 
 bool CMessageDB::EraseMessage(const COutPoint &out)
 {
-    return Erase(std::make_pair(MESSAGE_FLAG, out));
+    CDBBatch batch(*this);
+
+    CMessage oldMessage;
+    if (ReadMessage(out, oldMessage))
+        EraseMessageIndexes(batch, oldMessage);
+
+    batch.Erase(std::make_pair(MESSAGE_FLAG, out));
+    return WriteBatch(batch);
 }
 
-bool CMessageDB::LoadMessages(std::set<CMessage>& setMessages)
+bool CMessageDB::BuildMessageIndexes()
 {
+    bool fIndexed;
+    if (ReadFlag("indexed", fIndexed) && fIndexed)
+        return true;
+
+    LogPrintf("%s: Building message indexes\n", __func__);
+
+    CDBBatch batch(*this);
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
 
     pcursor->Seek(std::make_pair(MESSAGE_FLAG, COutPoint()));
 
-    // Load messages
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
         std::pair<char, COutPoint> key;
         if (pcursor->GetKey(key) && key.first == MESSAGE_FLAG) {
             CMessage message;
             if (pcursor->GetValue(message)) {
-                setMessages.insert(message);
-                pcursor->Next();
+                WriteMessageIndexes(batch, message);
+                if (batch.SizeEstimate() > (size_t)nDefaultDbBatchSize) {
+                    if (!WriteBatch(batch))
+                        return error("%s: failed to write message indexes", __func__);
+                    batch.Clear();
+                }
             } else {
                 LogPrintf("%s: failed to read message\n", __func__);
-                pcursor->Next();
             }
+            pcursor->Next();
         } else {
             break;
         }
     }
+
+    if (!WriteBatch(batch))
+        return error("%s: failed to write message indexes", __func__);
+
+    return WriteFlag("indexed", true);
+}
+
+bool CMessageDB::ForEachIndexedMessage(const std::string& strChannel, const std::string& strStatus, const CMessageCursor& start,
+                                       const std::function<bool(const CMessage&)>& fn)
+{
+    char prefix = MESSAGE_HEIGHT_INDEX;
+    std::string group;
+    if (!strChannel.empty()) {
+        prefix = MESSAGE_CHANNEL_INDEX;
+        group = strChannel;
+    } else if (!strStatus.empty()) {
+        prefix = MESSAGE_STATUS_INDEX;
+        group = strStatus;
+    }
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(CMessageIndexKey(prefix, group, start));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        CMessageIndexKey key;
+        if (!pcursor->GetKey(key) || key.prefix != prefix || key.group != group)
+            break;
+
+        CMessage message;
+        if (ReadMessage(key.cursor.out, message)) {
+            if (!fn(message))
+                break;
+        } else {
+            LogPrintf("%s: failed to read indexed message %s\n", __func__, key.cursor.out.ToString());
+        }
+        pcursor->Next();
+    }
+
     return true;
 }
 
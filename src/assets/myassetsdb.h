@@ -6,9 +6,35 @@
 #define RAVENCOIN_MYASSETSDB_H
 
 #include <dbwrapper.h>
+#include <primitives/transaction.h>
+
+#include <functional>
 
 class CMessage;
-class COutPoint;
+
+/** Position of a message in the secondary message indexes. Indexed messages are ordered by block height, then outpoint */
+class CMessageCursor {
+public:
+    uint32_t nHeight;
+    COutPoint out;
+
+    CMessageCursor() : nHeight(0), out(uint256(), 0) {}
+    CMessageCursor(uint32_t nHeightIn, const COutPoint& outIn) : nHeight(nHeightIn), out(outIn) {}
+    explicit CMessageCursor(const CMessage& message);
+
+    std::string ToString() const;
+    static bool FromString(const std::string& str, CMessageCursor& cursor);
+
+    friend bool operator<(const CMessageCursor& a, const CMessageCursor& b)
+    {
+        return a.nHeight < b.nHeight || (a.nHeight == b.nHeight && a.out < b.out);
+    }
+
+    friend bool operator==(const CMessageCursor& a, const CMessageCursor& b)
+    {
+        return a.nHeight == b.nHeight && a.out == b.out;
+    }
+};
 
 class CMessageDB  : public CDBWrapper {
 
@@ -22,9 +48,19 @@ public:
     bool WriteMessage(const CMessage& message);
     bool ReadMessage(const COutPoint& out, CMessage& message);
     bool EraseMessage(const COutPoint& out);
-    bool LoadMessages(std::set<CMessage>& setMessages);
     bool EraseAllMessages(int& count);
 
+    // Secondary indexes by (channel, height) and (status, height), plus a plain height index
+    bool BuildMessageIndexes();
+
+    /**
+     * Walk stored messages in cursor order, starting at (and including) start. If strChannel is set only
+     * messages on that channel are visited, else if strStatus is set only messages with that status are.
+     * Iteration stops when fn returns false.
+     */
+    bool ForEachIndexedMessage(const std::string& strChannel, const std::string& strStatus, const CMessageCursor& start,
+                               const std::function<bool(const CMessage&)>& fn);
+
     // Write / Read Database flags
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
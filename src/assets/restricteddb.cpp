@@ -19,10 +19,29 @@ static const char GLOBAL_RESTRICTION_FLAG = 'G';
 CRestrictedDB::CRestrictedDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "assets" / "restricted", nCacheSize, fMemory, fWipe) {
 }
 
+void CRestrictedDB::BeginFlushBatch()
+{
+    pbatchFlush.reset(new CDBBatch(*this));
+}
+
+bool CRestrictedDB::CommitFlushBatch()
+{
+    if (!pbatchFlush)
+        return true;
+    bool ret = WriteBatch(*pbatchFlush);
+    pbatchFlush.reset();
+    return ret;
+}
+
+void CRestrictedDB::AbortFlushBatch()
+{
+    pbatchFlush.reset();
+}
+
 // Restricted Verifier Strings
 bool CRestrictedDB::WriteVerifier(const std::string& assetName, const std::string& verifier)
 {
-    return Write(std::make_pair(VERIFIER_FLAG, assetName), verifier);
+    return BatchWrite(std::make_pair(VERIFIER_FLAG, assetName), verifier);
 }
 
 bool CRestrictedDB::ReadVerifier(const std::string& assetName, std::string& verifier)
@@ -32,14 +51,14 @@ bool CRestrictedDB::ReadVerifier(const std::string& assetName, std::string& veri
 
 bool CRestrictedDB::EraseVerifier(const std::string& assetName)
 {
-    return Erase(std::make_pair(VERIFIER_FLAG, assetName));
+    return BatchErase(std::make_pair(VERIFIER_FLAG, assetName));
 }
 
 // Address Tags
 bool CRestrictedDB::WriteAddressQualifier(const std::string &address, const std::string &tag)
 {
     int8_t i = 1;
-    return Write(std::make_pair(ADDRESS_QULAIFIER_FLAG, std::make_pair(address, tag)), i);
+    return BatchWrite(std::make_pair(ADDRESS_QULAIFIER_FLAG, std::make_pair(address, tag)), i);
 }
 
 bool CRestrictedDB::ReadAddressQualifier(const std::string &address, const std::string &tag)
@@ -50,14 +69,14 @@ bool CRestrictedDB::ReadAddressQualifier(const std::string &address, const std::
 
 bool CRestrictedDB::EraseAddressQualifier(const std::string &address, const std::string &tag)
 {
-    return Erase(std::make_pair(ADDRESS_QULAIFIER_FLAG, std::make_pair(address, tag)));
+    return BatchErase(std::make_pair(ADDRESS_QULAIFIER_FLAG, std::make_pair(address, tag)));
 }
 
 // Address Tags
 bool CRestrictedDB::WriteQualifierAddress(const std::string &address, const std::string &tag)
 {
     int8_t i = 1;
-    return Write(std::make_pair(QULAIFIER_ADDRESS_FLAG, std::make_pair(tag, address)), i);
+    return BatchWrite(std::make_pair(QULAIFIER_ADDRESS_FLAG, std::make_pair(tag, address)), i);
 }
 
 bool CRestrictedDB::ReadQualifierAddress(const std::string &address, const std::string &tag)
@@ -68,7 +87,7 @@ bool CRestrictedDB::ReadQualifierAddress(const std::string &address, const std::
 
 bool CRestrictedDB::EraseQualifierAddress(const std::string &address, const std::string &tag)
 {
-    return Erase(std::make_pair(QULAIFIER_ADDRESS_FLAG, std::make_pair(tag, address)));
+    return BatchErase(std::make_pair(QULAIFIER_ADDRESS_FLAG, std::make_pair(tag, address)));
 }
 
 
@@ -76,7 +95,7 @@ bool CRestrictedDB::EraseQualifierAddress(const std::string &address, const std:
 bool CRestrictedDB::WriteRestrictedAddress(const std::string& address, const std::string& assetName)
 {
     int8_t i = 1;
-    return Write(std::make_pair(RESTRICTED_ADDRESS_FLAG, std::make_pair(address, assetName)), i);
+    return BatchWrite(std::make_pair(RESTRICTED_ADDRESS_FLAG, std::make_pair(address, assetName)), i);
 }
 
 bool CRestrictedDB::ReadRestrictedAddress(const std::string& address, const std::string& assetName)
@@ -87,14 +106,14 @@ bool CRestrictedDB::ReadRestrictedAddress(const std::string& address, const std:
 
 bool CRestrictedDB::EraseRestrictedAddress(const std::string& address, const std::string& assetName)
 {
-    return Erase(std::make_pair(RESTRICTED_ADDRESS_FLAG, std::make_pair(address, assetName)));
+    return BatchErase(std::make_pair(RESTRICTED_ADDRESS_FLAG, std::make_pair(address, assetName)));
 }
 
 // Global Restriction
 bool CRestrictedDB::WriteGlobalRestriction(const std::string& assetName)
 {
     int8_t i = 1;
-    return Write(std::make_pair(GLOBAL_RESTRICTION_FLAG, assetName), i);
+    return BatchWrite(std::make_pair(GLOBAL_RESTRICTION_FLAG, assetName), i);
 }
 
 bool CRestrictedDB::ReadGlobalRestriction(const std::string& assetName)
@@ -105,7 +124,7 @@ bool CRestrictedDB::ReadGlobalRestriction(const std::string& assetName)
 
 bool CRestrictedDB::EraseGlobalRestriction(const std::string& assetName)
 {
-    return Erase(std::make_pair(GLOBAL_RESTRICTION_FLAG, assetName));
+    return BatchErase(std::make_pair(GLOBAL_RESTRICTION_FLAG, assetName));
 }
 
 bool CRestrictedDB::WriteFlag(const std::string &name, bool fValue)
@@ -8,14 +8,44 @@
 
 #include <dbwrapper.h>
 
+#include <memory>
+
 class CRestrictedDB  : public CDBWrapper {
 
+private:
+    // Open between BeginFlushBatch and CommitFlushBatch
+    std::unique_ptr<CDBBatch> pbatchFlush;
+
+    template <typename K, typename V>
+    bool BatchWrite(const K& key, const V& value)
+    {
+        if (!pbatchFlush)
+            return Write(key, value);
+        pbatchFlush->Write(key, value);
+        return true;
+    }
+
+    template <typename K>
+    bool BatchErase(const K& key)
+    {
+        if (!pbatchFlush)
+            return Erase(key);
+        pbatchFlush->Erase(key);
+        return true;
+    }
+
 public:
     explicit CRestrictedDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
 
     CRestrictedDB(const CRestrictedDB&) = delete;
     CRestrictedDB& operator=(const CRestrictedDB&) = delete;
 
+    // Writes and erases made between these reach the database as a single batch at
+    // CommitFlushBatch; AbortFlushBatch drops them
+    void BeginFlushBatch();
+    bool CommitFlushBatch();
+    void AbortFlushBatch();
+
     // Database of restricted asset verifier strings
     bool WriteVerifier(const std::string& assetName, const std::string& verifier);
     bool ReadVerifier(const std::string& assetName, std::string& verifier);
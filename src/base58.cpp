@@ -18,6 +18,31 @@
 
 /** All alphanumeric characters except for "0", "I", "O", and "l" */
 static const char* pszBase58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+static const int8_t mapBase58[256] = {
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    -1, 0, 1, 2, 3, 4, 5, 6,  7, 8,-1,-1,-1,-1,-1,-1,
+    -1, 9,10,11,12,13,14,15, 16,-1,17,18,19,20,21,-1,
+    22,23,24,25,26,27,28,29, 30,31,32,-1,-1,-1,-1,-1,
+    -1,33,34,35,36,37,38,39, 40,41,42,43,-1,44,45,46,
+    47,48,49,50,51,52,53,54, 55,56,57,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+};
+
+// The codec works on multi-digit limbs rather than single digits: the base58
+// side is kept in limbs of BASE58_LIMB_DIGITS digits and the binary side in
+// 32-bit words, so each pass of the inner loop moves several digits at once.
+static const int BASE58_LIMB_DIGITS = 5;
+static const uint32_t BASE58_LIMB = 58 * 58 * 58 * 58 * 58; // 58^5 < 2^30
+static const uint32_t pow58[BASE58_LIMB_DIGITS + 1] = {1, 58, 58 * 58, 58 * 58 * 58, 58 * 58 * 58 * 58, BASE58_LIMB};
 
 bool DecodeBase58(const char* psz, std::vector<unsigned char>& vch)
 {
@@ -26,46 +51,59 @@ bool DecodeBase58(const char* psz, std::vector<unsigned char>& vch)
         psz++;
     // Skip and count leading '1's.
     int zeroes = 0;
-    int length = 0;
     while (*psz == '1') {
         zeroes++;
         psz++;
     }
-    // Allocate enough space in big-endian base256 representation.
-    int size = strlen(psz) * 733 /1000 + 1; // log(58) / log(256), rounded up.
-    std::vector<unsigned char> b256(size);
-    // Process the characters.
+    // Find the digits and validate them up front.
+    const char* pdigits = psz;
     while (*psz && !isspace(*psz)) {
-        // Decode base58 character
-        const char* ch = strchr(pszBase58, *psz);
-        if (ch == nullptr)
+        if (mapBase58[(uint8_t)*psz] == -1)
             return false;
-        // Apply "b256 = b256 * 58 + ch".
-        int carry = ch - pszBase58;
-        int i = 0;
-        for (std::vector<unsigned char>::reverse_iterator it = b256.rbegin(); (carry != 0 || i < length) && (it != b256.rend()); ++it, ++i) {
-            carry += 58 * (*it);
-            *it = carry % 256;
-            carry /= 256;
-        }
-        assert(carry == 0);
-        length = i;
         psz++;
     }
+    const char* pend = psz;
+    int digits = pend - pdigits;
     // Skip trailing spaces.
     while (isspace(*psz))
         psz++;
     if (*psz != 0)
         return false;
-    // Skip leading zeroes in b256.
-    std::vector<unsigned char>::iterator it = b256.begin() + (size - length);
-    while (it != b256.end() && *it == 0)
-        it++;
-    // Copy result into output vector.
-    vch.reserve(zeroes + (b256.end() - it));
+    // Little-endian base 2^32 words, enough for log(58) / log(2^32) per digit, rounded up.
+    std::vector<uint32_t> b32(digits * 733 / 4000 + 1);
+    size_t length = 0;
+    // Process the digits in groups of BASE58_LIMB_DIGITS, leading with the remainder.
+    int group = digits % BASE58_LIMB_DIGITS;
+    if (group == 0)
+        group = BASE58_LIMB_DIGITS;
+    for (const char* p = pdigits; p != pend; group = BASE58_LIMB_DIGITS) {
+        // Apply "b32 = b32 * 58^group + digits".
+        uint64_t carry = 0;
+        for (int i = 0; i < group; i++)
+            carry = carry * 58 + mapBase58[(uint8_t)*(p++)];
+        for (size_t i = 0; i < length; i++) {
+            carry += (uint64_t)b32[i] * pow58[group];
+            b32[i] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            assert(length < b32.size());
+            b32[length++] = (uint32_t)carry;
+        }
+    }
+    // Copy result into output vector, skipping leading zero bytes of the top word.
     vch.assign(zeroes, 0x00);
-    while (it != b256.end())
-        vch.push_back(*(it++));
+    vch.reserve(zeroes + length * 4);
+    bool fLeading = true;
+    for (size_t i = length; i-- > 0; ) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            unsigned char c = (b32[i] >> shift) & 0xff;
+            if (fLeading && c == 0)
+                continue;
+            fLeading = false;
+            vch.push_back(c);
+        }
+    }
     return true;
 }
 
@@ -73,39 +111,50 @@ std::string EncodeBase58(const unsigned char* pbegin, const unsigned char* pend)
 {
     // Skip & count leading zeroes.
     int zeroes = 0;
-    int length = 0;
     while (pbegin != pend && *pbegin == 0) {
         pbegin++;
         zeroes++;
     }
-    // Allocate enough space in big-endian base58 representation.
-    int size = (pend - pbegin) * 138 / 100 + 1; // log(256) / log(58), rounded up.
-    std::vector<unsigned char> b58(size);
-    // Process the bytes.
+    // Little-endian base 58^5 limbs, enough for log(256) / log(58) digits per byte, rounded up.
+    int size = ((pend - pbegin) * 138 / 100 + 1) / BASE58_LIMB_DIGITS + 1;
+    std::vector<uint32_t> b58(size);
+    size_t length = 0;
+    // Process the bytes three at a time, leading with the remainder.
+    int group = (pend - pbegin) % 3;
+    if (group == 0)
+        group = 3;
     while (pbegin != pend) {
-        int carry = *pbegin;
-        int i = 0;
-        // Apply "b58 = b58 * 256 + ch".
-        for (std::vector<unsigned char>::reverse_iterator it = b58.rbegin(); (carry != 0 || i < length) && (it != b58.rend()); it++, i++) {
-            carry += 256 * (*it);
-            *it = carry % 58;
-            carry /= 58;
+        // Apply "b58 = b58 * 256^group + bytes".
+        uint64_t carry = 0;
+        for (int i = 0; i < group; i++)
+            carry = (carry << 8) | *(pbegin++);
+        int shift = 8 * group;
+        for (size_t i = 0; i < length; i++) {
+            carry += (uint64_t)b58[i] << shift;
+            b58[i] = carry % BASE58_LIMB;
+            carry /= BASE58_LIMB;
         }
-
-        assert(carry == 0);
-        length = i;
-        pbegin++;
+        while (carry != 0) {
+            assert(length < b58.size());
+            b58[length++] = carry % BASE58_LIMB;
+            carry /= BASE58_LIMB;
+        }
+        group = 3;
     }
-    // Skip leading zeroes in base58 result.
-    std::vector<unsigned char>::iterator it = b58.begin() + (size - length);
-    while (it != b58.end() && *it == 0)
-        it++;
-    // Translate the result into a string.
+    // Translate the result into a string: the top limb without its leading
+    // zero digits, every other limb as exactly BASE58_LIMB_DIGITS digits.
     std::string str;
-    str.reserve(zeroes + (b58.end() - it));
+    str.reserve(zeroes + length * BASE58_LIMB_DIGITS);
     str.assign(zeroes, '1');
-    while (it != b58.end())
-        str += pszBase58[*(it++)];
+    for (size_t i = length; i-- > 0; ) {
+        int digit = BASE58_LIMB_DIGITS;
+        if (i == length - 1) {
+            while (digit > 1 && b58[i] < pow58[digit - 1])
+                digit--;
+        }
+        while (digit-- > 0)
+            str += pszBase58[(b58[i] / pow58[digit]) % 58];
+    }
     return str;
 }
 
@@ -121,8 +170,10 @@ bool DecodeBase58(const std::string& str, std::vector<unsigned char>& vchRet)
 
 std::string EncodeBase58Check(const std::vector<unsigned char>& vchIn)
 {
-    // add 4-byte hash check to the end
-    std::vector<unsigned char> vch(vchIn);
+    // add 4-byte hash check to the end, sized up front so the copy is not reallocated
+    std::vector<unsigned char> vch;
+    vch.reserve(vchIn.size() + 4);
+    vch.assign(vchIn.begin(), vchIn.end());
     uint256 hash = Hash(vch.begin(), vch.end());
     vch.insert(vch.end(), (unsigned char*)&hash, (unsigned char*)&hash + 4);
     return EncodeBase58(vch);
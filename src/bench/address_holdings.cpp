@@ -0,0 +1,93 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "assets/assetdb.h"
+#include "fs.h"
+#include "random.h"
+#include "tinyformat.h"
+#include "util.h"
+
+#include <boost/thread.hpp>
+
+// A million holdings: 100000 addresses holding ten assets each
+static const int NUM_ADDRESSES = 100000;
+static const int HOLDINGS_PER_ADDRESS = 10;
+
+static std::string BenchAddress(int n)
+{
+    return strprintf("RBenchHoldingsAddress%06d", n);
+}
+
+// The database is built once and shared, it takes a while
+static CAssetsDB& GetHoldingsDB()
+{
+    static std::unique_ptr<CAssetsDB> pdb;
+    if (!pdb) {
+        fs::path pathDataDir = fs::temp_directory_path() / strprintf("bench_raven_%lu", (unsigned long)GetRand(1ULL << 32));
+        gArgs.ForceSetArg("-datadir", pathDataDir.string());
+        ClearDatadirCache();
+        pdb.reset(new CAssetsDB(1 << 20, true, true));
+        for (int i = 0; i < NUM_ADDRESSES; i++)
+            for (int j = 0; j < HOLDINGS_PER_ADDRESS; j++)
+                pdb->WriteAddressAssetQuantity(BenchAddress(i), strprintf("ASSET%d", j), COIN);
+        fs::remove_all(pathDataDir);
+        gArgs.ForceSetArg("-datadir", "");
+        ClearDatadirCache();
+    }
+    return *pdb;
+}
+
+// How listassetbalancesbyaddress counted holdings before: from the address to the end of the database
+static void AddressHoldingsTotalByScan(benchmark::State& state)
+{
+    CAssetsDB& db = GetHoldingsDB();
+    const std::string address = BenchAddress(NUM_ADDRESSES / 2);
+
+    while (state.KeepRunning()) {
+        std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+        // 'C' keys the address -> asset quantity records
+        pcursor->Seek(std::make_pair('C', std::make_pair(address, std::string())));
+        int totalEntries = 0;
+        while (pcursor->Valid()) {
+            boost::this_thread::interruption_point();
+
+            std::pair<char, std::pair<std::string, std::string> > key;
+            if (pcursor->GetKey(key) && key.first == 'C' && key.second.first == address) {
+                totalEntries++;
+            }
+            pcursor->Next();
+        }
+        assert(totalEntries == HOLDINGS_PER_ADDRESS);
+    }
+}
+
+static void AddressHoldingsTotal(benchmark::State& state)
+{
+    CAssetsDB& db = GetHoldingsDB();
+    const std::string address = BenchAddress(NUM_ADDRESSES / 2);
+
+    while (state.KeepRunning()) {
+        int totalEntries = 0;
+        db.ReadAddressHoldingCount(address, totalEntries);
+        assert(totalEntries == HOLDINGS_PER_ADDRESS);
+    }
+}
+
+static void AddressHoldingsTailPage(benchmark::State& state)
+{
+    CAssetsDB& db = GetHoldingsDB();
+    const std::string address = BenchAddress(NUM_ADDRESSES / 2);
+
+    while (state.KeepRunning()) {
+        std::vector<std::pair<std::string, CAmount> > vecAssetAmount;
+        db.ReadAddressAssetQuantities(address, vecAssetAmount, 3, -3);
+        assert(vecAssetAmount.size() == 3);
+    }
+}
+
+BENCHMARK(AddressHoldingsTotalByScan);
+BENCHMARK(AddressHoldingsTotal);
+BENCHMARK(AddressHoldingsTailPage);
@@ -0,0 +1,93 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "addrman.h"
+#include "streams.h"
+#include "clientversion.h"
+
+#include <vector>
+
+// A table about the size of a well connected node's: addresses spread over
+// many sources, a tenth of them connected to at some point.
+static const int NUM_ADDRESSES = 20000;
+static const int NUM_SOURCES = 250;
+
+static CService BenchService(uint32_t n)
+{
+    struct in_addr ip;
+    ip.s_addr = htonl(0x20000000 | (n & 0x00ffffff));
+    return CService(CNetAddr(ip), 8767);
+}
+
+static std::vector<CAddress> FillAddrMan(CAddrMan& addrman)
+{
+    std::vector<CAddress> vAddr;
+    for (int i = 0; i < NUM_ADDRESSES; i++) {
+        CAddress addr(BenchService(i * 7919 + 1), NODE_NETWORK);
+        addr.nTime = GetAdjustedTime();
+        struct in_addr source;
+        source.s_addr = htonl(0x30000000 | ((i % NUM_SOURCES) << 8));
+        addrman.Add(addr, CNetAddr(source));
+        vAddr.push_back(addr);
+    }
+    for (size_t i = 0; i < vAddr.size(); i += 10)
+        addrman.Good(vAddr[i]);
+    return vAddr;
+}
+
+static void AddrManSelect(benchmark::State& state)
+{
+    CAddrMan addrman;
+    FillAddrMan(addrman);
+
+    while (state.KeepRunning()) {
+        addrman.Select();
+    }
+}
+
+static void AddrManSelectNew(benchmark::State& state)
+{
+    CAddrMan addrman;
+    FillAddrMan(addrman);
+
+    while (state.KeepRunning()) {
+        addrman.Select(true);
+    }
+}
+
+// What a full peers.dat write used to cost on every periodic dump
+static void AddrManSerialize(benchmark::State& state)
+{
+    CAddrMan addrman;
+    FillAddrMan(addrman);
+
+    while (state.KeepRunning()) {
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss << addrman;
+    }
+}
+
+// What an incremental dump costs when a few hundred addresses changed
+static void AddrManLogChanges(benchmark::State& state)
+{
+    CAddrMan addrman;
+    std::vector<CAddress> vAddr = FillAddrMan(addrman);
+    std::vector<CAddrLogEntry> vChanges;
+    addrman.TakeChanges(vChanges);
+    size_t n = 0;
+
+    while (state.KeepRunning()) {
+        for (int i = 0; i < 300; i++)
+            addrman.Attempt(vAddr[n++ % vAddr.size()], true);
+        addrman.TakeChanges(vChanges);
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss << vChanges;
+    }
+}
+
+BENCHMARK(AddrManSelect);
+BENCHMARK(AddrManSelectNew);
+BENCHMARK(AddrManSerialize);
+BENCHMARK(AddrManLogChanges);
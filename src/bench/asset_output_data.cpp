@@ -0,0 +1,47 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "assets/assets.h"
+#include "script/standard.h"
+#include "utilstrencodings.h"
+#include "wallet/wallet.h"
+
+// Transfer outputs to one address, each for a different amount so each script differs
+static std::vector<CScript> TransferScripts(size_t nCount)
+{
+    std::vector<CScript> vScripts;
+    for (size_t i = 0; i < nCount; i++) {
+        CScript script = GetScriptForDestination(CKeyID(uint160(ParseHex("0123456789abcdef0123456789abcdef01234567"))));
+        CAssetTransfer transfer("BENCH_ASSET", COIN + i);
+        transfer.ConstructTransaction(script);
+        vScripts.push_back(script);
+    }
+    return vScripts;
+}
+
+// The same output parsed again, as when it is connected after entering the mempool
+static void AssetDataCached(benchmark::State& state)
+{
+    std::vector<CScript> vScripts = TransferScripts(1);
+    CAssetOutputEntry data;
+    while (state.KeepRunning()) {
+        GetAssetData(vScripts[0], data);
+    }
+}
+
+// More outputs than the cache keeps, taken in turn, so each is parsed from the script
+static void AssetDataParse(benchmark::State& state)
+{
+    std::vector<CScript> vScripts = TransferScripts(2 * MAX_CACHE_ASSET_OUTPUTS_SIZE);
+    CAssetOutputEntry data;
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        GetAssetData(vScripts[i++ % vScripts.size()], data);
+    }
+}
+
+BENCHMARK(AssetDataCached);
+BENCHMARK(AssetDataParse);
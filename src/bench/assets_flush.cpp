@@ -0,0 +1,67 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "assets/assetdb.h"
+#include "fs.h"
+#include "random.h"
+#include "tinyformat.h"
+#include "util.h"
+
+// What one flush of the assets cache writes after a stretch of asset heavy
+// blocks: new balances for 2000 addresses holding five assets each
+static const int NUM_ADDRESSES = 2000;
+static const int HOLDINGS_PER_ADDRESS = 5;
+
+static std::unique_ptr<CAssetsDB> NewFlushDB()
+{
+    fs::path pathDataDir = fs::temp_directory_path() / strprintf("bench_raven_%lu", (unsigned long)GetRand(1ULL << 32));
+    gArgs.ForceSetArg("-datadir", pathDataDir.string());
+    ClearDatadirCache();
+    std::unique_ptr<CAssetsDB> pdb(new CAssetsDB(1 << 20, true, true));
+    fs::remove_all(pathDataDir);
+    gArgs.ForceSetArg("-datadir", "");
+    ClearDatadirCache();
+    return pdb;
+}
+
+static void WriteBalances(CAssetsDB& db, CAmount nAmount)
+{
+    for (int i = 0; i < NUM_ADDRESSES; i++) {
+        std::string address = strprintf("RBenchFlushAddress%06d", i);
+        for (int j = 0; j < HOLDINGS_PER_ADDRESS; j++) {
+            std::string assetName = strprintf("ASSET%d", j);
+            db.WriteAssetAddressQuantity(assetName, address, nAmount);
+            db.WriteAddressAssetQuantity(address, assetName, nAmount);
+        }
+    }
+}
+
+// Every record written on its own, as the assets cache dump used to
+static void AssetsFlushWrites(benchmark::State& state)
+{
+    std::unique_ptr<CAssetsDB> pdb = NewFlushDB();
+    CAmount nAmount = 0;
+
+    while (state.KeepRunning()) {
+        WriteBalances(*pdb, ++nAmount);
+    }
+}
+
+static void AssetsFlushBatch(benchmark::State& state)
+{
+    std::unique_ptr<CAssetsDB> pdb = NewFlushDB();
+    CAmount nAmount = 0;
+
+    while (state.KeepRunning()) {
+        pdb->BeginFlushBatch();
+        WriteBalances(*pdb, ++nAmount);
+        bool fCommitted = pdb->CommitFlushBatch();
+        assert(fCommitted);
+    }
+}
+
+BENCHMARK(AssetsFlushWrites);
+BENCHMARK(AssetsFlushBatch);
@@ -55,6 +55,37 @@ static void Base58Decode(benchmark::State& state)
 }
 
 
+static void Base58CheckDecode(benchmark::State& state)
+{
+    const char* addr = "RXissueAssetXXXXXXXXXXXXXXXXXhhZGt";
+    std::vector<unsigned char> vch;
+    while (state.KeepRunning()) {
+        DecodeBase58Check(addr, vch);
+    }
+}
+
+
+// Round trip a batch of distinct address payloads, as an address index
+// RPC or a snapshot of asset holders does.
+static void Base58AddressBatch(benchmark::State& state)
+{
+    std::vector<std::vector<unsigned char>> payloads(1000, std::vector<unsigned char>(21));
+    for (size_t i = 0; i < payloads.size(); i++) {
+        payloads[i][0] = 60;
+        for (size_t j = 1; j < payloads[i].size(); j++)
+            payloads[i][j] = (i * 7919 + j * 104729) & 0xff;
+    }
+    std::vector<unsigned char> vch;
+    while (state.KeepRunning()) {
+        for (const auto& payload : payloads) {
+            DecodeBase58Check(EncodeBase58Check(payload), vch);
+        }
+    }
+}
+
+
 BENCHMARK(Base58Encode);
 BENCHMARK(Base58CheckEncode);
 BENCHMARK(Base58Decode);
+BENCHMARK(Base58CheckDecode);
+BENCHMARK(Base58AddressBatch);
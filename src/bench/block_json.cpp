@@ -0,0 +1,84 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "assets/assets.h"
+#include "base58.h"
+#include "chain.h"
+#include "core_io.h"
+#include "primitives/block.h"
+#include "rpc/blockchain.h"
+#include "tinyformat.h"
+
+#include <univalue.h>
+
+// An asset heavy block: transfers from a few busy addresses, each with an
+// asset output, a change output and a fee output
+static const int NUM_TXS = 1000;
+static const int NUM_ADDRESSES = 50;
+
+static CBlock MakeAssetBlock()
+{
+    std::vector<CScript> vAddresses;
+    for (int i = 0; i < NUM_ADDRESSES; i++) {
+        std::vector<unsigned char> vchHash(20, 0);
+        vchHash[0] = i + 1;
+        vAddresses.push_back(GetScriptForDestination(CKeyID(uint160(vchHash))));
+    }
+
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].scriptSig = CScript() << 1 << OP_0;
+    coinbase.vout.resize(1);
+    coinbase.vout[0].scriptPubKey = vAddresses[0];
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+
+    for (int i = 0; i < NUM_TXS; i++) {
+        CMutableTransaction tx;
+        tx.vin.resize(2);
+        for (int j = 0; j < 2; j++) {
+            tx.vin[j].prevout = COutPoint(uint256S(strprintf("%064x", i + 1)), j);
+            tx.vin[j].scriptSig = CScript() << std::vector<unsigned char>(71, 0x30) << std::vector<unsigned char>(33, 0x02);
+        }
+
+        CScript assetScript = vAddresses[(i * 7) % NUM_ADDRESSES];
+        CAssetTransfer(strprintf("BENCH_ASSET_%d", i % 20), (i + 1) * COIN).ConstructTransaction(assetScript);
+        tx.vout.resize(3);
+        tx.vout[0].scriptPubKey = assetScript;
+        tx.vout[1].scriptPubKey = vAddresses[(i * 13) % NUM_ADDRESSES];
+        tx.vout[1].nValue = COIN;
+        tx.vout[2].scriptPubKey = vAddresses[0];
+        tx.vout[2].nValue = COIN / 100;
+        block.vtx.push_back(MakeTransactionRef(tx));
+    }
+    return block;
+}
+
+// getblock with verbosity 2, written out as the RPC server does
+static void GetBlockVerbose(benchmark::State& state, unsigned int script_fields)
+{
+    CBlock block = MakeAssetBlock();
+    CBlockIndex index(block);
+    uint256 hashBlock = block.GetHash();
+    index.phashBlock = &hashBlock;
+
+    while (state.KeepRunning()) {
+        std::string strJSON = blockToJSON(block, &index, true, script_fields).write();
+        assert(!strJSON.empty());
+    }
+}
+
+static void GetBlockVerbose2(benchmark::State& state)
+{
+    GetBlockVerbose(state, SCRIPT_FIELDS_ALL);
+}
+
+static void GetBlockVerbose2NoScripts(benchmark::State& state)
+{
+    GetBlockVerbose(state, 0);
+}
+
+BENCHMARK(GetBlockVerbose2);
+BENCHMARK(GetBlockVerbose2NoScripts);
@@ -0,0 +1,73 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "arith_uint256.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "pow.h"
+#include "random.h"
+
+#include <vector>
+
+static const int NUM_HEADERS = 20000;
+
+// A post-KAWPOW mainnet-like header chain: spacing jittered around a minute
+// and nBits wandering within a few percent, as DarkGravityWave sees in practice.
+struct BenchHeaderChain
+{
+    std::vector<uint256> vHashes;
+    std::vector<CBlockIndex> vIndex;
+
+    BenchHeaderChain() : vHashes(NUM_HEADERS), vIndex(NUM_HEADERS)
+    {
+        FastRandomContext rng(true);
+        arith_uint256 bnTarget = arith_uint256().SetCompact(0x1b01c2d0);
+        for (int i = 0; i < NUM_HEADERS; i++) {
+            vHashes[i] = rng.rand256();
+            CBlockIndex& index = vIndex[i];
+            index.phashBlock = &vHashes[i];
+            index.pprev = i ? &vIndex[i - 1] : nullptr;
+            index.nHeight = 1200000 + i;
+            index.nTime = (i ? vIndex[i - 1].nTime : nKAWPOWActivationTime) + 30 + rng.randrange(61);
+            bnTarget = bnTarget * (uint32_t)(990 + rng.randrange(21)) / 1000;
+            index.nBits = bnTarget.GetCompact();
+        }
+    }
+};
+
+// Every header checked once in turn, as during header sync
+static void DarkGravityWaveHeaderSync(benchmark::State& state)
+{
+    BenchHeaderChain chain;
+    const Consensus::Params& params = GetParams().GetConsensus();
+    size_t n = 180;
+
+    while (state.KeepRunning()) {
+        const CBlockIndex* pindexLast = &chain.vIndex[n];
+        CBlockHeader header;
+        header.nTime = pindexLast->nTime + 60;
+        GetNextWorkRequired(pindexLast, &header, params);
+        if (++n == chain.vIndex.size())
+            n = 180;
+    }
+}
+
+// The same tip asked for again, as by CreateNewBlock and getblocktemplate
+static void DarkGravityWaveSameTip(benchmark::State& state)
+{
+    BenchHeaderChain chain;
+    const Consensus::Params& params = GetParams().GetConsensus();
+    const CBlockIndex* pindexLast = &chain.vIndex.back();
+    CBlockHeader header;
+    header.nTime = pindexLast->nTime + 60;
+
+    while (state.KeepRunning()) {
+        GetNextWorkRequired(pindexLast, &header, params);
+    }
+}
+
+BENCHMARK(DarkGravityWaveHeaderSync);
+BENCHMARK(DarkGravityWaveSameTip);
@@ -8,6 +8,7 @@
 #include "support/lockedpool.h"
 
 #include <iostream>
+#include <thread>
 #include <vector>
 
 #define ASIZE 2048
@@ -44,5 +45,42 @@ static void BenchLockedPool(benchmark::State& state)
     addr.clear();
 }
 
+// Small secure allocations as keys and hashes make them, through the process
+// wide pool, from one thread and from several at once
+static void LockedPoolSmallChunks(LockedPool& pool, int iterations)
+{
+    void *addr[16] = {};
+    for (int x = 0; x < iterations; ++x) {
+        int idx = x & 15;
+        if (addr[idx])
+            pool.free(addr[idx]);
+        addr[idx] = pool.alloc(32 + (x & 3) * 16);
+    }
+    for (void *ptr: addr)
+        pool.free(ptr);
+}
+
+static void BenchLockedPoolSmall(benchmark::State& state)
+{
+    LockedPool& pool = LockedPoolManager::Instance();
+    while (state.KeepRunning()) {
+        LockedPoolSmallChunks(pool, 4000);
+    }
+}
+
+static void BenchLockedPoolSmallThreads(benchmark::State& state)
+{
+    LockedPool& pool = LockedPoolManager::Instance();
+    while (state.KeepRunning()) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back(LockedPoolSmallChunks, std::ref(pool), 1000);
+        for (std::thread& thread: threads)
+            thread.join();
+    }
+}
+
 BENCHMARK(BenchLockedPool);
+BENCHMARK(BenchLockedPoolSmall);
+BENCHMARK(BenchLockedPoolSmallThreads);
 
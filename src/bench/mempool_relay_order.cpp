@@ -0,0 +1,86 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "policy/policy.h"
+#include "txmempool.h"
+#include "validation.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+// Number of transactions in the mempool, all of them waiting in a peer's
+// inventory, as after a burst of transactions with a slow trickle timer.
+static const int RELAY_INVENTORY_SIZE = 10000;
+
+static void FillMempool(CTxMemPool& pool, std::set<uint256>& setInventory)
+{
+    LOCK(pool.cs);
+    uint256 hashPrev;
+    for (int i = 0; i < RELAY_INVENTORY_SIZE; ++i) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].scriptSig = CScript() << i;
+        // Every fourth transaction starts a new chain, the others spend their predecessor
+        if (i % 4)
+            tx.vin[0].prevout = COutPoint(hashPrev, 0);
+        tx.vout.resize(1);
+        tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+        tx.vout[0].nValue = 10 * COIN;
+
+        LockPoints lp;
+        pool.addUnchecked(tx.GetHash(), CTxMemPoolEntry(MakeTransactionRef(tx), 1000 + (i * 7919) % 50000,
+                                                        0, 1, false, 4, lp));
+        hashPrev = tx.GetHash();
+        setInventory.insert(hashPrev);
+    }
+}
+
+// One trickle of SendMessages ordering a peer's full inventory with a
+// comparator that looks up both transactions in the mempool.
+static void RelayOrderDepthAndScore(benchmark::State& state)
+{
+    CTxMemPool pool;
+    std::set<uint256> setInventory;
+    FillMempool(pool, setInventory);
+
+    while (state.KeepRunning()) {
+        std::vector<std::set<uint256>::iterator> vInvTx;
+        vInvTx.reserve(setInventory.size());
+        for (auto it = setInventory.begin(); it != setInventory.end(); ++it)
+            vInvTx.push_back(it);
+        auto compare = [&pool](std::set<uint256>::iterator a, std::set<uint256>::iterator b) {
+            return pool.CompareDepthAndScore(*b, *a);
+        };
+        std::make_heap(vInvTx.begin(), vInvTx.end(), compare);
+        for (unsigned int i = 0; i < INVENTORY_BROADCAST_MAX && !vInvTx.empty(); ++i) {
+            std::pop_heap(vInvTx.begin(), vInvTx.end(), compare);
+            vInvTx.pop_back();
+        }
+    }
+}
+
+// The same trickle using relay order keys read from the mempool in one pass.
+static void RelayOrderKeys(benchmark::State& state)
+{
+    CTxMemPool pool;
+    std::set<uint256> setInventory;
+    FillMempool(pool, setInventory);
+
+    while (state.KeepRunning()) {
+        std::vector<uint256> vInvHashes(setInventory.begin(), setInventory.end());
+        std::vector<TxRelayOrderKey> vInvTx;
+        pool.GetRelayOrderKeys(vInvHashes, vInvTx);
+        auto compare = [](const TxRelayOrderKey& a, const TxRelayOrderKey& b) { return b < a; };
+        std::make_heap(vInvTx.begin(), vInvTx.end(), compare);
+        for (unsigned int i = 0; i < INVENTORY_BROADCAST_MAX && !vInvTx.empty(); ++i) {
+            std::pop_heap(vInvTx.begin(), vInvTx.end(), compare);
+            vInvTx.pop_back();
+        }
+    }
+}
+
+BENCHMARK(RelayOrderDepthAndScore);
+BENCHMARK(RelayOrderKeys);
@@ -0,0 +1,145 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "tinyformat.h"
+#include "txmempool.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Restricted transfers waiting in the mempool, spread over a few assets and
+// many addresses, each spending one coin and paying one address.
+static const int NUM_TRANSFERS = 5000;
+static const int NUM_ASSETS = 50;
+static const int NUM_ADDRESSES = 1000;
+
+struct RestrictedTransfer {
+    uint256 hash;
+    std::string strAsset;
+    std::string strFrom;
+    std::string strTo;
+};
+
+static std::vector<RestrictedTransfer> MakeTransfers()
+{
+    std::vector<RestrictedTransfer> vTransfers;
+    for (int i = 0; i < NUM_TRANSFERS; i++) {
+        RestrictedTransfer transfer;
+        transfer.hash = uint256S(strprintf("%064x", i + 1));
+        transfer.strAsset = strprintf("$RESTRICTED_ASSET_%d", i % NUM_ASSETS);
+        transfer.strFrom = strprintf("RXissueSignaturesExampleAddress%04d", (i * 7) % NUM_ADDRESSES);
+        transfer.strTo = strprintf("RXissueSignaturesExampleAddress%04d", (i * 13) % NUM_ADDRESSES);
+        vTransfers.push_back(transfer);
+    }
+    return vTransfers;
+}
+
+// The restricted asset maps as CTxMemPool kept them before they were interned
+struct StdMapIndexes {
+    std::map<std::pair<std::string, std::string>, std::set<uint256> > mapAddressesMarkedFrozen;
+    std::map<uint256, std::set<std::pair<std::string, std::string>>> mapHashToAddressMarkedFrozen;
+    std::map<std::string, std::set<uint256>> mapAssetMarkedGlobalFrozen;
+    std::map<uint256, std::set<std::string>> mapHashMarkedGlobalFrozen;
+    std::map<std::string, std::set<uint256>> mapAddressesQualifiersChanged;
+    std::map<uint256, std::set<std::string>> mapHashQualifiersChanged;
+    std::map<std::string, std::set<uint256>> mapAssetVerifierChanged;
+    std::map<uint256, std::set<std::string>> mapHashVerifierChanged;
+};
+
+// Admit every transfer, look up what a block freezing each asset and adding
+// qualifiers to some addresses would have to recheck, then remove them all.
+static void RestrictedTransfersStdMap(benchmark::State& state)
+{
+    std::vector<RestrictedTransfer> vTransfers = MakeTransfers();
+
+    while (state.KeepRunning()) {
+        StdMapIndexes pool;
+        for (const auto& t : vTransfers) {
+            pool.mapAddressesQualifiersChanged[t.strTo].insert(t.hash);
+            pool.mapHashQualifiersChanged[t.hash].insert(t.strTo);
+            pool.mapAssetVerifierChanged[t.strAsset].insert(t.hash);
+            pool.mapHashVerifierChanged[t.hash].insert(t.strAsset);
+            pool.mapAssetMarkedGlobalFrozen[t.strAsset].insert(t.hash);
+            pool.mapHashMarkedGlobalFrozen[t.hash].insert(t.strAsset);
+            auto pair = std::make_pair(t.strFrom, t.strAsset);
+            pool.mapAddressesMarkedFrozen[pair].insert(t.hash);
+            pool.mapHashToAddressMarkedFrozen[t.hash].insert(pair);
+        }
+
+        size_t nFound = 0;
+        for (const auto& t : vTransfers) {
+            if (pool.mapAssetMarkedGlobalFrozen.count(t.strAsset))
+                nFound += pool.mapAssetMarkedGlobalFrozen.at(t.strAsset).size();
+            auto pair = std::make_pair(t.strFrom, t.strAsset);
+            if (pool.mapAddressesMarkedFrozen.count(pair))
+                nFound += pool.mapAddressesMarkedFrozen.at(pair).size();
+            if (pool.mapAddressesQualifiersChanged.count(t.strTo))
+                nFound += pool.mapAddressesQualifiersChanged.at(t.strTo).size();
+        }
+        assert(nFound > 0);
+
+        for (const auto& t : vTransfers) {
+            const uint256& hash = t.hash;
+            if (pool.mapHashToAddressMarkedFrozen.count(hash)) {
+                for (auto item : pool.mapHashToAddressMarkedFrozen.at(hash))
+                    pool.mapAddressesMarkedFrozen.at(item).erase(hash);
+                pool.mapHashToAddressMarkedFrozen.erase(hash);
+            }
+            if (pool.mapHashMarkedGlobalFrozen.count(hash)) {
+                for (auto item : pool.mapHashMarkedGlobalFrozen.at(hash))
+                    pool.mapAssetMarkedGlobalFrozen.at(item).erase(hash);
+                pool.mapHashMarkedGlobalFrozen.erase(hash);
+            }
+            if (pool.mapHashQualifiersChanged.count(hash)) {
+                for (auto item : pool.mapHashQualifiersChanged.at(hash))
+                    pool.mapAddressesQualifiersChanged.at(item).erase(hash);
+                pool.mapHashQualifiersChanged.erase(hash);
+            }
+            if (pool.mapHashVerifierChanged.count(hash)) {
+                for (auto item : pool.mapHashVerifierChanged.at(hash))
+                    pool.mapAssetVerifierChanged.at(item).erase(hash);
+                pool.mapHashVerifierChanged.erase(hash);
+            }
+        }
+    }
+}
+
+static void RestrictedTransfersMempool(benchmark::State& state)
+{
+    std::vector<RestrictedTransfer> vTransfers = MakeTransfers();
+
+    while (state.KeepRunning()) {
+        CTxMemPool pool;
+        for (const auto& t : vTransfers) {
+            pool.mapAddressesQualifiersChanged.Insert(t.strTo, t.hash);
+            pool.mapAssetVerifierChanged.Insert(t.strAsset, t.hash);
+            pool.mapAssetMarkedGlobalFrozen.Insert(t.strAsset, t.hash);
+            pool.mapAddressesMarkedFrozen.Insert(t.strFrom, t.strAsset, t.hash);
+        }
+
+        size_t nFound = 0;
+        for (const auto& t : vTransfers) {
+            if (const CMempoolRestrictedIndex::TxList* pTxs = pool.mapAssetMarkedGlobalFrozen.Find(t.strAsset))
+                nFound += pTxs->size();
+            if (const CMempoolRestrictedIndex::TxList* pTxs = pool.mapAddressesMarkedFrozen.Find(t.strFrom, t.strAsset))
+                nFound += pTxs->size();
+            if (const CMempoolRestrictedIndex::TxList* pTxs = pool.mapAddressesQualifiersChanged.Find(t.strTo))
+                nFound += pTxs->size();
+        }
+        assert(nFound > 0);
+
+        for (const auto& t : vTransfers) {
+            pool.mapAddressesMarkedFrozen.RemoveTx(t.hash);
+            pool.mapAssetMarkedGlobalFrozen.RemoveTx(t.hash);
+            pool.mapAddressesQualifiersChanged.RemoveTx(t.hash);
+            pool.mapAssetVerifierChanged.RemoveTx(t.hash);
+        }
+    }
+}
+
+BENCHMARK(RestrictedTransfersStdMap);
+BENCHMARK(RestrictedTransfersMempool);
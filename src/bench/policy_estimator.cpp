@@ -0,0 +1,56 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "policy/fees.h"
+#include "txmempool.h"
+
+#include <vector>
+
+// Feed one block of nBlockTxs tracked transactions through the estimator:
+// each enters the mempool at the previous height and confirms in the next block.
+static void ProcessBlocks(benchmark::State& state, int nBlockTxs)
+{
+    CBlockPolicyEstimator feeEst;
+    CTxMemPool pool(&feeEst);
+    unsigned int nHeight = 1;
+    uint32_t nCount = 0;
+
+    while (state.KeepRunning()) {
+        std::vector<CTransactionRef> block;
+        {
+            LOCK(pool.cs);
+            for (int i = 0; i < nBlockTxs; ++i) {
+                CMutableTransaction tx;
+                tx.vin.resize(1);
+                tx.vin[0].scriptSig = CScript() << ++nCount;
+                tx.vout.resize(1);
+                tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+                tx.vout[0].nValue = 10 * COIN;
+                CTransactionRef ptx = MakeTransactionRef(tx);
+
+                LockPoints lp;
+                pool.addUnchecked(ptx->GetHash(), CTxMemPoolEntry(ptx, 1000 + (nCount * 7919) % 50000,
+                                                                  0, nHeight, false, 4, lp));
+                block.push_back(ptx);
+            }
+        }
+        pool.removeForBlock(block, ++nHeight);
+    }
+}
+
+// Blocks with no tracked transactions: the cost is the per-block decay of every horizon.
+static void PolicyEstimatorEmptyBlock(benchmark::State& state)
+{
+    ProcessBlocks(state, 0);
+}
+
+// Blocks confirming a handful of transactions, which only touch their own buckets.
+static void PolicyEstimatorSmallBlock(benchmark::State& state)
+{
+    ProcessBlocks(state, 10);
+}
+
+BENCHMARK(PolicyEstimatorEmptyBlock);
+BENCHMARK(PolicyEstimatorSmallBlock);
@@ -0,0 +1,97 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "chainparams.h"
+#include "clientversion.h"
+#include "fs.h"
+#include "random.h"
+#include "streams.h"
+#include "txdb.h"
+#include "util.h"
+#include "validation.h"
+
+namespace block_bench {
+#include "bench/data/block566553.raw.h"
+} // namespace block_bench
+
+// Lay the bench block out in blk00000.dat of a temporary data directory, the
+// way the node stores it, and return the txindex position of each transaction.
+static std::vector<CDiskTxPos> WriteBenchBlockFile(fs::path& pathDataDir)
+{
+    pathDataDir = fs::temp_directory_path() / strprintf("bench_raven_%lu", (unsigned long)GetRand(1ULL << 32));
+    fs::create_directories(pathDataDir / "blocks");
+    gArgs.ForceSetArg("-datadir", pathDataDir.string());
+    ClearDatadirCache();
+
+    CDataStream stream((const char*)block_bench::block566553,
+            (const char*)&block_bench::block566553[sizeof(block_bench::block566553)],
+            SER_NETWORK, PROTOCOL_VERSION);
+    CBlock block;
+    stream >> block;
+
+    CDiskBlockPos pos(0, 0);
+    CAutoFile fileout(OpenBlockFile(pos), SER_DISK, CLIENT_VERSION);
+    assert(!fileout.IsNull());
+    unsigned int nSize = GetSerializeSize(fileout, block);
+    fileout << FLATDATA(GetParams().MessageStart()) << nSize;
+    pos.nPos = ftell(fileout.Get());
+    fileout << block;
+
+    std::vector<CDiskTxPos> vPos;
+    CDiskTxPos postx(pos, GetSizeOfCompactSize(block.vtx.size()));
+    for (const auto& tx : block.vtx) {
+        vPos.push_back(postx);
+        postx.nTxOffset += ::GetSerializeSize(*tx, SER_DISK, CLIENT_VERSION);
+    }
+    return vPos;
+}
+
+static void RemoveBenchBlockFile(const fs::path& pathDataDir)
+{
+    fs::remove_all(pathDataDir);
+    gArgs.ForceSetArg("-datadir", "");
+    ClearDatadirCache();
+}
+
+// How GetTransaction read a transaction before: open, read the header, seek, read the transaction
+static void ReadTransactionThroughFile(benchmark::State& state)
+{
+    fs::path pathDataDir;
+    std::vector<CDiskTxPos> vPos = WriteBenchBlockFile(pathDataDir);
+    size_t n = 0;
+
+    while (state.KeepRunning()) {
+        const CDiskTxPos& postx = vPos[n++ % vPos.size()];
+        CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
+        CBlockHeader header;
+        CTransactionRef tx;
+        file >> header;
+        fseek(file.Get(), postx.nTxOffset, SEEK_CUR);
+        file >> tx;
+        assert(!header.GetHash().IsNull());
+    }
+
+    RemoveBenchBlockFile(pathDataDir);
+}
+
+static void ReadTransactionFromBlockFile(benchmark::State& state)
+{
+    fs::path pathDataDir;
+    std::vector<CDiskTxPos> vPos = WriteBenchBlockFile(pathDataDir);
+    size_t n = 0;
+
+    while (state.KeepRunning()) {
+        CTransactionRef tx;
+        uint256 hashBlock;
+        bool fRead = ReadTransactionFromDisk(vPos[n++ % vPos.size()], tx, hashBlock);
+        assert(fRead);
+    }
+
+    RemoveBenchBlockFile(pathDataDir);
+}
+
+BENCHMARK(ReadTransactionThroughFile);
+BENCHMARK(ReadTransactionFromBlockFile);
@@ -0,0 +1,78 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "key.h"
+#include "keystore.h"
+#include "primitives/transaction.h"
+#include "random.h"
+#include "script/sign.h"
+#include "script/standard.h"
+
+#include <thread>
+
+static const unsigned int NUM_INPUTS = 1000;
+
+// A consolidation: many P2PKH inputs of a handful of wallet keys into one output
+static void BuildConsolidation(CBasicKeyStore& keystore, CMutableTransaction& mtx, std::vector<CTxOut>& vSpent)
+{
+    FastRandomContext rng(true);
+    std::vector<CKey> keys(10);
+    for (CKey& key : keys) {
+        key.MakeNewKey(true);
+        keystore.AddKey(key);
+    }
+    for (unsigned int i = 0; i < NUM_INPUTS; i++) {
+        mtx.vin.emplace_back(COutPoint(rng.rand256(), i % 4));
+        vSpent.emplace_back(100000, GetScriptForDestination(keys[i % keys.size()].GetPubKey().GetID()));
+    }
+    mtx.vout.emplace_back(NUM_INPUTS * 100000 - 100000, vSpent[0].scriptPubKey);
+}
+
+// How signrawtransaction signed before: a transaction copy per input, one input at a time
+static void SignTransactionPerInputCopy(benchmark::State& state)
+{
+    CBasicKeyStore keystore;
+    CMutableTransaction mtx;
+    std::vector<CTxOut> vSpent;
+    BuildConsolidation(keystore, mtx, vSpent);
+
+    while (state.KeepRunning()) {
+        CMutableTransaction mtxSign(mtx);
+        for (unsigned int i = 0; i < mtxSign.vin.size(); i++) {
+            SignatureData sigdata;
+            ProduceSignature(MutableTransactionSignatureCreator(&keystore, &mtxSign, i, vSpent[i].nValue, SIGHASH_ALL), vSpent[i].scriptPubKey, sigdata);
+            UpdateTransaction(mtxSign, i, sigdata);
+        }
+    }
+}
+
+static void SignTransaction(benchmark::State& state, int nThreads)
+{
+    CBasicKeyStore keystore;
+    CMutableTransaction mtx;
+    std::vector<CTxOut> vSpent;
+    BuildConsolidation(keystore, mtx, vSpent);
+    const CTransaction tx(mtx);
+
+    while (state.KeepRunning()) {
+        std::vector<SignatureData> vSigData;
+        bool fComplete = ProduceSignatures(keystore, tx, vSpent, SIGHASH_ALL, vSigData, nThreads);
+        assert(fComplete);
+    }
+}
+
+static void SignTransactionOneThread(benchmark::State& state)
+{
+    SignTransaction(state, 1);
+}
+
+static void SignTransactionAllThreads(benchmark::State& state)
+{
+    SignTransaction(state, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+BENCHMARK(SignTransactionPerInputCopy);
+BENCHMARK(SignTransactionOneThread);
+BENCHMARK(SignTransactionAllThreads);
@@ -225,6 +225,10 @@ public:
     //! (memory only) Maximum nTime in the chain up to and including this block.
     unsigned int nTimeMax;
 
+    //! (memory only) Median nTime of the last nMedianTimeSpan blocks up to and including this block.
+    //! Set once the entry is linked to its predecessor; zero until then.
+    unsigned int nMedianTimePast;
+
     void SetNull()
     {
         phashBlock = nullptr;
@@ -240,6 +244,7 @@ public:
         nStatus = 0;
         nSequenceId = 0;
         nTimeMax = 0;
+        nMedianTimePast = 0;
 
         nVersion       = 0;
         hashMerkleRoot = uint256();
@@ -326,6 +331,14 @@ public:
     enum { nMedianTimeSpan=11 };
 
     int64_t GetMedianTimePast() const
+    {
+        if (nMedianTimePast)
+            return nMedianTimePast;
+        return ComputeMedianTimePast();
+    }
+
+    //! Median time past from the block times themselves, walking back through pprev
+    int64_t ComputeMedianTimePast() const
     {
         int64_t pmedian[nMedianTimeSpan];
         int64_t* pbegin = &pmedian[nMedianTimeSpan];
@@ -339,6 +352,12 @@ public:
         return pbegin[(pend - pbegin)/2];
     }
 
+    //! Cache the median time past. Call once pprev is set; the times of this block and its ancestors must not change after.
+    void SetMedianTimePast()
+    {
+        nMedianTimePast = ComputeMedianTimePast();
+    }
+
     std::string ToString() const
     {
         return strprintf("CBlockIndex(pprev=%p, nHeight=%d, merkle=%s, hashBlock=%s)",
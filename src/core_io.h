@@ -8,6 +8,7 @@
 
 #include "amount.h"
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -18,6 +19,16 @@ struct CMutableTransaction;
 class uint256;
 class UniValue;
 
+/** The encodings of scriptSigs and scriptPubKeys TxToUniv writes */
+enum ScriptFields : unsigned int {
+    SCRIPT_FIELD_ASM = (1U << 0),
+    SCRIPT_FIELD_HEX = (1U << 1),
+    SCRIPT_FIELDS_ALL = SCRIPT_FIELD_ASM | SCRIPT_FIELD_HEX,
+};
+
+/** scriptPubKey objects TxToUniv has built, kept across the transactions of a block */
+typedef std::map<CScript, UniValue> ScriptPubKeyUnivCache;
+
 // core_read.cpp
 CScript ParseScript(const std::string& s);
 std::string ScriptToAsmStr(const CScript& script, const bool fAttemptSighashDecode = false);
@@ -34,6 +45,6 @@ UniValue ValueFromAmount(const CAmount& amount);
 std::string FormatScript(const CScript& script);
 std::string EncodeHexTx(const CTransaction& tx, const int serializeFlags = 0);
 void ScriptPubKeyToUniv(const CScript& scriptPubKey, UniValue& out, bool fIncludeHex);
-void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry, bool include_hex = true, int serialize_flags = 0);
+void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry, bool include_hex = true, int serialize_flags = 0, unsigned int script_fields = SCRIPT_FIELDS_ALL, ScriptPubKeyUnivCache* pcache = nullptr);
 
 #endif // RAVEN_CORE_IO_H
@@ -155,14 +155,14 @@ std::string EncodeHexTx(const CTransaction& tx, const int serializeFlags)
     return HexStr(ssTx.begin(), ssTx.end());
 }
 
-void ScriptPubKeyToUniv(const CScript& scriptPubKey,
-                        UniValue& out, bool fIncludeHex)
+static void ScriptPubKeyToUniv(const CScript& scriptPubKey, UniValue& out, bool fIncludeAsm, bool fIncludeHex)
 {
     txnouttype type;
     std::vector<CTxDestination> addresses;
     int nRequired;
 
-    out.pushKV("asm", ScriptToAsmStr(scriptPubKey));
+    if (fIncludeAsm)
+        out.pushKV("asm", ScriptToAsmStr(scriptPubKey));
     if (fIncludeHex)
         out.pushKV("hex", HexStr(scriptPubKey.begin(), scriptPubKey.end()));
 
@@ -271,8 +271,17 @@ void ScriptPubKeyToUniv(const CScript& scriptPubKey,
     out.pushKV("addresses", a);
 }
 
-void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry, bool include_hex, int serialize_flags)
+void ScriptPubKeyToUniv(const CScript& scriptPubKey,
+                        UniValue& out, bool fIncludeHex)
+{
+    ScriptPubKeyToUniv(scriptPubKey, out, true, fIncludeHex);
+}
+
+void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry, bool include_hex, int serialize_flags, unsigned int script_fields, ScriptPubKeyUnivCache* pcache)
 {
+    const bool fScriptAsm = script_fields & SCRIPT_FIELD_ASM;
+    const bool fScriptHex = script_fields & SCRIPT_FIELD_HEX;
+
     entry.pushKV("txid", tx.GetHash().GetHex());
     entry.pushKV("hash", tx.GetWitnessHash().GetHex());
     entry.pushKV("version", tx.nVersion);
@@ -283,28 +292,33 @@ void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry,
     UniValue vin(UniValue::VARR);
     for (unsigned int i = 0; i < tx.vin.size(); i++) {
         const CTxIn& txin = tx.vin[i];
+        // The objects built here are new, so their keys need no duplicate check
         UniValue in(UniValue::VOBJ);
         if (tx.IsCoinBase())
-            in.pushKV("coinbase", HexStr(txin.scriptSig.begin(), txin.scriptSig.end()));
+            in.__pushKV("coinbase", HexStr(txin.scriptSig.begin(), txin.scriptSig.end()));
         else {
-            in.pushKV("txid", txin.prevout.hash.GetHex());
-            in.pushKV("vout", (int64_t)txin.prevout.n);
-            UniValue o(UniValue::VOBJ);
-            o.pushKV("asm", ScriptToAsmStr(txin.scriptSig, true));
-            o.pushKV("hex", HexStr(txin.scriptSig.begin(), txin.scriptSig.end()));
-            in.pushKV("scriptSig", o);
+            in.__pushKV("txid", txin.prevout.hash.GetHex());
+            in.__pushKV("vout", (int64_t)txin.prevout.n);
+            if (fScriptAsm || fScriptHex) {
+                UniValue o(UniValue::VOBJ);
+                if (fScriptAsm)
+                    o.__pushKV("asm", ScriptToAsmStr(txin.scriptSig, true));
+                if (fScriptHex)
+                    o.__pushKV("hex", HexStr(txin.scriptSig.begin(), txin.scriptSig.end()));
+                in.__pushKV("scriptSig", std::move(o));
+            }
             if (!tx.vin[i].scriptWitness.IsNull()) {
                 UniValue txinwitness(UniValue::VARR);
                 for (const auto& item : tx.vin[i].scriptWitness.stack) {
                     txinwitness.push_back(HexStr(item.begin(), item.end()));
                 }
-                in.pushKV("txinwitness", txinwitness);
+                in.__pushKV("txinwitness", std::move(txinwitness));
             }
         }
-        in.pushKV("sequence", (int64_t)txin.nSequence);
-        vin.push_back(in);
+        in.__pushKV("sequence", (int64_t)txin.nSequence);
+        vin.push_back(std::move(in));
     }
-    entry.pushKV("vin", vin);
+    entry.pushKV("vin", std::move(vin));
 
     UniValue vout(UniValue::VARR);
     for (unsigned int i = 0; i < tx.vout.size(); i++) {
@@ -312,15 +326,26 @@ void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry,
 
         UniValue out(UniValue::VOBJ);
 
-        out.pushKV("value", ValueFromAmount(txout.nValue));
-        out.pushKV("n", (int64_t)i);
+        out.__pushKV("value", ValueFromAmount(txout.nValue));
+        out.__pushKV("n", (int64_t)i);
 
-        UniValue o(UniValue::VOBJ);
-        ScriptPubKeyToUniv(txout.scriptPubKey, o, true);
-        out.pushKV("scriptPubKey", o);
-        vout.push_back(out);
+        // The object depends on nothing but the script, so outputs paying a script seen before reuse it
+        if (pcache) {
+            auto it = pcache->find(txout.scriptPubKey);
+            if (it == pcache->end()) {
+                UniValue o(UniValue::VOBJ);
+                ScriptPubKeyToUniv(txout.scriptPubKey, o, fScriptAsm, fScriptHex);
+                it = pcache->emplace(txout.scriptPubKey, std::move(o)).first;
+            }
+            out.__pushKV("scriptPubKey", it->second);
+        } else {
+            UniValue o(UniValue::VOBJ);
+            ScriptPubKeyToUniv(txout.scriptPubKey, o, fScriptAsm, fScriptHex);
+            out.__pushKV("scriptPubKey", std::move(o));
+        }
+        vout.push_back(std::move(out));
     }
-    entry.pushKV("vout", vout);
+    entry.pushKV("vout", std::move(vout));
 
     if (!hashBlock.IsNull())
         entry.pushKV("blockhash", hashBlock.GetHex());
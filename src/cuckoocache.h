@@ -475,6 +475,19 @@ public:
             }
         return false;
     }
+
+    /** get_kept appends every element which is not marked as discardable to
+     * out, so that the contents of the cache can be saved and re-inserted
+     * into a fresh cache later. Not threadsafe with any concurrent insert.
+     *
+     * @param out the vector to append the retained elements to
+     */
+    void get_kept(std::vector<Element>& out) const
+    {
+        for (uint32_t i = 0; i < size; ++i)
+            if (!collection_flags.bit_is_set(i))
+                out.push_back(table[i]);
+    }
 };
 } // namespace CuckooCache
 
@@ -98,6 +98,27 @@ static CZMQNotificationInterface* pzmqNotificationInterface = nullptr;
 #endif
 
 static const char* FEE_ESTIMATES_FILENAME="fee_estimates.dat";
+/** Seconds between periodic fee estimate snapshots, so a crash loses at most this much history */
+static const int64_t FEE_ESTIMATES_DUMP_INTERVAL = 15 * 60;
+
+/** Write the fee estimator to a temporary file and move it over FEE_ESTIMATES_FILENAME */
+static bool DumpFeeEstimates()
+{
+    fs::path est_path = GetDataDir() / FEE_ESTIMATES_FILENAME;
+    fs::path est_path_new = GetDataDir() / (std::string(FEE_ESTIMATES_FILENAME) + ".new");
+    CAutoFile est_fileout(fsbridge::fopen(est_path_new, "wb"), SER_DISK, CLIENT_VERSION);
+    if (est_fileout.IsNull() || !::feeEstimator.Write(est_fileout)) {
+        LogPrintf("%s: Failed to write fee estimates to %s\n", __func__, est_path.string());
+        return false;
+    }
+    FileCommit(est_fileout.Get());
+    est_fileout.fclose();
+    if (!RenameOver(est_path_new, est_path)) {
+        LogPrintf("%s: Failed to rename fee estimates to %s\n", __func__, est_path.string());
+        return false;
+    }
+    return true;
+}
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -127,6 +148,7 @@ static const char* FEE_ESTIMATES_FILENAME="fee_estimates.dat";
 std::atomic<bool> fRequestShutdown(false);
 std::atomic<bool> fRequestRestart(false);
 std::atomic<bool> fDumpMempoolLater(false);
+std::atomic<bool> fDumpValidationCachesLater(false);
 
 void StartShutdown()
 {
@@ -212,6 +234,8 @@ void PrepareShutdown()
     // using the other before destroying them.
     UnregisterValidationInterface(peerLogic.get());
     if(g_connman) g_connman->Stop();
+    // Queued wallet resends refer to the connection manager, deliver them while it is still there
+    GetMainSignals().FlushBackgroundCallbacks();
     peerLogic.reset();
     g_connman.reset();
 
@@ -219,15 +243,14 @@ void PrepareShutdown()
         DumpMempool();
     }
 
+    if (fDumpValidationCachesLater) {
+        DumpValidationCaches();
+    }
+
     if (fFeeEstimatesInitialized)
     {
         ::feeEstimator.FlushUnconfirmed(::mempool);
-        fs::path est_path = GetDataDir() / FEE_ESTIMATES_FILENAME;
-        CAutoFile est_fileout(fsbridge::fopen(est_path, "wb"), SER_DISK, CLIENT_VERSION);
-        if (!est_fileout.IsNull())
-            ::feeEstimator.Write(est_fileout);
-        else
-            LogPrintf("%s: Failed to write fee estimates to %s\n", __func__, est_path.string());
+        DumpFeeEstimates();
         fFeeEstimatesInitialized = false;
     }
 
@@ -273,6 +296,9 @@ void PrepareShutdown()
         delete passetsCache;
         passetsCache = nullptr;
 
+        delete passetsDataPayloadCache;
+        passetsDataPayloadCache = nullptr;
+
         delete pMessagesCache;
         pMessagesCache = nullptr;
 
@@ -455,12 +481,14 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-minreorgpeers=<n>", strprintf(_("Set the Minimum amount of peers required to disallow reorg of chains of depth >= maxreorg. Peers must be greater than. (default: %u)"), defaultChainParams->MinReorganizationPeers()));
     strUsage += HelpMessageOpt("-minreorgage=<n>", strprintf(_("Set the Minimum tip age (in seconds) required to allow reorg of a chain of depth >= maxreorg on a node with more than minreorgpeers peers. (default: %u)"), defaultChainParams->MinReorganizationAge()));
     strUsage += HelpMessageOpt("-maxorphantx=<n>", strprintf(_("Keep at most <n> unconnectable transactions in memory (default: %u)"), DEFAULT_MAX_ORPHAN_TRANSACTIONS));
+    strUsage += HelpMessageOpt("-maxorphanpool=<n>", strprintf(_("Keep unconnectable transactions below <n> megabytes of memory (default: %u)"), DEFAULT_MAX_ORPHAN_POOL_SIZE));
     strUsage += HelpMessageOpt("-maxmempool=<n>", strprintf(_("Keep the transaction memory pool below <n> megabytes (default: %u)"), DEFAULT_MAX_MEMPOOL_SIZE));
     strUsage += HelpMessageOpt("-mempoolexpiry=<n>", strprintf(_("Do not keep transactions in the mempool longer than <n> hours (default: %u)"), DEFAULT_MEMPOOL_EXPIRY));
     if (showDebug) {
         strUsage += HelpMessageOpt("-minimumchainwork=<hex>", strprintf("Minimum work assumed to exist on a valid chain in hex (default: %s, testnet: %s)", defaultChainParams->GetConsensus().nMinimumChainWork.GetHex(), testnetChainParams->GetConsensus().nMinimumChainWork.GetHex()));
     }
     strUsage += HelpMessageOpt("-persistmempool", strprintf(_("Whether to save the mempool on shutdown and load on restart (default: %u)"), DEFAULT_PERSIST_MEMPOOL));
+    strUsage += HelpMessageOpt("-persistsigcache", strprintf(_("Whether to save the signature and script execution caches on shutdown and load them on restart (default: %u)"), DEFAULT_PERSIST_SIGCACHE));
     strUsage += HelpMessageOpt("-blockreconstructionextratxn=<n>", strprintf(_("Extra transactions to keep in memory for compact block reconstructions (default: %u)"), DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
@@ -478,6 +506,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-sysperms", _("Create new files with system default permissions, instead of umask 077 (only effective with disabled wallet functionality)"));
 #endif
     strUsage += HelpMessageOpt("-txindex", strprintf(_("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)"), DEFAULT_TXINDEX));
+    strUsage += HelpMessageOpt("-txindexcache=<n>", strprintf(_("Keep the last <n> transactions looked up through the transaction index in memory (default: %u)"), DEFAULT_TXINDEX_CACHE));
     strUsage += HelpMessageOpt("-assetindex", _("Keep an index of assets, used by the requestsnapshot rpc call. Requires a -reindex."));
 
     strUsage += HelpMessageOpt("-addressindex", strprintf(_("Maintain a full address index, used to query for the balance, txids and unspent outputs for addresses (default: %u)"), DEFAULT_ADDRESSINDEX));
@@ -1218,6 +1247,7 @@ bool AppInitParameterInteraction()
         return InitError("unknown rpcserialversion requested.");
 
     nMaxTipAge = gArgs.GetArg("-maxtipage", DEFAULT_MAX_TIP_AGE);
+    nTxIndexCacheSize = std::max<int64_t>(0, gArgs.GetArg("-txindexcache", DEFAULT_TXINDEX_CACHE));
 
     fEnableReplacement = gArgs.GetBoolArg("-mempoolreplacement", DEFAULT_ENABLE_REPLACEMENT);
     if ((!fEnableReplacement) && gArgs.IsArgSet("-mempoolreplacement")) {
@@ -1345,6 +1375,10 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
 
     InitSignatureCache();
     InitScriptExecutionCache();
+    if (gArgs.GetBoolArg("-persistsigcache", DEFAULT_PERSIST_SIGCACHE)) {
+        LoadValidationCaches();
+        fDumpValidationCachesLater = true;
+    }
 
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
@@ -1485,7 +1519,10 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     pzmqNotificationInterface = CZMQNotificationInterface::Create();
 
     if (pzmqNotificationInterface) {
-        RegisterValidationInterface(pzmqNotificationInterface);
+        // Publishing reads blocks back from disk; keep that off the validation thread
+        RegisterValidationInterfaceQueued(pzmqNotificationInterface, "zmqnotify",
+                NOTIFY_UPDATED_BLOCK_TIP | NOTIFY_TRANSACTION_ADDED_TO_MEMPOOL | NOTIFY_BLOCK_CONNECTED |
+                NOTIFY_BLOCK_DISCONNECTED | NOTIFY_NEW_ASSET_MESSAGE);
     }
 #endif
     uint64_t nMaxOutboundLimit = 0; //unlimited unless -maxuploadtarget is set
@@ -1546,6 +1583,7 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     delete passets;
                     delete passetsdb;
                     delete passetsCache;
+                    delete passetsDataPayloadCache;
 
                     // Messaging assets
                     delete pmessagedb;
@@ -1573,6 +1611,7 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     passetsdb = new CAssetsDB(nBlockTreeDBCache, false, fReset);
                     passets = new CAssetsCache();
                     passetsCache = new CLRUCache<std::string, CDatabasedAssetData>(MAX_CACHE_ASSETS_SIZE);
+                    passetsDataPayloadCache = new CLRUCache<std::string, std::shared_ptr<const std::vector<unsigned char>>>(MAX_CACHE_ASSETS_SIZE);
 
                     // Messaging assets
                     pMessagesCache = new CLRUCache<std::string, CMessage>(1000);
@@ -1605,6 +1644,11 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                         break;
                     }
 
+                    if (!passetsdb->CountAddressHoldings()) {
+                        strLoadError = _("Failed to count asset holdings per address");
+                        break;
+                    }
+
                     if (!passetsdb->ReadReissuedMempoolState())
                         LogPrintf(
                                 "Database failed to load last Reissued Mempool State. Will have to start from empty state");
@@ -1801,6 +1845,8 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     if (!est_filein.IsNull())
         ::feeEstimator.Read(est_filein);
     fFeeEstimatesInitialized = true;
+    // Snapshot periodically from the scheduler thread so an unclean exit keeps recent history
+    scheduler.scheduleEvery([]{ DumpFeeEstimates(); }, FEE_ESTIMATES_DUMP_INTERVAL * 1000);
 
     // ********************************************************* Step 8: load wallet
 #ifdef ENABLE_WALLET
@@ -1960,6 +2006,13 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     }
 #endif
 
+    // Message databases written before the secondary indexes existed need them built once
+    if (fLoaded && fMessaging && pmessagedb) {
+        LOCK(cs_messaging);
+        if (!pmessagedb->BuildMessageIndexes())
+            LogPrintf("%s : Failed to build the message indexes\n", __func__);
+    }
+
     // ********************************************************* Step 13: finished
     uiInterface.InitMessage(_("Done Loading"));
 
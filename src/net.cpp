@@ -46,6 +46,9 @@
 // Dump addresses to peers.dat and banlist.dat every 15 minutes (900s)
 #define DUMP_ADDRESSES_INTERVAL 900
 
+// Rewrite peers.dat in full on every 8th dump (2 hours), only logging changed addresses in between
+#define DUMP_ADDRESSES_FULL_EVERY 8
+
 // We add a random period time (0 to 1 seconds) to feeler connections to prevent synchronization.
 #define FEELER_SLEEP_WINDOW 1
 
@@ -1672,20 +1675,26 @@ void CConnman::ThreadDNSAddressSeed()
 
 
 
-void CConnman::DumpAddresses()
+void CConnman::DumpAddresses(bool fFull)
 {
     int64_t nStart = GetTimeMillis();
 
     CAddrDB adb;
-    adb.Write(addrman);
-
-    LogPrint(BCLog::NET, "Flushed %d addresses to peers.dat  %dms\n",
-           addrman.size(), GetTimeMillis() - nStart);
+    if (fFull) {
+        adb.Write(addrman);
+        LogPrint(BCLog::NET, "Flushed %d addresses to peers.dat  %dms\n",
+               addrman.size(), GetTimeMillis() - nStart);
+    } else {
+        adb.Append(addrman);
+        LogPrint(BCLog::NET, "Logged changed addresses to peers.log  %dms\n",
+               GetTimeMillis() - nStart);
+    }
 }
 
 void CConnman::DumpData()
 {
-    DumpAddresses();
+    // The first dump is a full one, which also drops any torn batch a previous run left in peers.log
+    DumpAddresses(nAddressDumps++ % DUMP_ADDRESSES_FULL_EVERY == 0);
     DumpBanlist();
 }
 
@@ -2251,6 +2260,7 @@ CConnman::CConnman(uint64_t nSeed0In, uint64_t nSeed1In) : nSeed0(nSeed0In), nSe
     fNetworkActive = true;
     setBannedIsDirty = false;
     fAddressesInitialized = false;
+    nAddressDumps = 0;
     nLastNodeId = 0;
     nSendBufferMaxSize = 0;
     nReceiveFloodSize = 0;
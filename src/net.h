@@ -353,7 +353,8 @@ private:
     void SetBannedSetDirty(bool dirty=true);
     //!clean unused entries (if bantime has expired)
     void SweepBanned();
-    void DumpAddresses();
+    //! Write peers.dat in full, or only append the changed addresses to peers.log
+    void DumpAddresses(bool fFull = true);
     void DumpData();
     void DumpBanlist();
 
@@ -399,6 +400,9 @@ private:
     mutable CCriticalSection cs_vNodes;
     std::atomic<NodeId> nLastNodeId;
 
+    //! number of DumpData calls, to space out full rewrites of peers.dat
+    std::atomic<int> nAddressDumps;
+
     /** Services this instance offers */
     ServiceFlags nLocalServices;
 
@@ -53,9 +53,19 @@ struct COrphanTx {
     CTransactionRef tx;
     NodeId fromPeer;
     int64_t nTimeExpire;
+    size_t nUsage;
+};
+typedef std::set<std::map<uint256, COrphanTx>::iterator, IteratorComparator> OrphanIterSet;
+/** The orphans a peer sent us and the memory they use, which eviction balances between peers */
+struct COrphanPeerUsage {
+    size_t nUsage = 0;
+    OrphanIterSet setOrphans;
 };
 std::map<uint256, COrphanTx> mapOrphanTransactions GUARDED_BY(cs_main);
-std::map<COutPoint, std::set<std::map<uint256, COrphanTx>::iterator, IteratorComparator>> mapOrphanTransactionsByPrev GUARDED_BY(cs_main);
+std::map<COutPoint, OrphanIterSet> mapOrphanTransactionsByPrev GUARDED_BY(cs_main);
+std::map<NodeId, COrphanPeerUsage> mapOrphanUsageByPeer GUARDED_BY(cs_main);
+size_t nOrphanTxUsage GUARDED_BY(cs_main) = 0;
+static COrphanStats orphanStats GUARDED_BY(cs_main) = {};
 void EraseOrphansFor(NodeId peer) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 static size_t vExtraTxnForCompactIt = 0;
@@ -114,6 +124,7 @@ namespace {
         const CBlockIndex* pindex;                               //!< Optional.
         bool fValidatedHeaders;                                  //!< Whether this block has validated headers at the time of request.
         std::unique_ptr<PartiallyDownloadedBlock> partialBlock;  //!< Optional, used for CMPCTBLOCK downloads
+        int64_t nTimeRequested;                                  //!< When the block was requested (in microseconds).
     };
     std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> > mapBlocksInFlight;
 
@@ -187,6 +198,12 @@ struct CNodeState {
     int64_t nDownloadingSince;
     int nBlocksInFlight;
     int nBlocksInFlightValidHeaders;
+    //! Moving average of the time between requested blocks delivered by this peer (in microseconds), or 0 if unmeasured.
+    int64_t nAvgBlockInterval;
+    //! Moving average of the time from requesting a block to receiving it from this peer (in microseconds), or 0 if unmeasured.
+    int64_t nAvgBlockLatency;
+    //! When we last received a requested block from this peer (in microseconds).
+    int64_t nLastBlockReceived;
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload;
     //! Whether this peer wants invs or headers (when possible) for block announcements.
@@ -254,6 +271,9 @@ struct CNodeState {
         nDownloadingSince = 0;
         nBlocksInFlight = 0;
         nBlocksInFlightValidHeaders = 0;
+        nAvgBlockInterval = 0;
+        nAvgBlockLatency = 0;
+        nLastBlockReceived = 0;
         fPreferredDownload = false;
         fPreferHeaders = false;
         fPreferHeaderAndIDs = false;
@@ -308,14 +328,39 @@ void PushNodeVersion(CNode *pnode, CConnman* connman, int64_t nTime)
     }
 }
 
+/** Fold a new sample into a per-peer moving average (weight 1/8), seeding it with the first sample. */
+void UpdateBlockDownloadAverage(int64_t& nAverage, int64_t nSample) {
+    nSample = std::max<int64_t>(nSample, 1);
+    nAverage = nAverage == 0 ? nSample : (nAverage * 7 + nSample) / 8;
+}
+
+// Requires cs_main.
+// Number of blocks we are willing to have in flight from this peer. Peers that deliver
+// quickly get a deeper queue so they don't idle while slow peers hold the window open,
+// and slow peers get a shallow one so they hold as few of the window's blocks as possible.
+int GetBlockDownloadQuota(const CNodeState* state) {
+    if (state->nAvgBlockInterval == 0)
+        return MAX_BLOCKS_IN_TRANSIT_PER_PEER;
+    int64_t nQuota = BLOCK_DOWNLOAD_TARGET_TIME * 1000000 / state->nAvgBlockInterval;
+    return (int)std::max<int64_t>(MIN_BLOCKS_IN_TRANSIT_PER_PEER, std::min<int64_t>(MAX_BLOCKS_IN_TRANSIT_PER_PEER_ADAPTIVE, nQuota));
+}
+
 // Requires cs_main.
 // Returns a bool indicating whether we requested this block.
-// Also used if a block was /not/ received and timed out or started with another peer
-bool MarkBlockAsReceived(const uint256& hash) {
+// Also used if a block was /not/ received and timed out or started with another peer.
+// When nodeFrom is the peer we requested the block from, its download rate is updated.
+bool MarkBlockAsReceived(const uint256& hash, NodeId nodeFrom = -1) {
     std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> >::iterator itInFlight = mapBlocksInFlight.find(hash);
     if (itInFlight != mapBlocksInFlight.end()) {
         CNodeState *state = State(itInFlight->second.first);
         assert(state != nullptr);
+        if (nodeFrom == itInFlight->second.first) {
+            int64_t nNow = GetTimeMicros();
+            int64_t nTimeRequested = itInFlight->second.second->nTimeRequested;
+            UpdateBlockDownloadAverage(state->nAvgBlockLatency, nNow - nTimeRequested);
+            UpdateBlockDownloadAverage(state->nAvgBlockInterval, nNow - std::max(state->nLastBlockReceived, nTimeRequested));
+            state->nLastBlockReceived = nNow;
+        }
         state->nBlocksInFlightValidHeaders -= itInFlight->second.second->fValidatedHeaders;
         if (state->nBlocksInFlightValidHeaders == 0 && itInFlight->second.second->fValidatedHeaders) {
             // Last validated block on the queue was received.
@@ -354,7 +399,7 @@ bool MarkBlockAsInFlight(NodeId nodeid, const uint256& hash, const CBlockIndex*
     MarkBlockAsReceived(hash);
 
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(state->vBlocksInFlight.end(),
-            {hash, pindex, pindex != nullptr, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&mempool) : nullptr)});
+            {hash, pindex, pindex != nullptr, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&mempool) : nullptr), GetTimeMicros()});
     state->nBlocksInFlight++;
     state->nBlocksInFlightValidHeaders += it->fValidatedHeaders;
     if (state->nBlocksInFlight == 1) {
@@ -461,6 +506,40 @@ bool PeerHasHeader(CNodeState *state, const CBlockIndex *pindex)
     return false;
 }
 
+// Requires cs_main.
+// Whether nodeid should take over the download of an in-flight block from the peer it is
+// currently requested from: nodeid must have a measured latency lower than the current
+// peer's, and the block must have been outstanding for well beyond what nodeid would need.
+bool ShouldRerequestBlock(NodeId nodeid, const uint256& hash) {
+    std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> >::iterator itInFlight = mapBlocksInFlight.find(hash);
+    if (itInFlight == mapBlocksInFlight.end() || itInFlight->second.first == nodeid)
+        return false;
+    const QueuedBlock& queued = *itInFlight->second.second;
+    if (queued.partialBlock)
+        return false;
+
+    const CNodeState* state = State(nodeid);
+    const CNodeState* stateOther = State(itInFlight->second.first);
+    assert(state != nullptr && stateOther != nullptr);
+    if (state->nAvgBlockLatency == 0)
+        return false;
+    if (stateOther->nAvgBlockLatency != 0 && stateOther->nAvgBlockLatency <= state->nAvgBlockLatency)
+        return false;
+
+    return GetTimeMicros() - queued.nTimeRequested > BLOCK_REREQUEST_LATENCY_FACTOR * state->nAvgBlockLatency;
+}
+
+// Requires cs_main.
+// Add the in-flight block pindexWaitingFor, requested from waitingfor, to vBlocks if nodeid should take it over.
+bool RerequestFromFasterPeer(NodeId nodeid, NodeId waitingfor, const CBlockIndex* pindexWaitingFor, std::vector<const CBlockIndex*>& vBlocks) {
+    if (pindexWaitingFor == nullptr || !ShouldRerequestBlock(nodeid, pindexWaitingFor->GetBlockHash()))
+        return false;
+    LogPrint(BCLog::NET, "Re-requesting block %s (%d) from faster peer=%d, was peer=%d\n",
+        pindexWaitingFor->GetBlockHash().ToString(), pindexWaitingFor->nHeight, nodeid, waitingfor);
+    vBlocks.push_back(pindexWaitingFor);
+    return true;
+}
+
 /** Update pindexLastCommonBlock and add not-in-flight missing successors to vBlocks, until it has
  *  at most count entries. */
 void FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller, const Consensus::Params& consensusParams) {
@@ -499,6 +578,7 @@ void FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<con
     int nWindowEnd = state->pindexLastCommonBlock->nHeight + BLOCK_DOWNLOAD_WINDOW;
     int nMaxHeight = std::min<int>(state->pindexBestKnownBlock->nHeight, nWindowEnd + 1);
     NodeId waitingfor = -1;
+    const CBlockIndex* pindexWaitingFor = nullptr;
     while (pindexWalk->nHeight < nMaxHeight) {
         // Read up to 128 (or more, if more blocks than that are needed) successors of pindexWalk (towards
         // pindexBestKnownBlock) into vToFetch. We fetch 128, because CBlockIndex::GetAncestor may be as expensive
@@ -533,6 +613,10 @@ void FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<con
                     // We reached the end of the window.
                     if (vBlocks.size() == 0 && waitingfor != nodeid) {
                         // We aren't able to fetch anything, but we would be if the download window was one larger.
+                        // If this peer is faster than the one holding the window back, take the block over
+                        // rather than waiting for the stall timeout.
+                        if (RerequestFromFasterPeer(nodeid, waitingfor, pindexWaitingFor, vBlocks))
+                            return;
                         nodeStaller = waitingfor;
                     }
                     return;
@@ -544,9 +628,15 @@ void FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<con
             } else if (waitingfor == -1) {
                 // This is the first already-in-flight block.
                 waitingfor = mapBlocksInFlight[pindex->GetBlockHash()].first;
+                pindexWaitingFor = pindex;
             }
         }
     }
+
+    // Everything this peer has is downloaded or in flight. Near the tip the window never fills up,
+    // so take over a block a slower peer is sitting on instead of idling until the download timeout.
+    if (vBlocks.size() == 0)
+        RerequestFromFasterPeer(nodeid, waitingfor, pindexWaitingFor, vBlocks);
 }
 
 } // namespace
@@ -613,6 +703,8 @@ bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats) {
     stats.nMisbehavior = state->nMisbehavior;
     stats.nSyncHeight = state->pindexBestKnownBlock ? state->pindexBestKnownBlock->nHeight : -1;
     stats.nCommonHeight = state->pindexLastCommonBlock ? state->pindexLastCommonBlock->nHeight : -1;
+    stats.nBlockQuota = GetBlockDownloadQuota(state);
+    stats.nAvgBlockLatency = state->nAvgBlockLatency;
     for (const QueuedBlock& queue : state->vBlocksInFlight) {
         if (queue.pindex)
             stats.vHeightInFlight.push_back(queue.pindex->nHeight);
@@ -656,17 +748,24 @@ bool AddOrphanTx(const CTransactionRef& tx, NodeId peer) EXCLUSIVE_LOCKS_REQUIRE
         return false;
     }
 
-    auto ret = mapOrphanTransactions.emplace(hash, COrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME});
+    // Account for the transaction and its entries in both indexes
+    size_t nUsage = RecursiveDynamicUsage(tx) + memusage::MallocUsage(sizeof(std::pair<const uint256, COrphanTx>)) * (1 + tx->vin.size());
+    auto ret = mapOrphanTransactions.emplace(hash, COrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME, nUsage});
     assert(ret.second);
     for (const CTxIn& txin : tx->vin)
     {
         mapOrphanTransactionsByPrev[txin.prevout].insert(ret.first);
     }
+    COrphanPeerUsage& peerUsage = mapOrphanUsageByPeer[peer];
+    peerUsage.setOrphans.insert(ret.first);
+    peerUsage.nUsage += nUsage;
+    nOrphanTxUsage += nUsage;
+    orphanStats.nAdded++;
 
     AddToCompactExtraTransactions(tx);
 
-    LogPrint(BCLog::MEMPOOL, "stored orphan tx %s (mapsz %u outsz %u)\n", hash.ToString(),
-             mapOrphanTransactions.size(), mapOrphanTransactionsByPrev.size());
+    LogPrint(BCLog::MEMPOOL, "stored orphan tx %s (mapsz %u outsz %u usage %u)\n", hash.ToString(),
+             mapOrphanTransactions.size(), mapOrphanTransactionsByPrev.size(), nOrphanTxUsage);
     return true;
 }
 
@@ -684,27 +783,51 @@ int static EraseOrphanTx(uint256 hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
         if (itPrev->second.empty())
             mapOrphanTransactionsByPrev.erase(itPrev);
     }
+    auto itPeer = mapOrphanUsageByPeer.find(it->second.fromPeer);
+    assert(itPeer != mapOrphanUsageByPeer.end());
+    itPeer->second.setOrphans.erase(it);
+    itPeer->second.nUsage -= it->second.nUsage;
+    if (itPeer->second.setOrphans.empty())
+        mapOrphanUsageByPeer.erase(itPeer);
+    nOrphanTxUsage -= it->second.nUsage;
     mapOrphanTransactions.erase(it);
     return 1;
 }
 
+/** Whether any transaction in the orphan pool spends an output of this orphan */
+static bool HasOrphanChildren(const CTransaction& tx) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    auto itByPrev = mapOrphanTransactionsByPrev.lower_bound(COutPoint(tx.GetHash(), 0));
+    return itByPrev != mapOrphanTransactionsByPrev.end() && itByPrev->first.hash == tx.GetHash();
+}
+
+/** Whether this transaction still waits on a parent in the orphan pool that has not been resolved */
+static bool HasPendingOrphanParents(const CTransaction& tx, const std::set<uint256>& setResolved) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    for (const CTxIn& txin : tx.vin) {
+        if (mapOrphanTransactions.count(txin.prevout.hash) && !setResolved.count(txin.prevout.hash))
+            return true;
+    }
+    return false;
+}
+
 void EraseOrphansFor(NodeId peer)
 {
     int nErased = 0;
-    std::map<uint256, COrphanTx>::iterator iter = mapOrphanTransactions.begin();
-    while (iter != mapOrphanTransactions.end())
-    {
-        std::map<uint256, COrphanTx>::iterator maybeErase = iter++; // increment to avoid iterator becoming invalid
-        if (maybeErase->second.fromPeer == peer)
-        {
-            nErased += EraseOrphanTx(maybeErase->second.tx->GetHash());
-        }
-    }
+    auto itPeer = mapOrphanUsageByPeer.find(peer);
+    if (itPeer == mapOrphanUsageByPeer.end())
+        return;
+    // Erasing the last orphan also erases the peer entry, so work from a copy
+    std::vector<uint256> vErase;
+    for (const auto& itOrphan : itPeer->second.setOrphans)
+        vErase.push_back(itOrphan->first);
+    for (const uint256& hash : vErase)
+        nErased += EraseOrphanTx(hash);
     if (nErased > 0) LogPrint(BCLog::MEMPOOL, "Erased %d orphan tx from peer=%d\n", nErased, peer);
 }
 
 
-unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans, size_t nMaxOrphanUsage) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
     unsigned int nEvicted = 0;
     static int64_t nNextSweep;
@@ -725,21 +848,41 @@ unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans) EXCLUSIVE_LOCKS_REQUIRE
         }
         // Sweep again 5 minutes after the next entry that expires in order to batch the linear scan.
         nNextSweep = nMinExpTime + ORPHAN_TX_EXPIRE_INTERVAL;
+        orphanStats.nExpired += nErased;
         if (nErased > 0) LogPrint(BCLog::MEMPOOL, "Erased %d orphan tx due to expiration\n", nErased);
     }
-    while (mapOrphanTransactions.size() > nMaxOrphans)
+    while (mapOrphanTransactions.size() > nMaxOrphans || nOrphanTxUsage > nMaxOrphanUsage)
     {
-        // Evict a random orphan:
-        uint256 randomhash = GetRandHash();
-        std::map<uint256, COrphanTx>::iterator it = mapOrphanTransactions.lower_bound(randomhash);
-        if (it == mapOrphanTransactions.end())
-            it = mapOrphanTransactions.begin();
-        EraseOrphanTx(it->first);
+        // Evict from the peer using the most orphan memory, so a peer flooding
+        // orphans cannot push out the chains other peers are relaying
+        auto itPeer = mapOrphanUsageByPeer.begin();
+        for (auto it = mapOrphanUsageByPeer.begin(); it != mapOrphanUsageByPeer.end(); ++it) {
+            if (it->second.nUsage > itPeer->second.nUsage)
+                itPeer = it;
+        }
+        // Among its orphans evict a random one no other orphan spends, so a
+        // chain that is waiting on its first parent is trimmed from the end
+        std::vector<uint256> vLeaves;
+        for (const auto& itOrphan : itPeer->second.setOrphans) {
+            if (!HasOrphanChildren(*itOrphan->second.tx))
+                vLeaves.push_back(itOrphan->first);
+        }
+        uint256 hashEvict = vLeaves.empty() ? (*itPeer->second.setOrphans.begin())->first : vLeaves[GetRand(vLeaves.size())];
+        EraseOrphanTx(hashEvict);
         ++nEvicted;
     }
+    orphanStats.nEvicted += nEvicted;
     return nEvicted;
 }
 
+void GetOrphanStats(COrphanStats &stats)
+{
+    LOCK(cs_main);
+    stats = orphanStats;
+    stats.nOrphans = mapOrphanTransactions.size();
+    stats.nUsage = nOrphanTxUsage;
+}
+
 // Requires cs_main.
 void Misbehaving(NodeId pnode, int howmuch)
 {
@@ -1214,13 +1357,62 @@ void static ProcessGetData(CNode* pfrom, const Consensus::Params& consensusParam
     }
 }
 
+/** Network serialized assetdata payload for the asset name, or nullptr if it shouldn't be answered. Requires cs_main */
+static std::shared_ptr<const std::vector<unsigned char>> GetAssetDataPayload(const std::string& name)
+{
+    AssertLockHeld(cs_main);
+
+    if (passetsDataPayloadCache && passetsDataPayloadCache->Exists(name))
+        return passetsDataPayloadCache->Get(name);
+
+    if (!IsAssetNameValid(name))
+        return nullptr;
+
+    auto currentActiveAssetCache = GetCurrentAssetCache();
+    if (!currentActiveAssetCache)
+        return nullptr;
+
+    CDatabasedAssetData data;
+    CNewAsset asset;
+    int height;
+    uint256 hash;
+    bool fFound = currentActiveAssetCache->GetAssetMetaDataIfExists(name, asset, height, hash);
+    if (fFound) {
+        data = CDatabasedAssetData(asset, height, hash);
+        passetsCache->Put(name, data);
+    } else {
+        data.asset.strName = "_NF"; // Return _NF for NOT Found
+    }
+
+    auto payload = std::make_shared<std::vector<unsigned char>>();
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, *payload, 0, SerializedAssetData(data));
+
+    // Only found assets are cached, they are erased again when reissued or disconnected
+    if (fFound && passetsDataPayloadCache)
+        passetsDataPayloadCache->Put(name, payload);
+
+    return payload;
+}
+
 void static ProcessAssetGetData(CNode* pfrom, const Consensus::Params& consensusParams, CConnman* connman, const std::atomic<bool>& interruptMsgProc)
 {
     std::deque<CInvAsset>::iterator it = pfrom->vRecvAssetGetData.begin();
-    std::vector<CInvAsset> vNotFound;
-    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+    const bool fBatch = pfrom->nVersion >= ASSETDATA_BATCH_VERSION;
+    std::vector<std::shared_ptr<const std::vector<unsigned char>>> vPayloads;
     LOCK(cs_main);
 
+    // Peers that understand massetdata get one message per MAX_ASSET_INV_SZ assets instead of one per asset
+    auto fnPushBatch = [&]() {
+        CSerializedNetMsg msg;
+        msg.command = NetMsgType::MULTIASSETDATA;
+        CVectorWriter writer(SER_NETWORK, pfrom->GetSendVersion(), msg.data, 0);
+        WriteCompactSize(writer, vPayloads.size());
+        for (const auto& payload : vPayloads)
+            msg.data.insert(msg.data.end(), payload->begin(), payload->end());
+        connman->PushMessage(pfrom, std::move(msg));
+        vPayloads.clear();
+    };
+
     while (it != pfrom->vRecvAssetGetData.end()) {
         // Don't bother if send buffer is too full to respond anyway
         if (pfrom->fPauseSend)
@@ -1233,51 +1425,28 @@ void static ProcessAssetGetData(CNode* pfrom, const Consensus::Params& consensus
 
             it++;
 
-            if (!IsAssetNameValid(inv.name)) {
-                vNotFound.push_back(inv);
+            auto payload = GetAssetDataPayload(inv.name);
+            if (!payload)
                 continue;
-            }
 
-            UNUSED_VAR bool push = false;
-            auto currentActiveAssetCache = GetCurrentAssetCache();
-            if (currentActiveAssetCache) {
-                CNewAsset asset;
-                int height;
-                uint256 hash;
-                if (currentActiveAssetCache->GetAssetMetaDataIfExists(inv.name, asset, height, hash)) {
-                    auto data = CDatabasedAssetData(asset, height, hash);
-                    passetsCache->Put(inv.name, data);
-                    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::ASSETDATA, SerializedAssetData(data)));
-                    push = true;
-                } else {
-                    CDatabasedAssetData data;
-                    data.asset.strName = "_NF"; // Return _NF for NOT Found
-                    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::ASSETDATA, SerializedAssetData(data)));
-                }
+            if (fBatch) {
+                vPayloads.push_back(payload);
+                if (vPayloads.size() == MAX_ASSET_INV_SZ)
+                    fnPushBatch();
+            } else {
+                // The serialized payload is the complete assetdata message
+                CSerializedNetMsg msg;
+                msg.command = NetMsgType::ASSETDATA;
+                msg.data = *payload;
+                connman->PushMessage(pfrom, std::move(msg));
             }
-
-//            if (!push) {
-//                vNotFound.push_back(inv);
-//            }
         }
     }
 
-    pfrom->vRecvAssetGetData.erase(pfrom->vRecvAssetGetData.begin(), it);
+    if (!vPayloads.empty())
+        fnPushBatch();
 
-//    if (!vNotFound.empty()) {
-//        // Let the peer know that we didn't find what it asked for, so it doesn't
-//        // have to wait around forever. Currently only SPV clients actually care
-//        // about this message: it's needed when they are recursively walking the
-//        // dependencies of relevant unconfirmed transactions. SPV clients want to
-//        // do that because they want to know about (and store and rebroadcast and
-//        // risk analyze) the dependencies of transactions relevant to them, without
-//        // having to download the entire memory pool.
-//        for (auto assetinv : vNotFound) {
-//            CDatabasedAssetData data;
-//            data.asset.strName = "_NF"; // Return _NF for NOT Found
-//            connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::ASSETDATA, SerializedAssetData(data)));
-//        }
-//    }
+    pfrom->vRecvAssetGetData.erase(pfrom->vRecvAssetGetData.begin(), it);
 }
 
 uint32_t GetFetchFlags(CNode* pfrom) {
@@ -2232,8 +2401,12 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 tx.GetHash().ToString(),
                 mempool.size(), mempool.DynamicMemoryUsage() / 1000);
 
-            // Recursively process any orphan transactions that depended on this one
+            // Recursively process any orphan transactions that depended on this one.
+            // The queue is breadth first from the accepted transaction, and an orphan
+            // that still has a parent in the orphan pool is left for when that parent
+            // is accepted, so a whole chain resolves in topological order in one pass.
             std::set<NodeId> setMisbehaving;
+            std::set<uint256> setOrphansResolved;
             while (!vWorkQueue.empty()) {
                 auto itByPrev = mapOrphanTransactionsByPrev.find(vWorkQueue.front());
                 vWorkQueue.pop_front();
@@ -2256,6 +2429,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
 
                     if (setMisbehaving.count(fromPeer))
                         continue;
+                    if (setOrphansResolved.count(orphanHash) || HasPendingOrphanParents(orphanTx, setOrphansResolved))
+                        continue;
                     if (AcceptToMemoryPool(mempool, stateDummy, porphanTx, &fMissingInputs2, &lRemovedTxn, false /* bypass_limits */, 0 /* nAbsurdFee */)) {
                         LogPrint(BCLog::MEMPOOL, "   accepted orphan tx %s\n", orphanHash.ToString());
                         RelayTransaction(orphanTx, connman);
@@ -2263,6 +2438,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                             vWorkQueue.emplace_back(orphanHash, i);
                         }
                         vEraseQueue.push_back(orphanHash);
+                        setOrphansResolved.insert(orphanHash);
+                        orphanStats.nResolved++;
                     }
                     else if (!fMissingInputs2)
                     {
@@ -2278,6 +2455,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                         // Probably non-standard or insufficient fee
                         LogPrint(BCLog::MEMPOOL, "   removed orphan tx %s\n", orphanHash.ToString());
                         vEraseQueue.push_back(orphanHash);
+                        setOrphansResolved.insert(orphanHash);
+                        orphanStats.nRemoved++;
                         if (!orphanTx.HasWitness() && !stateDummy.CorruptionPossible()) {
                             // Do not use rejection cache for witness transactions or
                             // witness-stripped transactions, as they can have been malleated.
@@ -2313,7 +2492,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
 
                 // DoS prevention: do not allow mapOrphanTransactions to grow unbounded
                 unsigned int nMaxOrphanTx = (unsigned int)std::max((int64_t)0, gArgs.GetArg("-maxorphantx", DEFAULT_MAX_ORPHAN_TRANSACTIONS));
-                unsigned int nEvicted = LimitOrphanTxSize(nMaxOrphanTx);
+                size_t nMaxOrphanUsage = (size_t)std::max((int64_t)0, gArgs.GetArg("-maxorphanpool", DEFAULT_MAX_ORPHAN_POOL_SIZE)) * 1000000;
+                unsigned int nEvicted = LimitOrphanTxSize(nMaxOrphanTx, nMaxOrphanUsage);
                 if (nEvicted > 0) {
                     LogPrint(BCLog::MEMPOOL, "mapOrphan overflow, removed %u tx\n", nEvicted);
                 }
@@ -2720,7 +2900,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             LOCK(cs_main);
             // Also always process if we requested the block explicitly, as we may
             // need it even though it is not a candidate for a new best tip.
-            forceProcessing |= MarkBlockAsReceived(hash);
+            forceProcessing |= MarkBlockAsReceived(hash, pfrom->GetId());
             // mapBlockSource is only used for sending reject messages and DoS scores,
             // so the race between here and cs_main in ProcessNewBlock is fine.
             mapBlockSource.emplace(hash, std::make_pair(pfrom->GetId(), true));
@@ -2938,9 +3118,9 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         // message would be undesirable as we transmit it ourselves.
     }
 
-    else if (strCommand == NetMsgType::ASSETNOTFOUND) {
-        // We do not care about the ASSETNOTFOUND message, but logging an Unknown Command
-        // message would be undesirable as we transmit it ourselves.
+    else if (strCommand == NetMsgType::ASSETNOTFOUND || strCommand == NetMsgType::MULTIASSETDATA) {
+        // We do not care about the ASSETNOTFOUND or MULTIASSETDATA messages, but logging an Unknown Command
+        // message would be undesirable as we transmit them ourselves.
     }
 
     else {
@@ -3232,20 +3412,14 @@ void PeerLogicValidation::CheckForStaleTipAndEvictPeers(const Consensus::Params
     }
 }
 
-class CompareInvMempoolOrder
+class CompareInvRelayOrder
 {
-    CTxMemPool *mp;
 public:
-    explicit CompareInvMempoolOrder(CTxMemPool *_mempool)
-    {
-        mp = _mempool;
-    }
-
-    bool operator()(std::set<uint256>::iterator a, std::set<uint256>::iterator b)
+    bool operator()(const TxRelayOrderKey& a, const TxRelayOrderKey& b) const
     {
         /* As std::make_heap produces a max-heap, we want the entries with the
          * fewest ancestors/highest fee to sort later. */
-        return mp->CompareDepthAndScore(*b, *a);
+        return b < a;
     }
 };
 
@@ -3600,12 +3774,11 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
 
             // Determine transactions to relay
             if (fSendTrickle) {
-                // Produce a vector with all candidates for sending
-                std::vector<std::set<uint256>::iterator> vInvTx;
-                vInvTx.reserve(pto->setInventoryTxToSend.size());
-                for (std::set<uint256>::iterator it = pto->setInventoryTxToSend.begin(); it != pto->setInventoryTxToSend.end(); it++) {
-                    vInvTx.push_back(it);
-                }
+                // Produce a vector with all candidates for sending. Their relay order keys are read from
+                // the mempool in one pass, so ordering them below doesn't need mempool lookups.
+                std::vector<uint256> vInvHashes(pto->setInventoryTxToSend.begin(), pto->setInventoryTxToSend.end());
+                std::vector<TxRelayOrderKey> vInvTx;
+                mempool.GetRelayOrderKeys(vInvHashes, vInvTx);
                 CAmount filterrate = 0;
                 {
                     LOCK(pto->cs_feeFilter);
@@ -3613,20 +3786,19 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
                 }
                 // Topologically and fee-rate sort the inventory we send for privacy and priority reasons.
                 // A heap is used so that not all items need sorting if only a few are being sent.
-                CompareInvMempoolOrder compareInvMempoolOrder(&mempool);
-                std::make_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
+                CompareInvRelayOrder compareInvRelayOrder;
+                std::make_heap(vInvTx.begin(), vInvTx.end(), compareInvRelayOrder);
                 // No reason to drain out at many times the network's capacity,
                 // especially since we have many peers and some will draw much shorter delays.
                 unsigned int nRelayedTransactions = 0;
                 LOCK(pto->cs_filter);
                 while (!vInvTx.empty() && nRelayedTransactions < INVENTORY_BROADCAST_MAX) {
                     // Fetch the top element from the heap
-                    std::pop_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
-                    std::set<uint256>::iterator it = vInvTx.back();
+                    std::pop_heap(vInvTx.begin(), vInvTx.end(), compareInvRelayOrder);
+                    uint256 hash = vInvTx.back().hash;
                     vInvTx.pop_back();
-                    uint256 hash = *it;
                     // Remove it from the to-be-sent set
-                    pto->setInventoryTxToSend.erase(it);
+                    pto->setInventoryTxToSend.erase(hash);
                     // Check if not in the filter already
                     if (pto->filterInventoryKnown.contains(hash)) {
                         continue;
@@ -3732,10 +3904,11 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
         // Message: getdata (blocks)
         //
         std::vector<CInv> vGetData;
-        if (!pto->fClient && (fFetch || !IsInitialBlockDownload()) && state.nBlocksInFlight < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        int nBlockQuota = GetBlockDownloadQuota(&state);
+        if (!pto->fClient && (fFetch || !IsInitialBlockDownload()) && state.nBlocksInFlight < nBlockQuota) {
             std::vector<const CBlockIndex*> vToDownload;
             NodeId staller = -1;
-            FindNextBlocksToDownload(pto->GetId(), MAX_BLOCKS_IN_TRANSIT_PER_PEER - state.nBlocksInFlight, vToDownload, staller, consensusParams);
+            FindNextBlocksToDownload(pto->GetId(), nBlockQuota - state.nBlocksInFlight, vToDownload, staller, consensusParams);
             for (const CBlockIndex *pindex : vToDownload) {
                 uint32_t nFetchFlags = GetFetchFlags(pto);
                 vGetData.push_back(CInv(MSG_BLOCK | nFetchFlags, pindex->GetBlockHash()));
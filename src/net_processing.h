@@ -12,7 +12,9 @@
 #include "consensus/params.h"
 
 /** Default for -maxorphantx, maximum number of orphan transactions kept in memory */
-static const unsigned int DEFAULT_MAX_ORPHAN_TRANSACTIONS = 100;
+static const unsigned int DEFAULT_MAX_ORPHAN_TRANSACTIONS = 1000;
+/** Default for -maxorphanpool, maximum megabytes of memory used by orphan transactions */
+static const unsigned int DEFAULT_MAX_ORPHAN_POOL_SIZE = 10;
 /** Expiration time for orphan transactions in seconds */
 static const int64_t ORPHAN_TX_EXPIRE_TIME = 20 * 60;
 /** Minimum time between orphan transactions expire time checks in seconds */
@@ -74,11 +76,26 @@ struct CNodeStateStats {
     int nMisbehavior;
     int nSyncHeight;
     int nCommonHeight;
+    int nBlockQuota;
+    int64_t nAvgBlockLatency;
     std::vector<int> vHeightInFlight;
 };
 
 /** Get statistics from node state */
 bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats);
+
+struct COrphanStats {
+    size_t nOrphans;
+    size_t nUsage;
+    uint64_t nAdded;
+    uint64_t nResolved;
+    uint64_t nRemoved;
+    uint64_t nExpired;
+    uint64_t nEvicted;
+};
+
+/** Get the size of the orphan pool and counters of what happened to its transactions */
+void GetOrphanStats(COrphanStats &stats);
 /** Increase a node's misbehavior score. */
 void Misbehaving(NodeId nodeid, int howmuch);
 
@@ -16,6 +16,8 @@
 #include "util.h"
 
 static constexpr double INF_FEERATE = 1e99;
+/** Pending decay below which TxConfirmStats folds it into the stored averages */
+static constexpr double MIN_DECAY_SCALE = 1e-20;
 
 std::string StringForFeeEstimateHorizon(FeeEstimateHorizon horizon) {
     static const std::map<FeeEstimateHorizon, std::string> horizon_strings = {
@@ -101,6 +103,12 @@ private:
 
     double decay;
 
+    // The averages above are stored divided by decayScale, the product of
+    // every decay applied since the values were last normalized. Decaying
+    // all buckets for a new block is then a single multiplication, and a
+    // block only writes to the buckets its transactions land in.
+    double decayScale;
+
     // Resolution (# of blocks) with which confirmations are tracked
     unsigned int scale;
 
@@ -113,6 +121,9 @@ private:
 
     void resizeInMemoryCounters(size_t newbuckets);
 
+    /** Fold decayScale back into the stored averages and reset it to 1 */
+    void NormalizeAverages();
+
 public:
     /**
      * Create new TxConfirmStats. This is called by BlockPolicyEstimator's
@@ -181,6 +192,7 @@ TxConfirmStats::TxConfirmStats(const std::vector<double>& defaultBuckets,
     : buckets(defaultBuckets), bucketMap(defaultBucketMap)
 {
     decay = _decay;
+    decayScale = 1;
     assert(_scale != 0 && "_scale must be non-zero");
     scale = _scale;
     confAvg.resize(maxPeriods);
@@ -224,23 +236,35 @@ void TxConfirmStats::Record(int blocksToConfirm, double val)
         return;
     int periodsToConfirm = (blocksToConfirm + scale - 1)/scale;
     unsigned int bucketindex = bucketMap.lower_bound(val)->second;
+    double weight = 1 / decayScale;
     for (size_t i = periodsToConfirm; i <= confAvg.size(); i++) {
-        confAvg[i - 1][bucketindex]++;
+        confAvg[i - 1][bucketindex] += weight;
     }
-    txCtAvg[bucketindex]++;
-    avg[bucketindex] += val;
+    txCtAvg[bucketindex] += weight;
+    avg[bucketindex] += val * weight;
 }
 
 void TxConfirmStats::UpdateMovingAverages()
 {
-    for (unsigned int j = 0; j < buckets.size(); j++) {
+    decayScale *= decay;
+    // Stored values grow as 1/decayScale; normalize well before that costs precision
+    if (decayScale < MIN_DECAY_SCALE)
+        NormalizeAverages();
+}
+
+void TxConfirmStats::NormalizeAverages()
+{
+    if (decayScale == 1)
+        return;
+    for (unsigned int j = 0; j < avg.size(); j++) {
         for (unsigned int i = 0; i < confAvg.size(); i++)
-            confAvg[i][j] = confAvg[i][j] * decay;
+            confAvg[i][j] = confAvg[i][j] * decayScale;
         for (unsigned int i = 0; i < failAvg.size(); i++)
-            failAvg[i][j] = failAvg[i][j] * decay;
-        avg[j] = avg[j] * decay;
-        txCtAvg[j] = txCtAvg[j] * decay;
+            failAvg[i][j] = failAvg[i][j] * decayScale;
+        avg[j] = avg[j] * decayScale;
+        txCtAvg[j] = txCtAvg[j] * decayScale;
     }
+    decayScale = 1;
 }
 
 // returns -1 on error conditions
@@ -288,9 +312,9 @@ double TxConfirmStats::EstimateMedianVal(int confTarget, double sufficientTxVal,
             newBucketRange = false;
         }
         curFarBucket = bucket;
-        nConf += confAvg[periodTarget - 1][bucket];
-        totalNum += txCtAvg[bucket];
-        failNum += failAvg[periodTarget - 1][bucket];
+        nConf += confAvg[periodTarget - 1][bucket] * decayScale;
+        totalNum += txCtAvg[bucket] * decayScale;
+        failNum += failAvg[periodTarget - 1][bucket] * decayScale;
         for (unsigned int confct = confTarget; confct < GetMaxConfirms(); confct++)
             extraNum += unconfTxs[(nBlockHeight - confct)%bins][bucket];
         extraNum += oldUnconfTxs[bucket];
@@ -347,6 +371,7 @@ double TxConfirmStats::EstimateMedianVal(int confTarget, double sufficientTxVal,
     // and reporting the average which is less accurate
     unsigned int minBucket = std::min(bestNearBucket, bestFarBucket);
     unsigned int maxBucket = std::max(bestNearBucket, bestFarBucket);
+    // txSum is kept in stored (unscaled) units; only the ratio avg/txCtAvg is reported
     for (unsigned int j = minBucket; j <= maxBucket; j++) {
         txSum += txCtAvg[j];
     }
@@ -396,14 +421,27 @@ double TxConfirmStats::EstimateMedianVal(int confTarget, double sufficientTxVal,
     return median;
 }
 
+static std::vector<double> ScaledAverages(const std::vector<double>& vals, double factor)
+{
+    std::vector<double> ret(vals);
+    for (double& val : ret)
+        val *= factor;
+    return ret;
+}
+
 void TxConfirmStats::Write(CAutoFile& fileout) const
 {
+    // The file format holds the true averages, so apply any pending decay
     fileout << decay;
     fileout << scale;
-    fileout << avg;
-    fileout << txCtAvg;
-    fileout << confAvg;
-    fileout << failAvg;
+    fileout << ScaledAverages(avg, decayScale);
+    fileout << ScaledAverages(txCtAvg, decayScale);
+    WriteCompactSize(fileout, confAvg.size());
+    for (const auto& periodAvg : confAvg)
+        fileout << ScaledAverages(periodAvg, decayScale);
+    WriteCompactSize(fileout, failAvg.size());
+    for (const auto& periodAvg : failAvg)
+        fileout << ScaledAverages(periodAvg, decayScale);
 }
 
 void TxConfirmStats::Read(CAutoFile& filein, int nFileVersion, size_t numBuckets)
@@ -463,6 +501,9 @@ void TxConfirmStats::Read(CAutoFile& filein, int nFileVersion, size_t numBuckets
         }
     }
 
+    // Values read from the file are already fully decayed
+    decayScale = 1;
+
     // Resize the current block variables which aren't stored in the data file
     // to match the number of confirms and buckets
     resizeInMemoryCounters(numBuckets);
@@ -511,7 +552,7 @@ void TxConfirmStats::removeTx(unsigned int entryHeight, unsigned int nBestSeenHe
         assert(scale != 0);
         unsigned int periodsAgo = blocksAgo / scale;
         for (size_t i = 0; i < periodsAgo && i < failAvg.size(); i++) {
-            failAvg[i][bucketindex]++;
+            failAvg[i][bucketindex] += 1 / decayScale;
         }
     }
 }
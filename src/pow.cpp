@@ -15,6 +15,99 @@
 #include "chainparams.h"
 #include "tinyformat.h"
 
+#include <mutex>
+
+namespace {
+
+/** The part of DarkGravityWave that depends only on the past blocks, not on the block being built */
+struct DGWWindow
+{
+    arith_uint256 bnPastTargetAvg;
+    int64_t nFirstBlockTime;
+    int nKAWPOWBlocksFound;
+};
+
+/**
+ * Windows of the most recently retargeted-from blocks, keyed by block hash.
+ * CreateNewBlock, TestBlockValidity and each getblocktemplate call retarget
+ * from the same tip, as do competing headers built on the same parent.
+ */
+class DGWWindowCache
+{
+private:
+    static const size_t MAX_ENTRIES = 8;
+
+    std::mutex cs;
+    uint256 vHashes[MAX_ENTRIES];
+    DGWWindow vWindows[MAX_ENTRIES];
+    size_t nNext = 0;
+
+public:
+    bool Get(const CBlockIndex* pindexLast, DGWWindow& window)
+    {
+        if (!pindexLast->phashBlock)
+            return false;
+        std::lock_guard<std::mutex> lock(cs);
+        for (size_t i = 0; i < MAX_ENTRIES; i++) {
+            if (vHashes[i] == *pindexLast->phashBlock) {
+                window = vWindows[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Put(const CBlockIndex* pindexLast, const DGWWindow& window)
+    {
+        if (!pindexLast->phashBlock)
+            return;
+        std::lock_guard<std::mutex> lock(cs);
+        vHashes[nNext] = *pindexLast->phashBlock;
+        vWindows[nNext] = window;
+        nNext = (nNext + 1) % MAX_ENTRIES;
+    }
+};
+
+DGWWindowCache dgwWindowCache;
+
+} // namespace
+
+/**
+ * Walk the nPastBlocks blocks ending at pindexLast. The running "average" is
+ * truncated at every step, starting from the newest block, so it can't be
+ * slid along the chain and still give the same bits; instead each step uses
+ * a single-word multiply and divide rather than full 256-bit ones.
+ */
+static void ComputeDGWWindow(const CBlockIndex* pindexLast, int64_t nPastBlocks, DGWWindow& window)
+{
+    const CBlockIndex *pindex = pindexLast;
+    arith_uint256& bnPastTargetAvg = window.bnPastTargetAvg;
+
+    window.nKAWPOWBlocksFound = 0;
+    for (unsigned int nCountBlocks = 1; nCountBlocks <= nPastBlocks; nCountBlocks++) {
+        arith_uint256 bnTarget = arith_uint256().SetCompact(pindex->nBits);
+        if (nCountBlocks == 1) {
+            bnPastTargetAvg = bnTarget;
+        } else {
+            // NOTE: that's not an average really...
+            bnPastTargetAvg *= nCountBlocks;
+            bnPastTargetAvg += bnTarget;
+            bnPastTargetAvg.DivideBy(nCountBlocks + 1);
+        }
+
+        // Count how blocks are KAWPOW mined in the last 180 blocks
+        if (pindex->nTime >= nKAWPOWActivationTime) {
+            window.nKAWPOWBlocksFound++;
+        }
+
+        if(nCountBlocks != nPastBlocks) {
+            assert(pindex->pprev); // should never fail
+            pindex = pindex->pprev;
+        }
+    }
+    window.nFirstBlockTime = pindex->GetBlockTime();
+}
+
 unsigned int static DarkGravityWave(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params& params) {
     /* current difficulty formula, dash - DarkGravity v3, written by Evan Duffield - evan@dash.org */
     assert(pindexLast != nullptr);
@@ -44,29 +137,13 @@ unsigned int static DarkGravityWave(const CBlockIndex* pindexLast, const CBlockH
         }
     }
 
-    const CBlockIndex *pindex = pindexLast;
-    arith_uint256 bnPastTargetAvg;
-
-    int nKAWPOWBlocksFound = 0;
-    for (unsigned int nCountBlocks = 1; nCountBlocks <= nPastBlocks; nCountBlocks++) {
-        arith_uint256 bnTarget = arith_uint256().SetCompact(pindex->nBits);
-        if (nCountBlocks == 1) {
-            bnPastTargetAvg = bnTarget;
-        } else {
-            // NOTE: that's not an average really...
-            bnPastTargetAvg = (bnPastTargetAvg * nCountBlocks + bnTarget) / (nCountBlocks + 1);
-        }
-
-        // Count how blocks are KAWPOW mined in the last 180 blocks
-        if (pindex->nTime >= nKAWPOWActivationTime) {
-            nKAWPOWBlocksFound++;
-        }
-
-        if(nCountBlocks != nPastBlocks) {
-            assert(pindex->pprev); // should never fail
-            pindex = pindex->pprev;
-        }
+    DGWWindow window;
+    if (!dgwWindowCache.Get(pindexLast, window)) {
+        ComputeDGWWindow(pindexLast, nPastBlocks, window);
+        dgwWindowCache.Put(pindexLast, window);
     }
+    const arith_uint256& bnPastTargetAvg = window.bnPastTargetAvg;
+    int nKAWPOWBlocksFound = window.nKAWPOWBlocksFound;
 
     // If we are mining a KAWPOW block. We check to see if we have mined
     // 180 KAWPOW blocks already. If we haven't we are going to return our
@@ -81,7 +158,7 @@ unsigned int static DarkGravityWave(const CBlockIndex* pindexLast, const CBlockH
 
     arith_uint256 bnNew(bnPastTargetAvg);
 
-    int64_t nActualTimespan = pindexLast->GetBlockTime() - pindex->GetBlockTime();
+    int64_t nActualTimespan = pindexLast->GetBlockTime() - window.nFirstBlockTime;
     // NOTE: is this accurate? nActualTimespan counts it for (nPastBlocks - 1) blocks only...
     int64_t nTargetTimespan = nPastBlocks * params.nPowTargetSpacing;
 
@@ -91,8 +168,9 @@ unsigned int static DarkGravityWave(const CBlockIndex* pindexLast, const CBlockH
         nActualTimespan = nTargetTimespan*3;
 
     // Retarget
-    bnNew *= nActualTimespan;
-    bnNew /= nTargetTimespan;
+    // (both timespans are a few hours at most, well within 32 bits)
+    bnNew *= (uint32_t)nActualTimespan;
+    bnNew.DivideBy((uint32_t)nTargetTimespan);
 
     if (bnNew > bnPowLimit) {
         bnNew = bnPowLimit;
@@ -262,6 +262,13 @@ extern const char *ASSETDATA;
  * @since protocol version 70018.
  */
     extern const char *ASSETNOTFOUND;
+
+/**
+ * Contains a vector of AssetData, one entry per asset requested in a
+ * "getassetdata" message, replacing the individual "assetdata" messages.
+ * @since protocol version 70029.
+ */
+extern const char *MULTIASSETDATA;
 };
 
 /* Get a vector of all valid message types (see above) */
@@ -42,6 +42,17 @@ public:
         }
     }
 
+    friend bool operator==(const AssetRecord& a, const AssetRecord& b)
+    {
+        return a.name == b.name && a.quantity == b.quantity && a.units == b.units &&
+               a.fIsAdministrator == b.fIsAdministrator && a.ipfshash == b.ipfshash;
+    }
+
+    friend bool operator!=(const AssetRecord& a, const AssetRecord& b)
+    {
+        return !(a == b);
+    }
+
     /** @name Immutable attributes
       @{*/
     std::string name;
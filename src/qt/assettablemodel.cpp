@@ -17,80 +17,125 @@
 #include "assets/assets.h"
 #include "validation.h"
 #include "platformstyle.h"
+#include "ui_interface.h"
 
 #include <QDebug>
 #include <QStringList>
+#include <QThread>
 
+#include <boost/bind/bind.hpp>
+using namespace boost::placeholders;
 
+/** Computes the wallet's asset balances on a background thread, so that large wallets don't block the GUI
+ */
+class AssetBalanceWorker : public QObject
+{
+    Q_OBJECT
 
-class AssetTablePriv {
-public:
-    AssetTablePriv(AssetTableModel *_parent) :
-            parent(_parent)
-    {
-    }
+public Q_SLOTS:
+    void refresh(const QStringList& staleAssetNames);
 
-    AssetTableModel *parent;
+Q_SIGNALS:
+    void balancesReady(const QList<AssetRecord>& records, bool fSuccess);
 
-    QList<AssetRecord> cachedBalances;
+private:
+    struct AssetMetadata {
+        uint8_t units;
+        std::string ipfsHash;
+    };
+
+    // Metadata is looked up once per asset, and again only after a transaction involving the asset (e.g. a reissue)
+    std::map<std::string, AssetMetadata> mapMetadata;
+};
 
-    // loads all current balances into cache
+#include "assettablemodel.moc"
+
+void AssetBalanceWorker::refresh(const QStringList& staleAssetNames)
+{
+    QList<AssetRecord> records;
 #ifdef ENABLE_WALLET
-    void refreshWallet() {
-        qDebug() << "AssetTablePriv::refreshWallet";
-        cachedBalances.clear();
-        auto currentActiveAssetCache = GetCurrentAssetCache();
-        if (currentActiveAssetCache) {
-            {
-                LOCK(cs_main);
-                std::map<std::string, CAmount> balances;
-                std::map<std::string, std::vector<COutput> > outputs;
-                if (!GetAllMyAssetBalances(outputs, balances)) {
-                    qWarning("AssetTablePriv::refreshWallet: Error retrieving asset balances");
+    qDebug() << "AssetBalanceWorker::refresh";
+    for (const QString& name : staleAssetNames) {
+        std::string strName = name.toStdString();
+        if (IsAssetNameAnOwner(strName))
+            strName.pop_back();
+        mapMetadata.erase(strName);
+    }
+
+    auto currentActiveAssetCache = GetCurrentAssetCache();
+    if (!currentActiveAssetCache) {
+        Q_EMIT balancesReady(records, false);
+        return;
+    }
+
+    LOCK(cs_main);
+    std::map<std::string, CAmount> balances;
+    std::map<std::string, std::vector<COutput> > outputs;
+    if (!GetAllMyAssetBalances(outputs, balances)) {
+        qWarning("AssetBalanceWorker::refresh: Error retrieving asset balances");
+        Q_EMIT balancesReady(records, false);
+        return;
+    }
+    std::set<std::string> setAssetsToSkip;
+    auto bal = balances.begin();
+    for (; bal != balances.end(); bal++) {
+        // retrieve units for asset
+        uint8_t units = OWNER_UNITS;
+        bool fIsAdministrator = true;
+        std::string ipfsHash = "";
+
+        if (setAssetsToSkip.count(bal->first))
+            continue;
+
+        if (!IsAssetNameAnOwner(bal->first)) {
+            // Asset is not an administrator asset
+            auto it = mapMetadata.find(bal->first);
+            if (it == mapMetadata.end()) {
+                CNewAsset assetData;
+                if (!currentActiveAssetCache->GetAssetMetaDataIfExists(bal->first, assetData)) {
+                    qWarning("AssetBalanceWorker::refresh: Error retrieving asset data");
+                    Q_EMIT balancesReady(records, false);
                     return;
                 }
-                std::set<std::string> setAssetsToSkip;
-                auto bal = balances.begin();
-                for (; bal != balances.end(); bal++) {
-                    // retrieve units for asset
-                    uint8_t units = OWNER_UNITS;
-                    bool fIsAdministrator = true;
-                    std::string ipfsHash = "";
-
-                    if (setAssetsToSkip.count(bal->first))
-                        continue;
-
-                    if (!IsAssetNameAnOwner(bal->first)) {
-                        // Asset is not an administrator asset
-                        CNewAsset assetData;
-                        if (!currentActiveAssetCache->GetAssetMetaDataIfExists(bal->first, assetData)) {
-                            qWarning("AssetTablePriv::refreshWallet: Error retrieving asset data");
-                            return;
-                        }
-                        units = assetData.units;
-                        ipfsHash = assetData.strIPFSHash;
-                        // If we have the administrator asset, add it to the skip listå
-                        if (balances.count(bal->first + OWNER_TAG)) {
-                            setAssetsToSkip.insert(bal->first + OWNER_TAG);
-                        } else {
-                            fIsAdministrator = false;
-                        }
-                    } else {
-                        // Asset is an administrator asset, if we own assets that is administrators, skip this balance
-                        std::string name = bal->first;
-                        name.pop_back();
-                        if (balances.count(name)) {
-                            setAssetsToSkip.insert(bal->first);
-                            continue;
-                        }
-                    }
-                    cachedBalances.append(AssetRecord(bal->first, bal->second, units, fIsAdministrator, EncodeAssetData(ipfsHash)));
-                }
+                it = mapMetadata.emplace(bal->first, AssetMetadata{assetData.units, assetData.strIPFSHash}).first;
+            }
+            units = it->second.units;
+            ipfsHash = it->second.ipfsHash;
+            // If we have the administrator asset, add it to the skip list
+            if (balances.count(bal->first + OWNER_TAG)) {
+                setAssetsToSkip.insert(bal->first + OWNER_TAG);
+            } else {
+                fIsAdministrator = false;
+            }
+        } else {
+            // Asset is an administrator asset, if we own assets that is administrators, skip this balance
+            std::string name = bal->first;
+            name.pop_back();
+            if (balances.count(name)) {
+                setAssetsToSkip.insert(bal->first);
+                continue;
             }
         }
+        records.append(AssetRecord(bal->first, bal->second, units, fIsAdministrator, EncodeAssetData(ipfsHash)));
     }
+    Q_EMIT balancesReady(records, true);
+#else
+    Q_UNUSED(staleAssetNames);
+    Q_EMIT balancesReady(records, false);
 #endif
+}
 
+class AssetTablePriv {
+public:
+    AssetTablePriv(AssetTableModel *_parent) :
+            parent(_parent)
+    {
+    }
+
+    AssetTableModel *parent;
+
+    // Balances sorted by asset name, as produced by AssetBalanceWorker
+    QList<AssetRecord> cachedBalances;
 
     int size() {
         return cachedBalances.size();
@@ -103,33 +148,155 @@ public:
         return 0;
     }
 
+    bool contains(const std::string& name) {
+        auto it = std::lower_bound(cachedBalances.begin(), cachedBalances.end(), name,
+                                   [](const AssetRecord& rec, const std::string& str) { return rec.name < str; });
+        return it != cachedBalances.end() && it->name == name;
+    }
+
 };
 
 AssetTableModel::AssetTableModel(WalletModel *parent) :
         QAbstractTableModel(parent),
         walletModel(parent),
-        priv(new AssetTablePriv(this))
+        priv(new AssetTablePriv(this)),
+        fDirty(true),
+        fRefreshInFlight(false)
 {
     columns << tr("Name") << tr("Quantity");
-#ifdef ENABLE_WALLET
-    priv->refreshWallet();
-#endif
+
+    qRegisterMetaType<AssetRecord>("AssetRecord");
+    qRegisterMetaType<QList<AssetRecord> >("QList<AssetRecord>");
+
+    thread = new QThread(this);
+    AssetBalanceWorker *worker = new AssetBalanceWorker();
+    worker->moveToThread(thread);
+
+    connect(this, SIGNAL(requestRefresh(QStringList)), worker, SLOT(refresh(QStringList)));
+    connect(worker, SIGNAL(balancesReady(QList<AssetRecord>,bool)), this, SLOT(refreshFinished(QList<AssetRecord>,bool)));
+    /*  make sure worker object is deleted in its own thread */
+    connect(this, SIGNAL(stopThread()), worker, SLOT(deleteLater()));
+    connect(this, SIGNAL(stopThread()), thread, SLOT(quit()));
+
+    thread->start();
+
+    subscribeToCoreSignals();
+    requestRefreshIfDirty();
 };
 
 AssetTableModel::~AssetTableModel()
 {
+    unsubscribeFromCoreSignals();
+    /* Ensure thread is finished before it is deleted */
+    Q_EMIT stopThread();
+    thread->wait();
     delete priv;
 };
 
 void AssetTableModel::checkBalanceChanged() {
     qDebug() << "AssetTableModel::CheckBalanceChanged";
-    // TODO: optimize by 1) updating cache incrementally; and 2) emitting more specific dataChanged signals
-    Q_EMIT layoutAboutToBeChanged();
-#ifdef ENABLE_WALLET
-    priv->refreshWallet();
-#endif
-    Q_EMIT dataChanged(index(0, 0, QModelIndex()), index(priv->size(), columns.length()-1, QModelIndex()));
-    Q_EMIT layoutChanged();
+    requestRefreshIfDirty();
+}
+
+void AssetTableModel::requestRefreshIfDirty()
+{
+    // Only one refresh is queued at a time; changes arriving meanwhile are picked up when it finishes
+    if (!fDirty || fRefreshInFlight)
+        return;
+
+    QStringList staleAssetNames;
+    for (const std::string& name : setDirtyAssets)
+        staleAssetNames.append(QString::fromStdString(name));
+
+    fDirty = false;
+    fRefreshInFlight = true;
+    setDirtyAssets.clear();
+    Q_EMIT requestRefresh(staleAssetNames);
+}
+
+void AssetTableModel::refreshFinished(const QList<AssetRecord>& records, bool fSuccess)
+{
+    fRefreshInFlight = false;
+    if (fSuccess)
+        applyBalances(records);
+
+    requestRefreshIfDirty();
+}
+
+void AssetTableModel::updateAssetTransaction(const QStringList& assetNames)
+{
+    for (const QString& name : assetNames)
+        setDirtyAssets.insert(name.toStdString());
+    fDirty = true;
+
+    requestRefreshIfDirty();
+}
+
+void AssetTableModel::updateAssetData(const QStringList& assetNames)
+{
+    // Only units and IPFS hashes of assets shown in the table, directly or through their owner asset, can be stale
+    bool fShown = false;
+    for (const QString& name : assetNames) {
+        std::string strName = name.toStdString();
+        if (priv->contains(strName) || priv->contains(strName + OWNER_TAG)) {
+            setDirtyAssets.insert(strName);
+            fShown = true;
+        }
+    }
+    if (!fShown)
+        return;
+    fDirty = true;
+
+    requestRefreshIfDirty();
+}
+
+void AssetTableModel::applyBalances(const QList<AssetRecord>& records)
+{
+    QList<AssetRecord>& cached = priv->cachedBalances;
+
+    // Both lists are sorted by name, so walk them together
+    int row = 0;
+    int i = 0;
+    while (i < records.size()) {
+        const std::string& name = records[i].name;
+
+        // Cached assets sorting before the next record are no longer held
+        int nRemove = 0;
+        while (row + nRemove < cached.size() && cached[row + nRemove].name < name)
+            ++nRemove;
+        if (nRemove > 0) {
+            beginRemoveRows(QModelIndex(), row, row + nRemove - 1);
+            cached.erase(cached.begin() + row, cached.begin() + row + nRemove);
+            endRemoveRows();
+        }
+
+        if (row < cached.size() && cached[row].name == name) {
+            if (cached[row] != records[i]) {
+                cached[row] = records[i];
+                Q_EMIT dataChanged(index(row, 0, QModelIndex()), index(row, columns.length() - 1, QModelIndex()));
+            }
+            ++row;
+            ++i;
+            continue;
+        }
+
+        // Insert a run of new assets with a single insert notification
+        int nInsert = 1;
+        while (i + nInsert < records.size() && (row >= cached.size() || records[i + nInsert].name < cached[row].name))
+            ++nInsert;
+        beginInsertRows(QModelIndex(), row, row + nInsert - 1);
+        for (int n = 0; n < nInsert; ++n)
+            cached.insert(row + n, records[i + n]);
+        endInsertRows();
+        row += nInsert;
+        i += nInsert;
+    }
+
+    if (row < cached.size()) {
+        beginRemoveRows(QModelIndex(), row, cached.size() - 1);
+        cached.erase(cached.begin() + row, cached.end());
+        endRemoveRows();
+    }
 }
 
 int AssetTableModel::rowCount(const QModelIndex &parent) const
@@ -271,4 +438,96 @@ QString AssetTableModel::formatAssetQuantity(const AssetRecord *wtx) const
 QString AssetTableModel::formatAssetData(const AssetRecord *wtx) const
 {
     return QString::fromStdString(wtx->ipfshash);
-}
\ No newline at end of file
+}
+#ifdef ENABLE_WALLET
+static void CollectAssetName(const CTxOut& txout, QStringList& assetNames)
+{
+    int nType;
+    bool fIsOwner;
+    if (!txout.scriptPubKey.IsAssetScript(nType, fIsOwner))
+        return;
+
+    CAssetOutputEntry data;
+    if (GetAssetData(txout.scriptPubKey, data))
+        assetNames.append(QString::fromStdString(data.assetName));
+}
+
+static void NotifyTransactionChanged(AssetTableModel *assetTableModel, CWallet *wallet, const uint256 &hash, ChangeType status)
+{
+    Q_UNUSED(status);
+    QStringList assetNames;
+    {
+        LOCK(wallet->cs_wallet);
+        auto it = wallet->mapWallet.find(hash);
+        if (it != wallet->mapWallet.end()) {
+            const CTransaction& tx = *it->second.tx;
+            for (const auto& txout : tx.vout)
+                CollectAssetName(txout, assetNames);
+            for (const auto& txin : tx.vin) {
+                auto prev = wallet->mapWallet.find(txin.prevout.hash);
+                if (prev != wallet->mapWallet.end() && txin.prevout.n < prev->second.tx->vout.size())
+                    CollectAssetName(prev->second.tx->vout[txin.prevout.n], assetNames);
+            }
+
+            // Transactions that neither create nor spend assets can't change asset balances
+            if (assetNames.isEmpty())
+                return;
+        }
+    }
+
+    QMetaObject::invokeMethod(assetTableModel, "updateAssetTransaction", Qt::QueuedConnection,
+                              Q_ARG(QStringList, assetNames));
+}
+
+static void NotifyCoinLockChanged(AssetTableModel *assetTableModel, CWallet *wallet, const COutPoint &output, bool fLocked)
+{
+    Q_UNUSED(fLocked);
+    QStringList assetNames;
+    {
+        LOCK(wallet->cs_wallet);
+        auto it = wallet->mapWallet.find(output.hash);
+        if (it != wallet->mapWallet.end() && output.n < it->second.tx->vout.size())
+            CollectAssetName(it->second.tx->vout[output.n], assetNames);
+    }
+
+    // Locked coins don't count towards the balance, but only asset outputs affect the asset table
+    if (assetNames.isEmpty())
+        return;
+
+    // The coin's asset metadata is unchanged, so don't pass its name on as stale
+    QMetaObject::invokeMethod(assetTableModel, "updateAssetTransaction", Qt::QueuedConnection,
+                              Q_ARG(QStringList, QStringList()));
+}
+#endif
+
+static void NotifyAssetDataChanged(AssetTableModel *assetTableModel, const std::set<std::string>& setAssetNames)
+{
+    QStringList assetNames;
+    for (const std::string& name : setAssetNames)
+        assetNames.append(QString::fromStdString(name));
+
+    QMetaObject::invokeMethod(assetTableModel, "updateAssetData", Qt::QueuedConnection,
+                              Q_ARG(QStringList, assetNames));
+}
+
+void AssetTableModel::subscribeToCoreSignals()
+{
+    uiInterface.NotifyAssetDataChanged.connect(boost::bind(NotifyAssetDataChanged, this, _1));
+#ifdef ENABLE_WALLET
+    if (walletModel) {
+        walletModel->getWallet()->NotifyTransactionChanged.connect(boost::bind(NotifyTransactionChanged, this, _1, _2, _3));
+        walletModel->getWallet()->NotifyCoinLockChanged.connect(boost::bind(NotifyCoinLockChanged, this, _1, _2, _3));
+    }
+#endif
+}
+
+void AssetTableModel::unsubscribeFromCoreSignals()
+{
+    uiInterface.NotifyAssetDataChanged.disconnect(boost::bind(NotifyAssetDataChanged, this, _1));
+#ifdef ENABLE_WALLET
+    if (walletModel) {
+        walletModel->getWallet()->NotifyTransactionChanged.disconnect(boost::bind(NotifyTransactionChanged, this, _1, _2, _3));
+        walletModel->getWallet()->NotifyCoinLockChanged.disconnect(boost::bind(NotifyCoinLockChanged, this, _1, _2, _3));
+    }
+#endif
+}
@@ -7,13 +7,22 @@
 #define RAVEN_QT_ASSETTABLEMODEL_H
 
 #include "amount.h"
+#include "assetrecord.h"
 
 #include <QAbstractTableModel>
+#include <QList>
+#include <QMetaType>
 #include <QStringList>
 
+#include <set>
+#include <string>
+
 class AssetTablePriv;
 class WalletModel;
-class AssetRecord;
+
+QT_BEGIN_NAMESPACE
+class QThread;
+QT_END_NAMESPACE
 
 class CAssets;
 
@@ -60,14 +69,43 @@ public:
     QString formatAssetName(const AssetRecord *wtx) const;
     QString formatAssetQuantity(const AssetRecord *wtx) const;
 
+    /** Refresh the balances in the background if a wallet transaction touching assets changed since the last refresh */
     void checkBalanceChanged();
 
+public Q_SLOTS:
+    /** Replace the cached balances with records (sorted by name), emitting row signals only for assets that differ */
+    void applyBalances(const QList<AssetRecord>& records);
+
+    /** A wallet transaction involving assetNames changed. An empty list means the affected assets are unknown */
+    void updateAssetTransaction(const QStringList& assetNames);
+
+    /** Assets were issued, reissued or removed on chain, so units and IPFS hashes cached for them may be stale */
+    void updateAssetData(const QStringList& assetNames);
+
+private Q_SLOTS:
+    void refreshFinished(const QList<AssetRecord>& records, bool fSuccess);
+
+Q_SIGNALS:
+    void requestRefresh(const QStringList& staleAssetNames);
+    void stopThread();
+
 private:
     WalletModel *walletModel;
     QStringList columns;
     AssetTablePriv *priv;
+    QThread *thread;
+
+    bool fDirty;
+    bool fRefreshInFlight;
+    std::set<std::string> setDirtyAssets;
+
+    void requestRefreshIfDirty();
+    void subscribeToCoreSignals();
+    void unsubscribeFromCoreSignals();
 
     friend class AssetTablePriv;
 };
 
+Q_DECLARE_METATYPE(AssetRecord)
+
 #endif // RAVEN_QT_ASSETTABLEMODEL_H
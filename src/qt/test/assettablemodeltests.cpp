@@ -0,0 +1,99 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "assettablemodeltests.h"
+
+#include "qt/assetrecord.h"
+#include "qt/assettablemodel.h"
+
+#include "assets/assets.h"
+
+#include <QSignalSpy>
+
+namespace
+{
+QList<AssetRecord> MakeRecords(int count)
+{
+    QList<AssetRecord> records;
+    for (int i = 0; i < count; ++i)
+        records.append(AssetRecord(strprintf("ASSET%05d", i), (i + 1) * COIN, 0, false, ""));
+    return records;
+}
+}
+
+void AssetTableModelTests::applyBalancesTests()
+{
+    AssetTableModel model(nullptr);
+    QSignalSpy inserted(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy removed(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy changed(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+
+    // The initial load is a single insert
+    QList<AssetRecord> records = MakeRecords(10);
+    model.applyBalances(records);
+    QCOMPARE(model.rowCount(QModelIndex()), 10);
+    QCOMPARE(inserted.count(), 1);
+
+    // Applying the same balances again changes nothing
+    model.applyBalances(records);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(removed.count(), 0);
+    QCOMPARE(changed.count(), 0);
+
+    // A changed balance only touches its own row
+    records[3].quantity += COIN;
+    model.applyBalances(records);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changed.at(0).at(0).value<QModelIndex>().row(), 3);
+    QCOMPARE(model.data(model.index(3, 0), AssetTableModel::AmountRole).toULongLong(), (unsigned long long)(5 * COIN));
+
+    // Spent and new assets are removed and inserted in place
+    records.removeAt(5);
+    records.insert(0, AssetRecord("AAA", COIN, 0, false, ""));
+    model.applyBalances(records);
+    QCOMPARE(model.rowCount(QModelIndex()), 10);
+    QCOMPARE(inserted.count(), 2);
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(model.data(model.index(0, 0), AssetTableModel::AssetNameRole).toString(), QString("AAA"));
+    QCOMPARE(model.data(model.index(6, 0), AssetTableModel::AssetNameRole).toString(), QString("ASSET00006"));
+
+    model.applyBalances(QList<AssetRecord>());
+    QCOMPARE(model.rowCount(QModelIndex()), 0);
+}
+
+void AssetTableModelTests::updateAssetDataTests()
+{
+    AssetTableModel model(nullptr);
+    QList<AssetRecord> records = MakeRecords(10);
+    records.append(AssetRecord("OWNED!", OWNER_ASSET_AMOUNT, OWNER_UNITS, true, ""));
+    model.applyBalances(records);
+
+    // The refresh queued on construction is still in flight, so the next one carries all stale names at once
+    QSignalSpy refreshes(&model, SIGNAL(requestRefresh(QStringList)));
+    model.updateAssetData(QStringList() << "NOT_HELD" << "ASSET00003");
+    model.updateAssetData(QStringList() << "OWNED");
+    QTRY_COMPARE(refreshes.count(), 1);
+    QStringList stale = refreshes.at(0).at(0).toStringList();
+    stale.sort();
+    QCOMPARE(stale, QStringList() << "ASSET00003" << "OWNED");
+
+    // Changes to assets the wallet doesn't hold don't refresh the table
+    model.updateAssetData(QStringList() << "NOT_HELD");
+    QTest::qWait(100);
+    QCOMPARE(refreshes.count(), 1);
+}
+
+void AssetTableModelTests::applyBalancesBenchmark()
+{
+    AssetTableModel model(nullptr);
+    QList<AssetRecord> records = MakeRecords(10000);
+    model.applyBalances(records);
+
+    // A wallet transaction usually moves a single asset balance
+    QBENCHMARK {
+        records[5000].quantity += COIN;
+        model.applyBalances(records);
+    }
+    QCOMPARE(model.rowCount(QModelIndex()), 10000);
+}
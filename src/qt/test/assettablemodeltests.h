@@ -0,0 +1,21 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef RAVEN_QT_TEST_ASSETTABLEMODELTESTS_H
+#define RAVEN_QT_TEST_ASSETTABLEMODELTESTS_H
+
+#include <QObject>
+#include <QTest>
+
+class AssetTableModelTests : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void applyBalancesTests();
+    void updateAssetDataTests();
+    void applyBalancesBenchmark();
+};
+
+#endif // RAVEN_QT_TEST_ASSETTABLEMODELTESTS_H
@@ -7,6 +7,7 @@
 #include "config/raven-config.h"
 #endif
 
+#include "assettablemodeltests.h"
 #include "chainparams.h"
 #include "rpcnestedtests.h"
 #include "util.h"
@@ -99,6 +100,11 @@ int main(int argc, char *argv[])
     {
         fInvalid = true;
     }
+    AssetTableModelTests test6;
+    if (QTest::qExec(&test6) != 0)
+    {
+        fInvalid = true;
+    }
 #ifdef ENABLE_WALLET
     WalletTests test5;
     if (QTest::qExec(&test5) != 0) {
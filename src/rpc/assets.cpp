@@ -344,11 +344,11 @@ UniValue UpdateGlobalRestrictedAsset(const JSONRPCRequest &request, const int8_t
         throw JSONRPCError(RPC_INVALID_PARAMETER, std::string("Unsupported asset type: ") + AssetTypeToString(assetType));
     }
 
-    if (flag == 1 && mempool.mapGlobalFreezingAssetTransactions.count(restricted_name)){
+    if (flag == 1 && mempool.mapGlobalFreezingAssetTransactions.Exists(restricted_name)){
         throw JSONRPCError(RPC_TRANSACTION_REJECTED, std::string("Freezing transaction already in mempool"));
     }
 
-    if (flag == 0 && mempool.mapGlobalUnFreezingAssetTransactions.count(restricted_name)){
+    if (flag == 0 && mempool.mapGlobalUnFreezingAssetTransactions.Exists(restricted_name)){
         throw JSONRPCError(RPC_TRANSACTION_REJECTED, std::string("Unfreezing transaction already in mempool"));
     }
 
@@ -15,6 +15,7 @@
 #include "consensus/validation.h"
 #include "validation.h"
 #include "core_io.h"
+#include "net_processing.h"
 #include "policy/feerate.h"
 #include "policy/policy.h"
 #include "primitives/transaction.h"
@@ -216,7 +217,7 @@ UniValue blockToDeltasJSON(const CBlock& block, const CBlockIndex* blockindex)
     return result;
 }
 
-UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails)
+UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails, unsigned int script_fields)
 {
     UniValue result(UniValue::VOBJ);
     result.push_back(Pair("hash", blockindex->GetBlockHash().GetHex()));
@@ -233,18 +234,19 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool tx
     result.push_back(Pair("versionHex", strprintf("%08x", block.nVersion)));
     result.push_back(Pair("merkleroot", block.hashMerkleRoot.GetHex()));
     UniValue txs(UniValue::VARR);
+    ScriptPubKeyUnivCache scriptCache;
     for(const auto& tx : block.vtx)
     {
         if(txDetails)
         {
             UniValue objTx(UniValue::VOBJ);
-            TxToUniv(*tx, uint256(), objTx, true, RPCSerializationFlags());
-            txs.push_back(objTx);
+            TxToUniv(*tx, uint256(), objTx, script_fields & SCRIPT_FIELD_HEX, RPCSerializationFlags(), script_fields, &scriptCache);
+            txs.push_back(std::move(objTx));
         }
         else
             txs.push_back(tx->GetHash().GetHex());
     }
-    result.push_back(Pair("tx", txs));
+    result.pushKV("tx", std::move(txs));
     result.push_back(Pair("time", block.GetBlockTime()));
     result.push_back(Pair("mediantime", (int64_t)blockindex->GetMedianTimePast()));
     result.push_back(Pair("nonce", (uint64_t)block.nNonce));
@@ -931,15 +933,16 @@ UniValue getblockheader(const JSONRPCRequest& request)
 
 UniValue getblock(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3)
         throw std::runtime_error(
-            "getblock \"blockhash\" ( verbosity ) \n"
+            "getblock \"blockhash\" ( verbosity include_scripts ) \n"
             "\nIf verbosity is 0, returns a string that is serialized, hex-encoded data for block 'hash'.\n"
             "If verbosity is 1, returns an Object with information about block <hash>.\n"
             "If verbosity is 2, returns an Object with information about block <hash> and information about each transaction. \n"
             "\nArguments:\n"
             "1. \"blockhash\"          (string, required) The block hash\n"
             "2. verbosity              (numeric, optional, default=1) 0 for hex encoded data, 1 for a json object, and 2 for json object with transaction data\n"
+            "3. include_scripts        (boolean, optional, default=true) With verbosity 2, false leaves out the asm and hex of every script and the hex of every transaction\n"
             "\nResult (for verbosity = 0):\n"
             "\"data\"             (string) A string that is serialized, hex-encoded data for block 'hash'.\n"
             "\nResult (for verbosity = 1):\n"
@@ -976,6 +979,7 @@ UniValue getblock(const JSONRPCRequest& request)
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getblock", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\"")
+            + HelpExampleCli("getblock", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\" 2 false")
             + HelpExampleRpc("getblock", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\"")
         );
 
@@ -1017,7 +1021,11 @@ UniValue getblock(const JSONRPCRequest& request)
         return strHex;
     }
 
-    return blockToJSON(block, pblockindex, verbosity >= 2);
+    unsigned int script_fields = SCRIPT_FIELDS_ALL;
+    if (!request.params[2].isNull() && !request.params[2].get_bool())
+        script_fields = 0;
+
+    return blockToJSON(block, pblockindex, verbosity >= 2, script_fields);
 }
 
 UniValue decodeblock(const JSONRPCRequest& request)
@@ -1639,6 +1647,15 @@ UniValue mempoolInfoToJSON()
     ret.push_back(Pair("maxmempool", (int64_t) maxmempool));
     ret.push_back(Pair("mempoolminfee", ValueFromAmount(mempool.GetMinFee(maxmempool).GetFeePerK())));
 
+    COrphanStats orphans;
+    GetOrphanStats(orphans);
+    ret.push_back(Pair("orphans", (int64_t) orphans.nOrphans));
+    ret.push_back(Pair("orphanusage", (int64_t) orphans.nUsage));
+    ret.push_back(Pair("orphansresolved", (int64_t) orphans.nResolved));
+    ret.push_back(Pair("orphansremoved", (int64_t) orphans.nRemoved));
+    ret.push_back(Pair("orphansexpired", (int64_t) orphans.nExpired));
+    ret.push_back(Pair("orphansevicted", (int64_t) orphans.nEvicted));
+
     return ret;
 }
 
@@ -1654,7 +1671,13 @@ UniValue getmempoolinfo(const JSONRPCRequest& request)
             "  \"bytes\": xxxxx,              (numeric) Sum of all virtual transaction sizes as defined in BIP 141. Differs from actual serialized size because witness data is discounted\n"
             "  \"usage\": xxxxx,              (numeric) Total memory usage for the mempool\n"
             "  \"maxmempool\": xxxxx,         (numeric) Maximum memory usage for the mempool\n"
-            "  \"mempoolminfee\": xxxxx       (numeric) Minimum fee rate in " + CURRENCY_UNIT + "/kB for tx to be accepted\n"
+            "  \"mempoolminfee\": xxxxx,      (numeric) Minimum fee rate in " + CURRENCY_UNIT + "/kB for tx to be accepted\n"
+            "  \"orphans\": xxxxx,            (numeric) Current count of transactions waiting for a missing parent\n"
+            "  \"orphanusage\": xxxxx,        (numeric) Memory used by those orphan transactions\n"
+            "  \"orphansresolved\": xxxxx,    (numeric) Orphans accepted to the mempool once their parents arrived\n"
+            "  \"orphansremoved\": xxxxx,     (numeric) Orphans rejected once their parents arrived\n"
+            "  \"orphansexpired\": xxxxx,     (numeric) Orphans dropped after waiting too long\n"
+            "  \"orphansevicted\": xxxxx      (numeric) Orphans evicted to stay within -maxorphantx and -maxorphanpool\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getmempoolinfo", "")
@@ -1902,7 +1925,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getchaintxstats",        &getchaintxstats,        {"nblocks", "blockhash"} },
     { "blockchain",         "getbestblockhash",       &getbestblockhash,       {} },
     { "blockchain",         "getblockcount",          &getblockcount,          {} },
-    { "blockchain",         "getblock",               &getblock,               {"blockhash","verbosity|verbose"} },
+    { "blockchain",         "getblock",               &getblock,               {"blockhash","verbosity|verbose","include_scripts"} },
     { "blockchain",         "decodeblock",            &decodeblock,               {"blockhex"} },
     { "blockchain",         "getblockdeltas",         &getblockdeltas,         {} },
     { "blockchain",         "getblockhashes",         &getblockhashes,         {} },
@@ -5,6 +5,8 @@
 
 #ifndef RAVEN_RPC_BLOCKCHAIN_H
 #define RAVEN_RPC_BLOCKCHAIN_H
+#include "core_io.h"
+
 #include <map>
 #include <string>
 
@@ -28,8 +30,8 @@ double GetDifficulty(const CBlockIndex* blockindex = nullptr);
 /** Callback for when block tip changed. */
 void RPCNotifyBlockChange(bool ibd, const CBlockIndex *);
 
-/** Block description to JSON */
-UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails = false);
+/** Block description to JSON; with txDetails, script_fields picks the script encodings written for each transaction */
+UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails = false, unsigned int script_fields = SCRIPT_FIELDS_ALL);
 UniValue decodeblockToJSON(const CBlock& block);
 
 /** Mempool information to JSON */
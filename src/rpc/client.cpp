@@ -126,10 +126,12 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "listunspent", 4, "query_options" },
     { "getblock", 1, "verbosity" },
     { "getblock", 1, "verbose" },
+    { "getblock", 2, "include_scripts" },
     { "getblockheader", 1, "verbose" },
     { "getchaintxstats", 0, "nblocks" },
     { "gettransaction", 1, "include_watchonly" },
     { "getrawtransaction", 1, "verbose" },
+    { "getrawtransaction", 2, "include_scripts" },
     { "createrawtransaction", 0, "inputs" },
     { "createrawtransaction", 1, "outputs" },
     { "createrawtransaction", 2, "locktime" },
@@ -204,6 +206,8 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "listassetbalancesbyaddress", 2, "count"},
     { "listassetbalancesbyaddress", 3, "start"},
     { "sendmessage", 2, "expire_time"},
+    { "viewallmessages", 0, "from_height"},
+    { "viewallmessages", 2, "limit"},
     { "requestsnapshot", 1, "block_height"},
     { "getsnapshotrequest", 1, "block_height"},
     { "listsnapshotrequests", 1, "block_height"},
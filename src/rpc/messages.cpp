@@ -39,11 +39,18 @@ std::string MessageActivationWarning()
 }
 
 UniValue viewallmessages(const JSONRPCRequest& request) {
-    if (request.fHelp || !AreMessagesDeployed() || request.params.size() != 0)
+    if (request.fHelp || !AreMessagesDeployed() || request.params.size() > 5)
         throw std::runtime_error(
-                "viewallmessages \n"
+                "viewallmessages ( from_height \"channel\" limit \"cursor\" \"status\" )\n"
                 + MessageActivationWarning() +
-                "\nView all messages that the wallet contains\n"
+                "\nView all messages that the wallet contains, ordered by block height\n"
+
+                "\nArguments:\n"
+                "1. \"from_height\"                  (number, optional, default=0) Only show messages included at or above this block height\n"
+                "2. \"channel\"                      (string, optional) Only show messages sent on this channel\n"
+                "3. \"limit\"                        (number, optional, default=0) Show at most this many messages, 0 shows all of them\n"
+                "4. \"cursor\"                       (string, optional) Continue after the position returned as \"Next Cursor\" by an earlier call\n"
+                "5. \"status\"                       (string, optional) Only show messages with this status (READ, UNREAD, ORPHAN, EXPIRED, SPAM, HIDDEN)\n"
 
                 "\nResult:\n"
                 "\"Asset Name:\"                     (string) The name of the asset the message was sent on\n"
@@ -54,10 +61,17 @@ UniValue viewallmessages(const JSONRPCRequest& request) {
                 "\"Expire Time:\"                    (Date, optional) If the message had an expiration date assigned, it will be shown here in the format (YY-mm-dd Hour-minute-second)\n"
                 "\"Expire UTC Time:\"                (Date, optional) If the message contains an expire date that is too large, the UTC number will be displayed\n"
 
+                "\nResult (when limit or cursor is given):\n"
+                "{\n"
+                "  \"Messages\": [ ... ]             (array) The messages, as above\n"
+                "  \"Next Cursor\": \"cursor\"         (string, optional) Pass this as cursor to fetch the next page, absent on the last page\n"
+                "}\n"
 
                 "\nExamples:\n"
                 + HelpExampleCli("viewallmessages", "")
+                + HelpExampleCli("viewallmessages", "0 \"ASSET_NAME~CHANNEL\" 100")
                 + HelpExampleRpc("viewallmessages", "")
+                + HelpExampleRpc("viewallmessages", "1000, \"\", 100")
         );
 
     if (!fMessaging) {
@@ -72,32 +86,58 @@ UniValue viewallmessages(const JSONRPCRequest& request) {
         return ret;
     }
 
-    std::set<CMessage> setMessages;
+    CMessageQuery query;
+
+    if (!request.params[0].isNull()) {
+        int nFromHeight = request.params[0].get_int();
+        if (nFromHeight < 0)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid from_height, must be positive");
+        query.start = CMessageCursor(nFromHeight, COutPoint(uint256(), 0));
+    }
 
-    pmessagedb->LoadMessages(setMessages);
+    if (!request.params[1].isNull())
+        query.strChannel = request.params[1].get_str();
 
-    for (auto pair : mapDirtyMessagesOrphaned) {
-        CMessage message = pair.second;
-        message.status = MessageStatus::ORPHAN;
-        if (setMessages.count(message))
-            setMessages.erase(message);
-        setMessages.insert(message);
+    if (!request.params[2].isNull()) {
+        int nLimit = request.params[2].get_int();
+        if (nLimit < 0)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid limit, must be positive");
+        query.nLimit = nLimit;
     }
 
-    for (auto out : setDirtyMessagesRemove) {
-        CMessage message;
-        message.out = out;
-        setMessages.erase(message);
+    bool fPaged = query.nLimit > 0;
+    if (!request.params[3].isNull() && !request.params[3].get_str().empty()) {
+        CMessageCursor cursor;
+        if (!CMessageCursor::FromString(request.params[3].get_str(), cursor))
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        if (query.start < cursor) {
+            query.start = cursor;
+            query.fAfterStart = true;
+        }
+        fPaged = true;
     }
 
-    for (auto pair : mapDirtyMessagesAdd) {
-        setMessages.erase(pair.second);
-        setMessages.insert(pair.second);
+    if (!request.params[4].isNull() && !request.params[4].get_str().empty()) {
+        query.strStatus = request.params[4].get_str();
+        std::transform(query.strStatus.begin(), query.strStatus.end(), query.strStatus.begin(), ::toupper);
+        bool fValidStatus = false;
+        for (int8_t n = IntFromMessageStatus(MessageStatus::READ); n < IntFromMessageStatus(MessageStatus::MSG_ERROR); n++)
+            fValidStatus |= MessageStatusToString(MessageStatusFromInt(n)) == query.strStatus;
+        if (!fValidStatus)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid status: " + request.params[4].get_str());
     }
 
+    std::vector<CMessage> vMessages;
+    bool fMore;
+    LoadMessages(query, vMessages, fMore);
+
+    // The plain listing has always been ordered by outpoint. Only pages come back in cursor order
+    if (!fPaged)
+        std::sort(vMessages.begin(), vMessages.end());
+
     UniValue messages(UniValue::VARR);
 
-    for (auto message : setMessages) {
+    for (const auto& message : vMessages) {
         UniValue obj(UniValue::VOBJ);
 
         obj.push_back(Pair("Asset Name", message.strName));
@@ -116,8 +156,15 @@ UniValue viewallmessages(const JSONRPCRequest& request) {
         messages.push_back(obj);
     }
 
+    if (!fPaged)
+        return messages;
 
-    return messages;
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("Messages", messages));
+    if (fMore)
+        result.push_back(Pair("Next Cursor", CMessageCursor(vMessages.back()).ToString()));
+
+    return result;
 }
 
 UniValue viewallmessagechannels(const JSONRPCRequest& request) {
@@ -488,7 +535,7 @@ UniValue viewmyrestrictedaddresses(const JSONRPCRequest& request) {
 static const CRPCCommand commands[] =
     {           //  category    name                          actor (function)             argNames
                 //  ----------- ------------------------      -----------------------      ----------
-            { "messages",       "viewallmessages",            &viewallmessages,            {}},
+            { "messages",       "viewallmessages",            &viewallmessages,            {"from_height", "channel", "limit", "cursor", "status"}},
             { "messages",       "viewallmessagechannels",     &viewallmessagechannels,     {}},
             { "messages",       "subscribetochannel",         &subscribetochannel,         {"channel_name"}},
             { "messages",       "unsubscribefromchannel",     &unsubscribefromchannel,     {"channel_name"}},
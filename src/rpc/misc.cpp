@@ -19,6 +19,7 @@
 #include "txmempool.h"
 #include "util.h"
 #include "utilstrencodings.h"
+#include "validationinterface.h"
 #ifdef ENABLE_WALLET
 #include "wallet/rpcwallet.h"
 #include "wallet/wallet.h"
@@ -571,6 +572,45 @@ UniValue getmemoryinfo(const JSONRPCRequest& request)
     }
 }
 
+UniValue getnotificationqueueinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getnotificationqueueinfo\n"
+            "Returns delivery statistics for each validation notification subscriber that has a queue of its own.\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"name\": \"xxxx\",          (string) The subscriber\n"
+            "    \"depth\": n,               (numeric) Notifications waiting to be delivered\n"
+            "    \"maxdepth\": n,            (numeric) Most notifications ever waiting at once\n"
+            "    \"delivered\": n,           (numeric) Notifications delivered\n"
+            "    \"dropped\": n,             (numeric) Transaction, inventory and resend notifications dropped because the queue was full\n"
+            "    \"avglatency\": n,          (numeric) Average time a delivered notification waited, in microseconds\n"
+            "    \"maxlatency\": n           (numeric) Longest a delivered notification waited, in microseconds\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getnotificationqueueinfo", "")
+            + HelpExampleRpc("getnotificationqueueinfo", "")
+        );
+
+    UniValue ret(UniValue::VARR);
+    for (const NotificationQueueInfo& info : GetNotificationQueueInfo()) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("name", info.strName));
+        obj.push_back(Pair("depth", (uint64_t)info.nDepth));
+        obj.push_back(Pair("maxdepth", (uint64_t)info.nMaxDepth));
+        obj.push_back(Pair("delivered", info.nDelivered));
+        obj.push_back(Pair("dropped", info.nDropped));
+        obj.push_back(Pair("avglatency", info.nDelivered ? info.nTotalLatency / (int64_t)info.nDelivered : 0));
+        obj.push_back(Pair("maxlatency", info.nMaxLatency));
+        ret.push_back(obj);
+    }
+    return ret;
+}
+
 uint32_t getCategoryMask(UniValue cats) {
     cats = cats.get_array();
     uint32_t mask = 0;
@@ -1326,6 +1366,7 @@ static const CRPCCommand commands[] =
   //  --------------------- ------------------------  -----------------------  ----------
     { "control",            "getinfo",                &getinfo,                {} }, /* uses wallet if enabled */
     { "control",            "getmemoryinfo",          &getmemoryinfo,          {"mode"} },
+    { "control",            "getnotificationqueueinfo", &getnotificationqueueinfo, {} },
     { "util",               "validateaddress",        &validateaddress,        {"address"} }, /* uses wallet if enabled */
     { "util",               "createmultisig",         &createmultisig,         {"nrequired","keys"} },
     { "util",               "verifymessage",          &verifymessage,          {"address","signature","message"} },
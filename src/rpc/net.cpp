@@ -125,6 +125,8 @@ UniValue getpeerinfo(const JSONRPCRequest& request)
             "       n,                        (numeric) The heights of blocks we're currently asking from this peer\n"
             "       ...\n"
             "    ],\n"
+            "    \"inflight_quota\": n,       (numeric) How many blocks we are willing to have in flight from this peer\n"
+            "    \"block_latency\": n,        (numeric) Average time in seconds this peer took to deliver requested blocks (if measured)\n"
             "    \"whitelisted\": true|false, (boolean) Whether the peer is whitelisted\n"
             "    \"bytessent_per_msg\": {\n"
             "       \"addr\": n,              (numeric) The total bytes sent aggregated by message type\n"
@@ -191,6 +193,9 @@ UniValue getpeerinfo(const JSONRPCRequest& request)
                 heights.push_back(height);
             }
             obj.push_back(Pair("inflight", heights));
+            obj.push_back(Pair("inflight_quota", statestats.nBlockQuota));
+            if (statestats.nAvgBlockLatency > 0)
+                obj.push_back(Pair("block_latency", statestats.nAvgBlockLatency / 1e6));
         }
         obj.push_back(Pair("whitelisted", stats.fWhitelisted));
 
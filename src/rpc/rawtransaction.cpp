@@ -37,14 +37,14 @@
 #include <univalue.h>
 #include <tinyformat.h>
 
-void TxToJSON(const CTransaction& tx, const uint256 hashBlock, UniValue& entry, bool expanded = false)
+void TxToJSON(const CTransaction& tx, const uint256 hashBlock, UniValue& entry, bool expanded = false, unsigned int script_fields = SCRIPT_FIELDS_ALL)
 {
     // Call into TxToUniv() in raven-common to decode the transaction hex.
     //
     // Blockchain contextual information (confirmations and blocktime) is not
     // available to code in raven-common, so we query them here and push the
     // data into the returned UniValue.
-    TxToUniv(tx, uint256(), entry, true, RPCSerializationFlags());
+    TxToUniv(tx, uint256(), entry, script_fields & SCRIPT_FIELD_HEX, RPCSerializationFlags(), script_fields);
 
     if (expanded) {
         uint256 txid = tx.GetHash();
@@ -113,9 +113,9 @@ void TxToJSON(const CTransaction& tx, const uint256 hashBlock, UniValue& entry,
 
 UniValue getrawtransaction(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3)
         throw std::runtime_error(
-            "getrawtransaction \"txid\" ( verbose )\n"
+            "getrawtransaction \"txid\" ( verbose include_scripts )\n"
 
             "\nNOTE: By default this function only works for mempool transactions. If the -txindex option is\n"
             "enabled, it also works for blockchain transactions.\n"
@@ -128,6 +128,7 @@ UniValue getrawtransaction(const JSONRPCRequest& request)
             "\nArguments:\n"
             "1. \"txid\"      (string, required) The transaction id\n"
             "2. verbose       (bool, optional, default=false) If false, return a string, otherwise return a json object\n"
+            "3. include_scripts (bool, optional, default=true) With verbose, false leaves out the asm and hex of every script and the hex of the transaction\n"
 
             "\nResult (if verbose is not set or set to false):\n"
             "\"data\"      (string) The serialized, hex-encoded data for 'txid'\n"
@@ -180,6 +181,7 @@ UniValue getrawtransaction(const JSONRPCRequest& request)
             "\nExamples:\n"
             + HelpExampleCli("getrawtransaction", "\"mytxid\"")
             + HelpExampleCli("getrawtransaction", "\"mytxid\" true")
+            + HelpExampleCli("getrawtransaction", "\"mytxid\" true false")
             + HelpExampleRpc("getrawtransaction", "\"mytxid\", true")
         );
 
@@ -216,8 +218,12 @@ UniValue getrawtransaction(const JSONRPCRequest& request)
     if (!fVerbose)
         return EncodeHexTx(*tx, RPCSerializationFlags());
 
+    unsigned int script_fields = SCRIPT_FIELDS_ALL;
+    if (!request.params[2].isNull() && !request.params[2].get_bool())
+        script_fields = 0;
+
     UniValue result(UniValue::VOBJ);
-    TxToJSON(*tx, hashBlock, result, true);
+    TxToJSON(*tx, hashBlock, result, true, script_fields);
 
     return result;
 }
@@ -2004,7 +2010,18 @@ UniValue signrawtransaction(const JSONRPCRequest& request)
     // Use CTransaction for the constant parts of the
     // transaction to avoid rehashing.
     const CTransaction txConst(mtx);
-    // Sign what we can:
+    // Sign what we can, spread over the script verification threads. Every input is
+    // signed against txConst: the signature hashes don't cover the other inputs' scriptSigs.
+    std::vector<CTxOut> vSpent(mtx.vin.size());
+    for (unsigned int i = 0; i < mtx.vin.size(); i++) {
+        const Coin& coin = view.AccessCoin(mtx.vin[i].prevout);
+        // Only sign SIGHASH_SINGLE if there's a corresponding output:
+        if (!coin.IsSpent() && (!fHashSingle || (i < mtx.vout.size())))
+            vSpent[i] = coin.out;
+    }
+    std::vector<SignatureData> vSigData;
+    ProduceSignatures(keystore, txConst, vSpent, nHashType, vSigData, nScriptCheckThreads);
+
     for (unsigned int i = 0; i < mtx.vin.size(); i++) {
         CTxIn& txin = mtx.vin[i];
         const Coin& coin = view.AccessCoin(txin.prevout);
@@ -2015,11 +2032,7 @@ UniValue signrawtransaction(const JSONRPCRequest& request)
         const CScript& prevPubKey = coin.out.scriptPubKey;
         const CAmount& amount = coin.out.nValue;
 
-        SignatureData sigdata;
-        // Only sign SIGHASH_SINGLE if there's a corresponding output:
-        if (!fHashSingle || (i < mtx.vout.size()))
-            ProduceSignature(MutableTransactionSignatureCreator(&keystore, &mtx, i, amount, nHashType), prevPubKey, sigdata);
-        sigdata = CombineSignatures(prevPubKey, TransactionSignatureChecker(&txConst, i, amount), sigdata, DataFromTransaction(mtx, i));
+        SignatureData sigdata = CombineSignatures(prevPubKey, TransactionSignatureChecker(&txConst, i, amount), vSigData[i], DataFromTransaction(mtx, i));
 
         UpdateTransaction(mtx, i, sigdata);
 
@@ -2203,7 +2216,7 @@ UniValue testmempoolaccept(const JSONRPCRequest& request)
 static const CRPCCommand commands[] =
 { //  category              name                      actor (function)         argNames
   //  --------------------- ------------------------  -----------------------  ----------
-    { "rawtransactions",    "getrawtransaction",      &getrawtransaction,      {"txid","verbose"} },
+    { "rawtransactions",    "getrawtransaction",      &getrawtransaction,      {"txid","verbose","include_scripts"} },
     { "rawtransactions",    "createrawtransaction",   &createrawtransaction,   {"inputs","outputs","locktime"} },
     { "rawtransactions",    "decoderawtransaction",   &decoderawtransaction,   {"hexstring"} },
     { "rawtransactions",    "decodescript",           &decodescript,           {"hexstring"} },
@@ -58,6 +58,21 @@ public:
     {
         return setValid.setup_bytes(n);
     }
+
+    void GetState(uint256& nonceOut, std::vector<uint256>& entries)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_sigcache);
+        nonceOut = nonce;
+        setValid.get_kept(entries);
+    }
+
+    void SetState(const uint256& nonceIn, const std::vector<uint256>& entries)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_sigcache);
+        nonce = nonceIn;
+        for (const uint256& entry : entries)
+            setValid.insert(entry);
+    }
 };
 
 /* In previous versions of this code, signatureCache was a local static variable
@@ -81,6 +96,16 @@ void InitSignatureCache()
             (nElems*sizeof(uint256)) >>20, (nMaxCacheSize*2)>>20, nElems);
 }
 
+void GetSignatureCacheState(uint256& nonce, std::vector<uint256>& entries)
+{
+    signatureCache.GetState(nonce, entries);
+}
+
+void SetSignatureCacheState(const uint256& nonce, const std::vector<uint256>& entries)
+{
+    signatureCache.SetState(nonce, entries);
+}
+
 bool CachingTransactionSignatureChecker::VerifySignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
     uint256 entry;
@@ -19,6 +19,7 @@ static const unsigned int DEFAULT_MAX_SIG_CACHE_SIZE = 32;
 static const int64_t MAX_MAX_SIG_CACHE_SIZE = 16384;
 
 class CPubKey;
+class uint256;
 
 /**
  * We're hashing a nonce into the entries themselves, so we don't need extra
@@ -54,4 +55,10 @@ public:
 
 void InitSignatureCache();
 
+/** Copy out the signature cache's nonce and the entries it still holds, e.g. to save them across restarts. */
+void GetSignatureCacheState(uint256& nonce, std::vector<uint256>& entries);
+/** Restore a saved signature cache. Entries are only meaningful under the nonce they were computed with, so
+ *  this must be called right after InitSignatureCache(), before any signature has been cached. */
+void SetSignatureCacheState(const uint256& nonce, const std::vector<uint256>& entries);
+
 #endif // RAVEN_SCRIPT_SIGCACHE_H
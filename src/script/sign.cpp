@@ -13,6 +13,11 @@
 #include "script/standard.h"
 #include "uint256.h"
 
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 
 typedef std::vector<unsigned char> valtype;
 
@@ -224,6 +229,55 @@ bool ProduceSignature(const BaseSignatureCreator& creator, const CScript& fromPu
     return solved && VerifyScript(sigdata.scriptSig, fromPubKey, &sigdata.scriptWitness, STANDARD_SCRIPT_VERIFY_FLAGS, creator.Checker());
 }
 
+bool ProduceSignatures(const CKeyStore& keystore, const CTransaction& txTo, const std::vector<CTxOut>& vSpent, int nHashType,
+                       std::vector<SignatureData>& vSigData, int nThreads, unsigned int* pnFailedIn)
+{
+    assert(vSpent.size() == txTo.vin.size());
+    const unsigned int nInputs = txTo.vin.size();
+    vSigData.assign(nInputs, SignatureData());
+    // Not std::vector<bool>: threads write neighbouring entries
+    std::vector<char> vComplete(nInputs, true);
+
+    std::atomic<unsigned int> nNext(0);
+    std::exception_ptr error;
+    std::mutex csError;
+    auto worker = [&]() {
+        try {
+            for (unsigned int i = nNext++; i < nInputs; i = nNext++) {
+                if (vSpent[i].IsNull())
+                    continue;
+                TransactionSignatureCreator creator(&keystore, &txTo, i, vSpent[i].nValue, nHashType);
+                vComplete[i] = ProduceSignature(creator, vSpent[i].scriptPubKey, vSigData[i]);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(csError);
+            if (!error)
+                error = std::current_exception();
+            nNext = nInputs;
+        }
+    };
+
+    std::vector<std::thread> vThreads;
+    if (nInputs >= PARALLEL_SIGNING_MIN_INPUTS) {
+        for (int i = 1; i < nThreads && (unsigned int)i < nInputs; i++)
+            vThreads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : vThreads)
+        thread.join();
+    if (error)
+        std::rethrow_exception(error);
+
+    for (unsigned int i = 0; i < nInputs; i++) {
+        if (!vComplete[i]) {
+            if (pnFailedIn)
+                *pnFailedIn = i;
+            return false;
+        }
+    }
+    return true;
+}
+
 SignatureData DataFromTransaction(const CMutableTransaction& tx, unsigned int nIn)
 {
     SignatureData data;
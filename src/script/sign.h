@@ -13,9 +13,13 @@ class CKeyID;
 class CKeyStore;
 class CScript;
 class CTransaction;
+class CTxOut;
 
 struct CMutableTransaction;
 
+/** Transactions with fewer inputs than this are signed on the calling thread only */
+static const unsigned int PARALLEL_SIGNING_MIN_INPUTS = 16;
+
 /** Virtual base class for signature creators. */
 class BaseSignatureCreator {
 protected:
@@ -71,6 +75,16 @@ struct SignatureData {
 /** Produce a script signature using a generic signature creator. */
 bool ProduceSignature(const BaseSignatureCreator& creator, const CScript& scriptPubKey, SignatureData& sigdata);
 
+/**
+ * Produce script signatures for the inputs of txTo, where vSpent[i] is the output spent by input i,
+ * or a null CTxOut for an input to leave unsigned. Each input's signature hash and signature depend
+ * only on txTo and that input, so inputs are spread over up to nThreads threads, each signing into
+ * its own vSigData[i]; the result doesn't depend on which thread signed which input.
+ * Returns false if some input could not be completely signed, setting *pnFailedIn to the first one.
+ */
+bool ProduceSignatures(const CKeyStore& keystore, const CTransaction& txTo, const std::vector<CTxOut>& vSpent, int nHashType,
+                       std::vector<SignatureData>& vSigData, int nThreads, unsigned int* pnFailedIn = nullptr);
+
 /** Produce a script signature for a transaction. */
 bool SignSignature(const CKeyStore &keystore, const CScript& fromPubKey, CMutableTransaction& txTo, unsigned int nIn, const CAmount& amount, int nHashType);
 bool SignSignature(const CKeyStore& keystore, const CTransaction& txFrom, CMutableTransaction& txTo, unsigned int nIn, int nHashType);
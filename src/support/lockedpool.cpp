@@ -48,7 +48,9 @@ Arena::Arena(void *base_in, size_t size_in, size_t alignment_in):
     base(static_cast<char*>(base_in)), end(static_cast<char*>(base_in) + size_in), alignment(alignment_in)
 {
     // Start with one free chunk that covers the entire arena
-    chunks_free.emplace(base, size_in);
+    auto it = size_to_free_chunk.emplace(size_in, base);
+    chunks_free.emplace(base, it);
+    chunks_free_end.emplace(base + size_in, it);
 }
 
 Arena::~Arena()
@@ -64,26 +66,25 @@ void* Arena::alloc(size_t size)
     if (size == 0)
         return nullptr;
 
-    // Pick a large enough free-chunk
-    auto it = std::find_if(chunks_free.begin(), chunks_free.end(),
-        [=](const std::map<char*, size_t>::value_type& chunk){ return chunk.second >= size; });
-    if (it == chunks_free.end())
+    // Pick the smallest free-chunk that is large enough (best-fit)
+    auto size_ptr_it = size_to_free_chunk.lower_bound(size);
+    if (size_ptr_it == size_to_free_chunk.end())
         return nullptr;
 
     // Create the used-chunk, taking its space from the end of the free-chunk
-    auto alloced = chunks_used.emplace(it->first + it->second - size, size).first;
-    if (!(it->second -= size))
-        chunks_free.erase(it);
-    return reinterpret_cast<void*>(alloced->first);
-}
-
-/* extend the Iterator if other begins at its end */
-template <class Iterator, class Pair> bool extend(Iterator it, const Pair& other) {
-    if (it->first + it->second == other.first) {
-        it->second += other.second;
-        return true;
+    const size_t size_remaining = size_ptr_it->first - size;
+    auto alloced = chunks_used.emplace(size_ptr_it->second + size_remaining, size).first;
+    chunks_free_end.erase(size_ptr_it->second + size_ptr_it->first);
+    if (size_remaining == 0) {
+        chunks_free.erase(size_ptr_it->second);
+    } else {
+        auto it_remaining = size_to_free_chunk.emplace(size_remaining, size_ptr_it->second);
+        chunks_free[size_ptr_it->second] = it_remaining;
+        chunks_free_end.emplace(size_ptr_it->second + size_remaining, it_remaining);
     }
-    return false;
+    size_to_free_chunk.erase(size_ptr_it);
+
+    return reinterpret_cast<void*>(alloced->first);
 }
 
 void Arena::free(void *ptr)
@@ -98,16 +99,30 @@ void Arena::free(void *ptr)
     if (i == chunks_used.end()) {
         throw std::runtime_error("Arena: invalid or double free");
     }
-    auto freed = *i;
+    std::pair<char*, size_t> freed = *i;
     chunks_used.erase(i);
 
-    // Add space to free map, coalescing contiguous chunks
-    auto next = chunks_free.upper_bound(freed.first);
-    auto prev = (next == chunks_free.begin()) ? chunks_free.end() : std::prev(next);
-    if (prev == chunks_free.end() || !extend(prev, freed))
-        prev = chunks_free.emplace_hint(next, freed);
-    if (next != chunks_free.end() && extend(prev, *next))
+    // Coalesce with the free chunk ending where this one begins
+    auto prev = chunks_free_end.find(freed.first);
+    if (prev != chunks_free_end.end()) {
+        freed.first -= prev->second->first;
+        freed.second += prev->second->first;
+        size_to_free_chunk.erase(prev->second);
+        chunks_free_end.erase(prev);
+    }
+
+    // Coalesce with the free chunk beginning where this one ends
+    auto next = chunks_free.find(freed.first + freed.second);
+    if (next != chunks_free.end()) {
+        freed.second += next->second->first;
+        size_to_free_chunk.erase(next->second);
         chunks_free.erase(next);
+    }
+
+    // Add the coalesced free chunk
+    auto it = size_to_free_chunk.emplace(freed.second, freed.first);
+    chunks_free[freed.first] = it;
+    chunks_free_end[freed.first + freed.second] = it;
 }
 
 Arena::Stats Arena::stats() const
@@ -116,7 +131,7 @@ Arena::Stats Arena::stats() const
     for (const auto& chunk: chunks_used)
         r.used += chunk.second;
     for (const auto& chunk: chunks_free)
-        r.free += chunk.second;
+        r.free += chunk.second->first;
     r.total = r.used + r.free;
     return r;
 }
@@ -134,7 +149,7 @@ void Arena::walk() const
         printchunk(chunk.first, chunk.second, true);
     std::cout << std::endl;
     for (const auto& chunk: chunks_free)
-        printchunk(chunk.first, chunk.second, false);
+        printchunk(chunk.first, chunk.second->first, false);
     std::cout << std::endl;
 }
 #endif
@@ -259,21 +274,80 @@ size_t PosixLockedPageAllocator::GetLimit()
 // Implementation: LockedPool
 
 LockedPool::LockedPool(std::unique_ptr<LockedPageAllocator> allocator_in, LockingFailed_Callback lf_cb_in):
-    allocator(std::move(allocator_in)), lf_cb(lf_cb_in), cumulative_bytes_locked(0)
+    allocator(std::move(allocator_in)), cached_bytes(0), cached_count(0), lf_cb(lf_cb_in), cumulative_bytes_locked(0)
 {
 }
 
 LockedPool::~LockedPool()
 {
 }
+
 void* LockedPool::alloc(size_t size)
 {
-    std::lock_guard<std::mutex> lock(mutex);
-
     // Don't handle impossible sizes
     if (size == 0 || size > ARENA_SIZE)
         return nullptr;
 
+    if (size > SMALL_CHUNK_MAX)
+        return alloc_locked(size);
+
+    // Small chunks come from the cache when it has one of the right class,
+    // and are tracked in small_chunks either way
+    size_t size_class = (size - 1) / ARENA_ALIGN;
+    size_t class_size = (size_class + 1) * ARENA_ALIGN;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        std::vector<SmallChunkMap::value_type*>& free_chunks = cached_chunks[size_class];
+        if (!free_chunks.empty()) {
+            SmallChunkMap::value_type* chunk = free_chunks.back();
+            free_chunks.pop_back();
+            chunk->second.cached = false;
+            cached_bytes -= class_size;
+            cached_count--;
+            return chunk->first;
+        }
+    }
+
+    char* ptr = static_cast<char*>(alloc_locked(class_size));
+    if (ptr) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        small_chunks[ptr] = SmallChunk{static_cast<uint8_t>(size_class), false};
+    }
+    return ptr;
+}
+
+void LockedPool::free(void *ptr)
+{
+    // Freeing the nullptr pointer is OK.
+    if (ptr == nullptr)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = small_chunks.find(static_cast<char*>(ptr));
+        if (it != small_chunks.end()) {
+            if (it->second.cached)
+                throw std::runtime_error("LockedPool: double free");
+            size_t class_size = (it->second.size_class + 1) * ARENA_ALIGN;
+            if (cached_bytes + class_size <= CACHE_BYTES) {
+                it->second.cached = true;
+                cached_chunks[it->second.size_class].push_back(&*it);
+                cached_bytes += class_size;
+                cached_count++;
+                return;
+            }
+            // The cache is full, give the chunk back to its arena
+            small_chunks.erase(it);
+        }
+    }
+    // Not a small chunk, or not cached; the arena checks the pointer
+    free_locked(ptr);
+}
+
+void* LockedPool::alloc_locked(size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
     // Try allocating from each current arena
     for (auto &arena: arenas) {
         void *addr = arena.alloc(size);
@@ -288,14 +362,15 @@ void* LockedPool::alloc(size_t size)
     return nullptr;
 }
 
-void LockedPool::free(void *ptr)
+void LockedPool::free_locked(void *ptr)
 {
     std::lock_guard<std::mutex> lock(mutex);
-    // TODO we can do better than this linear search by keeping a map of arena
-    // extents to arena, and looking up the address.
-    for (auto &arena: arenas) {
-        if (arena.addressInArena(ptr)) {
-            arena.free(ptr);
+    char* chunk = static_cast<char*>(ptr);
+    auto it = arenas_by_base.upper_bound(chunk);
+    if (it != arenas_by_base.begin()) {
+        Arena* arena = std::prev(it)->second;
+        if (arena->addressInArena(ptr)) {
+            arena->free(ptr);
             return;
         }
     }
@@ -304,6 +379,12 @@ void LockedPool::free(void *ptr)
 
 LockedPool::Stats LockedPool::stats() const
 {
+    size_t bytes, chunks;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        bytes = cached_bytes;
+        chunks = cached_count;
+    }
     std::lock_guard<std::mutex> lock(mutex);
     LockedPool::Stats r{0, 0, 0, cumulative_bytes_locked, 0, 0};
     for (const auto &arena: arenas) {
@@ -314,6 +395,10 @@ LockedPool::Stats LockedPool::stats() const
         r.chunks_used += i.chunks_used;
         r.chunks_free += i.chunks_free;
     }
+    r.used -= bytes;
+    r.free += bytes;
+    r.chunks_used -= chunks;
+    r.chunks_free += chunks;
     return r;
 }
 
@@ -343,6 +428,7 @@ bool LockedPool::new_arena(size_t size, size_t align)
         }
     }
     arenas.emplace_back(allocator.get(), addr, size, align);
+    arenas_by_base.emplace(static_cast<char*>(addr), &arenas.back());
     return true;
 }
 
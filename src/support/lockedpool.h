@@ -11,6 +11,9 @@
 #include <map>
 #include <mutex>
 #include <memory>
+#include <unordered_map>
+#include <vector>
+#include <unordered_map>
 
 /**
  * OS-dependent allocation and deallocation of locked/pinned memory pages.
@@ -89,11 +92,20 @@ public:
      */
     bool addressInArena(void *ptr) const { return ptr >= base && ptr < end; }
 private:
-    /** Map of chunk address to chunk information. This class makes use of the
-     * sorted order to merge previous and next chunks during deallocation.
+    typedef std::multimap<size_t, char*> SizeToChunkSortedMap;
+    /** Free chunks sorted by size, so the best fit is found in O(log n) */
+    SizeToChunkSortedMap size_to_free_chunk;
+
+    typedef std::unordered_map<char*, SizeToChunkSortedMap::const_iterator> ChunkToSizeMap;
+    /** Map from the begin of a free chunk to its node in size_to_free_chunk */
+    ChunkToSizeMap chunks_free;
+    /** Map from the end of a free chunk to its node in size_to_free_chunk,
+     * so a chunk being freed finds the free chunk before it to merge with.
      */
-    std::map<char*, size_t> chunks_free;
-    std::map<char*, size_t> chunks_used;
+    ChunkToSizeMap chunks_free_end;
+
+    /** Map from the begin of a used chunk to its size */
+    std::unordered_map<char*, size_t> chunks_used;
     /** Base address of arena */
     char* base;
     /** End address of arena */
@@ -128,7 +140,14 @@ public:
      * memory, setting it too low will facilitate fragmentation.
      */
     static const size_t ARENA_ALIGN = 16;
-
+    /** Largest allocation served from the small chunk cache. Secure allocations
+     * are mostly keys, hashes and short strings well below this.
+     */
+    static const size_t SMALL_CHUNK_MAX = 256;
+    /** Most bytes of freed small chunks the cache keeps, which limits how much
+     * locked memory sits idle in it.
+     */
+    static const size_t CACHE_BYTES = 8192;
     /** Callback when allocation succeeds but locking fails.
      */
     typedef bool (*LockingFailed_Callback)();
@@ -169,11 +188,42 @@ public:
      */
     void free(void *ptr);
 
-    /** Get pool usage statistics */
+    /** Get pool usage statistics. Chunks held in the small chunk cache
+     * count as free.
+     */
     Stats stats() const;
 private:
     std::unique_ptr<LockedPageAllocator> allocator;
 
+    static const size_t SMALL_CLASSES = SMALL_CHUNK_MAX / ARENA_ALIGN;
+
+    /** State of a small chunk handed out by the pool */
+    struct SmallChunk
+    {
+        uint8_t size_class;
+        bool cached;
+    };
+    typedef std::unordered_map<char*, SmallChunk> SmallChunkMap;
+
+    /** Every small chunk handed out or cached. This is how free() learns the
+     * size of a small chunk, and catches a double free of a cached one.
+     */
+    SmallChunkMap small_chunks;
+    /** Freed small chunks kept for reuse, segregated by size class. Chunks in
+     * here are still used as far as their arena is concerned.
+     */
+    std::vector<SmallChunkMap::value_type*> cached_chunks[SMALL_CLASSES];
+    size_t cached_bytes;
+    size_t cached_count;
+    /** Mutex protects the small chunk cache. It is never held together with
+     * the pool mutex, so a cache hit doesn't wait for arena work.
+     */
+    mutable std::mutex cache_mutex;
+
+    /** Allocate and free under the pool mutex, bypassing the cache */
+    void* alloc_locked(size_t size);
+    void free_locked(void *ptr);
+
     /** Create an arena from locked pages */
     class LockedPageArena: public Arena
     {
@@ -189,6 +239,8 @@ private:
     bool new_arena(size_t size, size_t align);
 
     std::list<LockedPageArena> arenas;
+    /** Arenas by base address, to find the owner of a chunk being freed */
+    std::map<char*, LockedPageArena*> arenas_by_base;
     LockingFailed_Callback lf_cb;
     size_t cumulative_bytes_locked;
     /** Mutex protects access to this pool's data structures, including arenas.
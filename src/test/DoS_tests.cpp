@@ -18,6 +18,7 @@
 #include "test/test_raven.h"
 
 #include <stdint.h>
+#include <limits>
 
 #include <boost/test/unit_test.hpp>
 
@@ -26,15 +27,19 @@ extern bool AddOrphanTx(const CTransactionRef &tx, NodeId peer);
 
 extern void EraseOrphansFor(NodeId peer);
 
-extern unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans);
+extern unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans, size_t nMaxOrphanUsage);
 
 struct COrphanTx
 {
     CTransactionRef tx;
     NodeId fromPeer;
     int64_t nTimeExpire;
+    size_t nUsage;
 };
 extern std::map<uint256, COrphanTx> mapOrphanTransactions;
+extern size_t nOrphanTxUsage;
+
+static const size_t NO_ORPHAN_USAGE_LIMIT = std::numeric_limits<size_t>::max();
 
 CService ip(uint32_t i)
 {
@@ -274,12 +279,77 @@ BOOST_FIXTURE_TEST_SUITE(DoS_tests, TestingSetup)
         }
 
         // Test LimitOrphanTxSize() function:
-        LimitOrphanTxSize(40);
+        LimitOrphanTxSize(40, NO_ORPHAN_USAGE_LIMIT);
         BOOST_CHECK(mapOrphanTransactions.size() <= 40);
-        LimitOrphanTxSize(10);
+        LimitOrphanTxSize(10, NO_ORPHAN_USAGE_LIMIT);
         BOOST_CHECK(mapOrphanTransactions.size() <= 10);
-        LimitOrphanTxSize(0);
+        LimitOrphanTxSize(0, NO_ORPHAN_USAGE_LIMIT);
+        BOOST_CHECK(mapOrphanTransactions.empty());
+        BOOST_CHECK_EQUAL(nOrphanTxUsage, 0U);
+    }
+
+    BOOST_AUTO_TEST_CASE(DoS_orphan_chain_eviction_test)
+    {
+        BOOST_TEST_MESSAGE("Running DoS Orphan Chain Eviction Test");
+
+        // Peer 1 relays a chain of 30 transfers whose first parent has not arrived yet
+        std::vector<CTransactionRef> vChain;
+        uint256 hashPrev = InsecureRand256();
+        for (int i = 0; i < 30; i++)
+        {
+            CMutableTransaction tx;
+            tx.vin.resize(1);
+            tx.vin[0].prevout = COutPoint(hashPrev, 0);
+            tx.vin[0].scriptSig << OP_1;
+            tx.vout.resize(1);
+            tx.vout[0].nValue = 1 * CENT;
+            tx.vout[0].scriptPubKey = CScript() << OP_1;
+            vChain.push_back(MakeTransactionRef(tx));
+            hashPrev = tx.GetHash();
+        }
+        // Delivered out of order, tail first
+        for (auto it = vChain.rbegin(); it != vChain.rend(); ++it)
+            BOOST_CHECK(AddOrphanTx(*it, 1));
+
+        // Peer 2 floods unrelated orphans of the same size
+        for (int i = 0; i < 60; i++)
+        {
+            CMutableTransaction tx;
+            tx.vin.resize(1);
+            tx.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+            tx.vin[0].scriptSig << OP_1;
+            tx.vout.resize(1);
+            tx.vout[0].nValue = 1 * CENT;
+            tx.vout[0].scriptPubKey = CScript() << OP_1;
+            BOOST_CHECK(AddOrphanTx(MakeTransactionRef(tx), 2));
+        }
+        BOOST_CHECK_EQUAL(mapOrphanTransactions.size(), 90U);
+
+        // Eviction takes from the peer using the most memory, leaving the chain whole
+        BOOST_CHECK_EQUAL(LimitOrphanTxSize(60, NO_ORPHAN_USAGE_LIMIT), 30U);
+        for (const CTransactionRef& tx : vChain)
+            BOOST_CHECK(mapOrphanTransactions.count(tx->GetHash()));
+
+        // Once the chain's peer must give up orphans too, its chain is trimmed from the tail
+        LimitOrphanTxSize(40, NO_ORPHAN_USAGE_LIMIT);
+        BOOST_CHECK_EQUAL(mapOrphanTransactions.size(), 40U);
+        size_t nChainLeft = 0;
+        while (nChainLeft < vChain.size() && mapOrphanTransactions.count(vChain[nChainLeft]->GetHash()))
+            nChainLeft++;
+        BOOST_CHECK(nChainLeft >= 15 && nChainLeft < vChain.size());
+        for (size_t i = nChainLeft; i < vChain.size(); i++)
+            BOOST_CHECK(!mapOrphanTransactions.count(vChain[i]->GetHash()));
+
+        // The memory limit is enforced as well as the count
+        size_t nUsagePerOrphan = nOrphanTxUsage / mapOrphanTransactions.size();
+        LimitOrphanTxSize(1000, nUsagePerOrphan * 20);
+        BOOST_CHECK(nOrphanTxUsage <= nUsagePerOrphan * 20);
+        BOOST_CHECK(mapOrphanTransactions.size() <= 20);
+
+        EraseOrphansFor(1);
+        EraseOrphansFor(2);
         BOOST_CHECK(mapOrphanTransactions.empty());
+        BOOST_CHECK_EQUAL(nOrphanTxUsage, 0U);
     }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,14 +2,17 @@
 // Copyright (c) 2017-2019 The Raven Core developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "addrdb.h"
 #include "addrman.h"
 #include "test/test_raven.h"
 #include <string>
 #include <boost/test/unit_test.hpp>
 
+#include "clientversion.h"
 #include "hash.h"
 #include "netbase.h"
 #include "random.h"
+#include "streams.h"
 
 class CAddrManTest : public CAddrMan
 {
@@ -226,6 +229,208 @@ BOOST_FIXTURE_TEST_SUITE(addrman_tests, BasicTestingSetup)
         BOOST_CHECK_EQUAL(ports.size(), (uint64_t)3);
     }
 
+    BOOST_AUTO_TEST_CASE(addrman_select_many_test)
+    {
+        CAddrManTest addrman;
+
+        // Spread addresses over many buckets of both tables
+        std::vector<CAddress> vAddr;
+        for (unsigned int i = 1; i <= 1000; i++) {
+            CAddress addr(ResolveService("250." + std::to_string(i % 250) + "." + std::to_string(i / 250) + ".1"), NODE_NONE);
+            addr.nTime = GetAdjustedTime();
+            addrman.Add(addr, ResolveIP("252." + std::to_string(i % 64) + ".1.1"));
+            vAddr.push_back(addr);
+        }
+        for (size_t i = 0; i < vAddr.size(); i += 4)
+            addrman.Good(vAddr[i]);
+        BOOST_CHECK(addrman.size() > 900);
+
+        std::set<std::string> setSelected;
+        for (int i = 0; i < 500; i++) {
+            CAddrInfo info = addrman.Select();
+            BOOST_CHECK(addrman.Find(info) != nullptr);
+            setSelected.insert(info.ToString());
+
+            CAddrInfo infoNew = addrman.Select(true);
+            BOOST_CHECK(addrman.Find(infoNew) != nullptr);
+        }
+        BOOST_CHECK(setSelected.size() > 300);
+    }
+
+    BOOST_AUTO_TEST_CASE(addrman_changes_roundtrip_test)
+    {
+        CAddrManTest addrman;
+        CNetAddr source = ResolveIP("252.2.2.2");
+
+        for (unsigned int i = 1; i <= 50; i++)
+            addrman.Add(CAddress(ResolveService("250." + std::to_string(i) + ".1.1"), NODE_NONE), source);
+        std::vector<CAddrLogEntry> vChanges;
+        addrman.TakeChanges(vChanges);
+        // Addresses evicted by collisions while filling the table are logged as deleted
+        size_t nUpserts = std::count_if(vChanges.begin(), vChanges.end(), [](const CAddrLogEntry& entry) { return !entry.fDeleted; });
+        BOOST_CHECK_EQUAL(nUpserts, addrman.size());
+
+        CDataStream ssSnapshot(SER_DISK, CLIENT_VERSION);
+        ssSnapshot << addrman;
+        addrman.TakeChanges(vChanges);
+        BOOST_CHECK(vChanges.empty());
+
+        // Change some entries and add a few more after the snapshot
+        for (unsigned int i = 1; i <= 10; i++)
+            addrman.Good(ResolveService("250." + std::to_string(i) + ".1.1"));
+        for (unsigned int i = 11; i <= 20; i++)
+            addrman.Attempt(ResolveService("250." + std::to_string(i) + ".1.1"), true);
+        for (unsigned int i = 1; i <= 5; i++)
+            addrman.Add(CAddress(ResolveService("251." + std::to_string(i) + ".1.1"), NODE_NONE), source);
+
+        addrman.TakeChanges(vChanges);
+        BOOST_CHECK_EQUAL(vChanges.size(), 25U);
+        CDataStream ssLog(SER_DISK, CLIENT_VERSION);
+        ssLog << vChanges;
+
+        // Replaying the log over the snapshot gets back to the same state
+        CAddrManTest addrman2;
+        ssSnapshot >> addrman2;
+        std::vector<CAddrLogEntry> vRead;
+        ssLog >> vRead;
+        addrman2.ApplyChanges(vRead);
+
+        BOOST_CHECK_EQUAL(addrman2.size(), addrman.size());
+        addrman2.TakeChanges(vRead);
+        BOOST_CHECK(vRead.empty());
+
+        // Touch the same entries to read back their state from the restored table
+        for (const CAddrLogEntry& entry : vChanges) {
+            BOOST_REQUIRE(addrman2.Find(entry.info) != nullptr);
+            addrman2.SetServices(entry.info, entry.info.nServices);
+        }
+        addrman2.TakeChanges(vRead);
+        BOOST_REQUIRE_EQUAL(vRead.size(), vChanges.size());
+        std::map<std::string, std::string> mapRestored;
+        for (const CAddrLogEntry& entry : vRead) {
+            CDataStream ss(SER_DISK, CLIENT_VERSION);
+            ss << entry;
+            mapRestored[entry.info.ToString()] = ss.str();
+        }
+        for (const CAddrLogEntry& entry : vChanges) {
+            CDataStream ss(SER_DISK, CLIENT_VERSION);
+            ss << entry;
+            BOOST_CHECK(mapRestored[entry.info.ToString()] == ss.str());
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(addrman_changes_tombstone_test)
+    {
+        CAddrManTest addrman;
+        CNetAddr source = ResolveIP("252.2.2.2");
+
+        for (unsigned int i = 1; i < 18; i++)
+            addrman.Add(CAddress(ResolveService("250.1.1." + std::to_string(i)), NODE_NONE), source);
+        CDataStream ssSnapshot(SER_DISK, CLIENT_VERSION);
+        ssSnapshot << addrman;
+        std::vector<CAddrLogEntry> vChanges;
+        addrman.TakeChanges(vChanges);
+
+        // A new table collision deletes an address from the snapshot
+        addrman.Add(CAddress(ResolveService("250.1.1.18"), NODE_NONE), source);
+        BOOST_CHECK_EQUAL(addrman.size(), 17U);
+        std::string strDeleted;
+        for (unsigned int i = 1; i < 18; i++) {
+            if (!addrman.Find(ResolveService("250.1.1." + std::to_string(i))))
+                strDeleted = "250.1.1." + std::to_string(i);
+        }
+        BOOST_REQUIRE(!strDeleted.empty());
+
+        addrman.TakeChanges(vChanges);
+        BOOST_REQUIRE_EQUAL(vChanges.size(), 2U);
+        BOOST_CHECK(vChanges[0].fDeleted);
+        BOOST_CHECK(!vChanges[1].fDeleted);
+
+        // Changes handed back after a failed write are taken again, as they are now
+        addrman.ReturnChanges(vChanges);
+        std::vector<CAddrLogEntry> vRetaken;
+        addrman.TakeChanges(vRetaken);
+        BOOST_REQUIRE_EQUAL(vRetaken.size(), vChanges.size());
+        for (size_t i = 0; i < vChanges.size(); i++) {
+            BOOST_CHECK(vRetaken[i].fDeleted == vChanges[i].fDeleted);
+            BOOST_CHECK(vRetaken[i].info == vChanges[i].info);
+        }
+
+        // The tombstone keeps replay from bringing the deleted address back
+        CAddrManTest addrman2;
+        ssSnapshot >> addrman2;
+        BOOST_CHECK_EQUAL(addrman2.size(), 17U);
+        addrman2.ApplyChanges(vChanges);
+        BOOST_CHECK_EQUAL(addrman2.size(), 17U);
+        BOOST_CHECK(addrman2.Find(ResolveService(strDeleted)) == nullptr);
+        BOOST_CHECK(addrman2.Find(ResolveService("250.1.1.18")) != nullptr);
+
+        // An address deleted and added again is replayed as added
+        addrman.Add(CAddress(ResolveService(strDeleted), NODE_NONE), source);
+        BOOST_REQUIRE(addrman.Find(ResolveService(strDeleted)) != nullptr);
+        addrman.TakeChanges(vChanges);
+        addrman2.ApplyChanges(vChanges);
+        BOOST_CHECK_EQUAL(addrman2.size(), addrman.size());
+        BOOST_CHECK(addrman2.Find(ResolveService(strDeleted)) != nullptr);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(addrman_changes_log_file_test, TestingSetup)
+    {
+        CAddrManTest addrman;
+        CNetAddr source = ResolveIP("252.2.2.2");
+        CService addrTried = ResolveService("250.1.1.1");
+        const fs::path pathLog = GetDataDir() / "peers.log";
+        const fs::path pathStale = GetDataDir() / "peers.log.stale";
+
+        for (unsigned int i = 1; i < 18; i++)
+            addrman.Add(CAddress(ResolveService("250.1.1." + std::to_string(i)), NODE_NONE), source);
+        CAddrDB adb;
+        BOOST_CHECK(adb.Write(addrman));
+        BOOST_CHECK(!fs::exists(pathLog));
+
+        addrman.Attempt(addrTried, true);
+        addrman.Add(CAddress(ResolveService("250.1.1.18"), NODE_NONE), source);
+        BOOST_CHECK(adb.Append(addrman));
+        BOOST_CHECK(fs::exists(pathLog));
+
+        {
+            CAddrManTest addrman2;
+            BOOST_CHECK(adb.Read(addrman2));
+            BOOST_CHECK_EQUAL(addrman2.size(), addrman.size());
+            CAddrInfo* pinfo = addrman2.Find(addrTried);
+            BOOST_REQUIRE(pinfo != nullptr);
+            BOOST_CHECK(SerializeHash(*pinfo) == SerializeHash(*addrman.Find(addrTried)));
+        }
+
+        // A crash between writing the snapshot and removing the log leaves batches for the previous snapshot
+        fs::copy_file(pathLog, pathStale);
+        addrman.Good(addrTried);
+        BOOST_CHECK(adb.Write(addrman));
+        BOOST_CHECK(!fs::exists(pathLog));
+        fs::rename(pathStale, pathLog);
+
+        // They are skipped, instead of setting the entry back to its older state
+        {
+            CAddrManTest addrman2;
+            BOOST_CHECK(adb.Read(addrman2));
+            BOOST_CHECK_EQUAL(addrman2.size(), addrman.size());
+            CAddrInfo* pinfo = addrman2.Find(addrTried);
+            BOOST_REQUIRE(pinfo != nullptr);
+            BOOST_CHECK(SerializeHash(*pinfo) == SerializeHash(*addrman.Find(addrTried)));
+        }
+
+        // Batches appended for the new snapshot after the stale ones are still replayed
+        addrman.Add(CAddress(ResolveService("251.1.1.1"), NODE_NONE), source);
+        BOOST_CHECK(adb.Append(addrman));
+        {
+            CAddrManTest addrman2;
+            BOOST_CHECK(adb.Read(addrman2));
+            BOOST_CHECK_EQUAL(addrman2.size(), addrman.size());
+            BOOST_CHECK(addrman2.Find(ResolveService("251.1.1.1")) != nullptr);
+            BOOST_CHECK(SerializeHash(*addrman2.Find(addrTried)) == SerializeHash(*addrman.Find(addrTried)));
+        }
+    }
+
     BOOST_AUTO_TEST_CASE(addrman_new_collisions_test)
     {
         BOOST_TEST_MESSAGE("Running Addrman New Collisions Test");
@@ -8,6 +8,8 @@
 #include "support/allocators/secure.h"
 #include "test/test_raven.h"
 
+#include <thread>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_FIXTURE_TEST_SUITE(allocator_tests, BasicTestingSetup)
@@ -221,6 +223,79 @@ BOOST_FIXTURE_TEST_SUITE(allocator_tests, BasicTestingSetup)
         BOOST_CHECK(pool.stats().used == 0);
     }
 
+    BOOST_AUTO_TEST_CASE(lockedpool_small_chunk_test)
+    {
+        BOOST_TEST_MESSAGE("Running LockedPool Small Chunk Test");
+
+        std::unique_ptr<LockedPageAllocator> x(new TestLockedPageAllocator(1, 1));
+        LockedPool pool(std::move(x));
+
+        // A freed small chunk is reused for the next allocation of its size class
+        void *a0 = pool.alloc(16);
+        BOOST_CHECK(a0);
+        BOOST_CHECK(pool.stats().used == 16);
+        pool.free(a0);
+        BOOST_CHECK(pool.stats().used == 0);
+        BOOST_CHECK_EQUAL(pool.stats().chunks_used, (uint64_t)0);
+        void *a1 = pool.alloc(9);
+        BOOST_CHECK(a1 == a0);
+        pool.free(a1);
+        try
+        { // Test exception on double-free of a cached chunk
+            pool.free(a1);
+            BOOST_CHECK(0);
+        } catch (std::runtime_error &)
+        {
+        }
+
+        void *b0 = pool.alloc(100);
+        pool.free(b0);
+        void *b1 = pool.alloc(112);
+        BOOST_CHECK(b1 == b0);
+        pool.free(b1);
+
+        // More freed chunks than the cache keeps go back to the arena
+        std::vector<void *> addr;
+        for (int n = 0; n < 1000; n++)
+            addr.push_back(pool.alloc(1 + n % LockedPool::SMALL_CHUNK_MAX));
+        BOOST_CHECK(pool.stats().used > LockedPool::CACHE_BYTES);
+        for (void *ptr: addr)
+            pool.free(ptr);
+        addr.clear();
+        BOOST_CHECK(pool.stats().used == 0);
+        BOOST_CHECK(pool.stats().free == pool.stats().total);
+
+        // Chunks may be freed by another thread than the one that allocated them
+        std::vector<std::thread> threads;
+        std::vector<std::vector<void *>> vAddr(4);
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&pool, &vAddr, t] {
+                for (int n = 0; n < 1000; n++) {
+                    std::vector<void *>& mine = vAddr[t];
+                    if (n % 3 == 2 && !mine.empty()) {
+                        pool.free(mine.back());
+                        mine.pop_back();
+                    } else {
+                        mine.push_back(pool.alloc(1 + (n * 37 + t) % 300));
+                    }
+                }
+            });
+        }
+        for (std::thread& thread: threads)
+            thread.join();
+        threads.clear();
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&pool, &vAddr, t] {
+                for (void *ptr: vAddr[(t + 1) % 4])
+                    pool.free(ptr);
+            });
+        }
+        for (std::thread& thread: threads)
+            thread.join();
+        BOOST_CHECK(pool.stats().used == 0);
+        BOOST_CHECK(pool.stats().free == pool.stats().total);
+    }
+
 // These tests used the live LockedPoolManager object, this is also used
 // by other tests so the conditions are somewhat less controllable and thus the
 // tests are somewhat more error-prone.
@@ -417,6 +417,13 @@ BOOST_FIXTURE_TEST_SUITE(arith_uint256_tests, BasicTestingSetup)
         BOOST_CHECK(R2L / MaxL == ZeroL);
         BOOST_CHECK(MaxL / R2L == 1);
         BOOST_CHECK_THROW(R2L / ZeroL, uint_error);
+
+        for (uint32_t d : {1u, 2u, 3u, 180u, 181u, 0xECD75171u, 0xffffffffu}) {
+            BOOST_CHECK(arith_uint256(R1L).DivideBy(d) == R1L / d);
+            BOOST_CHECK(arith_uint256(R2L).DivideBy(d) == R2L / d);
+            BOOST_CHECK(arith_uint256(MaxL).DivideBy(d) == MaxL / d);
+        }
+        BOOST_CHECK_THROW(arith_uint256(R1L).DivideBy(0), uint_error);
     }
 
 
@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <assets/assetdb.h>
 #include <assets/assets.h>
 
 #include <test/test_raven.h>
@@ -730,5 +731,125 @@ BOOST_FIXTURE_TEST_SUITE(asset_tests, BasicTestingSetup)
         BOOST_CHECK_MESSAGE(!txWithDoubleFee.CheckAddingTagBurnFee(1), "CheckAddingTagBurnFee: Test 3 Didn't fail with double burn fee");
     }
 
+    BOOST_FIXTURE_TEST_CASE(address_dir_test, TestingSetup)
+    {
+        BOOST_TEST_MESSAGE("Running Address Dir Test");
+
+        CAssetsDB db(1 << 20, true, true);
+        const std::string strAddress = "RXissueAssetXXXXXXXXXXXXXXXXXhhZGt";
+        const std::string strNeighbour = "RXissueAssetXXXXXXXXXXXXXXXXXhhZGu";
+
+        for (int i = 0; i < 6; i++)
+            BOOST_CHECK(db.WriteAddressAssetQuantity(strAddress, "ASSET" + std::to_string(i), (i + 1) * COIN));
+        BOOST_CHECK(db.WriteAddressAssetQuantity(strNeighbour, "ASSET0", COIN));
+        // Updating a holding or erasing a missing one leaves the count alone
+        BOOST_CHECK(db.WriteAddressAssetQuantity(strAddress, "ASSET2", 10 * COIN));
+        BOOST_CHECK(db.EraseAddressAssetQuantity(strAddress, "ASSET9"));
+        BOOST_CHECK(db.EraseAddressAssetQuantity(strAddress, "ASSET5"));
+
+        int nTotal = 0;
+        std::vector<std::pair<std::string, CAmount> > vecAmounts;
+        BOOST_CHECK(db.AddressDir(vecAmounts, nTotal, true, strAddress, INT_MAX, 0));
+        BOOST_CHECK_EQUAL(nTotal, 5);
+        BOOST_CHECK(db.AddressDir(vecAmounts, nTotal, true, strNeighbour, INT_MAX, 0));
+        BOOST_CHECK_EQUAL(nTotal, 1);
+        BOOST_CHECK(db.AddressDir(vecAmounts, nTotal, true, "RNoAssetsHere", INT_MAX, 0));
+        BOOST_CHECK_EQUAL(nTotal, 0);
+
+        BOOST_CHECK(db.AddressDir(vecAmounts, nTotal, false, strAddress, 2, 1));
+        BOOST_REQUIRE_EQUAL(vecAmounts.size(), 2U);
+        BOOST_CHECK_EQUAL(vecAmounts[0].first, "ASSET1");
+        BOOST_CHECK_EQUAL(vecAmounts[1].first, "ASSET2");
+        BOOST_CHECK_EQUAL(vecAmounts[1].second, 10 * COIN);
+
+        // Negative starts count back from the address's last holding, not the database's
+        vecAmounts.clear();
+        BOOST_CHECK(db.AddressDir(vecAmounts, nTotal, false, strAddress, INT_MAX, -2));
+        BOOST_REQUIRE_EQUAL(vecAmounts.size(), 2U);
+        BOOST_CHECK_EQUAL(vecAmounts[0].first, "ASSET3");
+        BOOST_CHECK_EQUAL(vecAmounts[1].first, "ASSET4");
+
+        vecAmounts.clear();
+        BOOST_CHECK(db.AddressDir(vecAmounts, nTotal, false, strNeighbour, INT_MAX, -1));
+        BOOST_REQUIRE_EQUAL(vecAmounts.size(), 1U);
+        BOOST_CHECK_EQUAL(vecAmounts[0].first, "ASSET0");
+
+        vecAmounts.clear();
+        BOOST_CHECK(db.AddressDir(vecAmounts, nTotal, false, strAddress, INT_MAX, -6));
+        BOOST_CHECK(vecAmounts.empty());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(flush_batch_test, TestingSetup)
+    {
+        BOOST_TEST_MESSAGE("Running Flush Batch Test");
+
+        CAssetsDB db(1 << 20, true, true);
+        const std::string strAddress = "RXissueAssetXXXXXXXXXXXXXXXXXhhZGt";
+        BOOST_CHECK(db.WriteAddressAssetQuantity(strAddress, "ASSET0", COIN));
+
+        // Nothing reaches the database before the commit, but the holding counts follow every write
+        db.BeginFlushBatch();
+        BOOST_CHECK(db.WriteAddressAssetQuantity(strAddress, "ASSET1", COIN));
+        BOOST_CHECK(db.WriteAddressAssetQuantity(strAddress, "ASSET1", 2 * COIN));
+        BOOST_CHECK(db.WriteAddressAssetQuantity(strAddress, "ASSET2", COIN));
+        BOOST_CHECK(db.EraseAddressAssetQuantity(strAddress, "ASSET0"));
+        BOOST_CHECK(db.EraseAddressAssetQuantity(strAddress, "ASSET0"));
+        BOOST_CHECK(db.WriteAssetAddressQuantity("ASSET1", strAddress, 2 * COIN));
+
+        CAmount nAmount;
+        int nCount = 0;
+        BOOST_CHECK(!db.ReadAddressAssetQuantity(strAddress, "ASSET1", nAmount));
+        BOOST_CHECK(!db.ReadAssetAddressQuantity("ASSET1", strAddress, nAmount));
+        BOOST_CHECK(db.ReadAddressHoldingCount(strAddress, nCount));
+        BOOST_CHECK_EQUAL(nCount, 1);
+
+        BOOST_CHECK(db.CommitFlushBatch());
+        BOOST_CHECK(db.ReadAddressAssetQuantity(strAddress, "ASSET1", nAmount));
+        BOOST_CHECK_EQUAL(nAmount, 2 * COIN);
+        BOOST_CHECK(db.ReadAssetAddressQuantity("ASSET1", strAddress, nAmount));
+        BOOST_CHECK(!db.ReadAddressAssetQuantity(strAddress, "ASSET0", nAmount));
+        BOOST_CHECK(db.ReadAddressHoldingCount(strAddress, nCount));
+        BOOST_CHECK_EQUAL(nCount, 2);
+
+        // An aborted batch leaves no trace, in the database or in the counts
+        db.BeginFlushBatch();
+        BOOST_CHECK(db.WriteAddressAssetQuantity(strAddress, "ASSET3", COIN));
+        db.AbortFlushBatch();
+        BOOST_CHECK(db.WriteAddressAssetQuantity(strAddress, "ASSET4", COIN));
+        BOOST_CHECK(!db.ReadAddressAssetQuantity(strAddress, "ASSET3", nAmount));
+        BOOST_CHECK(db.ReadAddressHoldingCount(strAddress, nCount));
+        BOOST_CHECK_EQUAL(nCount, 3);
+
+        // Undo data held back is read from memory until it is written
+        uint256 hashBlock = InsecureRand256();
+        CBlockAssetUndo undo{true, false, "QmacSRmrkVmvJfbCpmU6pK72furJ8E8fbKHindrLxmYMQo", 0, ASSET_UNDO_INCLUDES_VERIFIER_STRING, false, ""};
+        std::vector<std::pair<std::string, CBlockAssetUndo> > vUndo = {std::make_pair("ASSET1", undo)};
+        BOOST_CHECK_EQUAL(db.PendingBlockUndoDynamicMemoryUsage(), 0U);
+        db.AddPendingBlockUndoAssetData(hashBlock, vUndo);
+
+        // Its memory counts towards the cache size that makes FlushStateToDisk write it, once per block
+        size_t nUsage = db.PendingBlockUndoDynamicMemoryUsage();
+        BOOST_CHECK(nUsage > undo.strIPFS.size());
+        db.AddPendingBlockUndoAssetData(hashBlock, vUndo);
+        BOOST_CHECK_EQUAL(db.PendingBlockUndoDynamicMemoryUsage(), nUsage);
+        db.AddPendingBlockUndoAssetData(InsecureRand256(), vUndo);
+        BOOST_CHECK_EQUAL(db.PendingBlockUndoDynamicMemoryUsage(), 2 * nUsage);
+
+        std::vector<std::pair<std::string, CBlockAssetUndo> > vRead;
+        BOOST_CHECK(db.ReadBlockUndoAssetData(hashBlock, vRead));
+        BOOST_REQUIRE_EQUAL(vRead.size(), 1U);
+        BOOST_CHECK_EQUAL(vRead[0].second.strIPFS, undo.strIPFS);
+        BOOST_CHECK(!db.Exists(std::make_pair('U', hashBlock)));
+
+        BOOST_CHECK(db.WritePendingBlockUndoAssetData());
+        BOOST_CHECK_EQUAL(db.PendingBlockUndoDynamicMemoryUsage(), 0U);
+        BOOST_CHECK(db.Exists(std::make_pair('U', hashBlock)));
+        vRead.clear();
+        BOOST_CHECK(db.ReadBlockUndoAssetData(hashBlock, vRead));
+        BOOST_REQUIRE_EQUAL(vRead.size(), 1U);
+        BOOST_CHECK_EQUAL(vRead[0].first, "ASSET1");
+        BOOST_CHECK_EQUAL(vRead[0].second.strIPFS, undo.strIPFS);
+    }
+
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,9 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <assets/assets.h>
+#include <assets/messages.h>
+#include <assets/myassetsdb.h>
+#include <validation.h>
 
 #include <test/test_raven.h>
 
@@ -13,6 +16,87 @@
 #include <chainparams.h>
 #include "consensus/consensus.h"
 
+namespace {
+    CMessage MakeMessage(int nHeight, const std::string& strChannel, MessageStatus status)
+    {
+        CMessage message(COutPoint(InsecureRand256(), InsecureRandRange(4)), strChannel,
+                         DecodeAssetData("QmVUXZ1UiwGVuKMPuBagveHexGiRRTQLN8JDrBKauECSFQ"), 0, 1560000000 + nHeight);
+        message.nBlockHeight = nHeight;
+        message.status = status;
+        return message;
+    }
+
+    // Points pmessagedb at an in-memory database and empties the dirty message caches again on the way out
+    struct MessageDBSwap {
+        CMessageDB db;
+        CMessageDB* pOld;
+
+        MessageDBSwap() : db(1 << 20, true, false), pOld(pmessagedb) { pmessagedb = &db; }
+        ~MessageDBSwap()
+        {
+            LOCK(cs_messaging);
+            mapDirtyMessagesAdd.clear();
+            mapDirtyMessagesOrphaned.clear();
+            setDirtyMessagesRemove.clear();
+            pmessagedb = pOld;
+        }
+    };
+
+    // Stores messages over two channels, several sharing a height, then overlays every kind of unflushed change
+    void FillMessages(CMessageDB& db)
+    {
+        std::vector<CMessage> vStored;
+        for (int nHeight : {5, 3, 3, 9, 1, 7, 7, 2})
+            vStored.push_back(MakeMessage(nHeight, nHeight % 2 ? "ASSET~ODD" : "ASSET~EVEN", nHeight > 4 ? MessageStatus::UNREAD : MessageStatus::READ));
+        for (const auto& message : vStored)
+            BOOST_CHECK(db.WriteMessage(message));
+
+        LOCK(cs_messaging);
+        AddMessage(MakeMessage(4, "ASSET~EVEN", MessageStatus::UNREAD));
+        AddMessage(MakeMessage(7, "ASSET~ODD", MessageStatus::UNREAD));
+        CMessage updated = vStored[1];
+        updated.status = MessageStatus::SPAM;
+        AddMessage(updated);
+        OrphanMessage(vStored[3]);
+        RemoveMessage(vStored[5].out);
+        // Orphaned after being removed, the removal still wins
+        RemoveMessage(vStored[0].out);
+        mapDirtyMessagesOrphaned[vStored[0].out] = vStored[0];
+    }
+
+    std::vector<CMessage> LoadPages(CMessageQuery query, size_t nLimit)
+    {
+        std::vector<CMessage> vAll;
+        query.nLimit = nLimit;
+        bool fMore = true;
+        while (fMore) {
+            std::vector<CMessage> vPage;
+            BOOST_REQUIRE(LoadMessages(query, vPage, fMore));
+            BOOST_CHECK(vPage.size() <= nLimit);
+            BOOST_REQUIRE(!fMore || vPage.size() == nLimit);
+            vAll.insert(vAll.end(), vPage.begin(), vPage.end());
+
+            // Resume the way viewallmessages does, from the string form of the last cursor
+            if (fMore) {
+                BOOST_REQUIRE(CMessageCursor::FromString(CMessageCursor(vPage.back()).ToString(), query.start));
+                query.fAfterStart = true;
+            }
+        }
+        return vAll;
+    }
+
+    bool SameMessages(const std::vector<CMessage>& a, const std::vector<CMessage>& b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].out != b[i].out || a[i].status != b[i].status || a[i].strName != b[i].strName)
+                return false;
+        }
+        return true;
+    }
+}
+
 
 BOOST_FIXTURE_TEST_SUITE(messaging_tests, BasicTestingSetup)
 
@@ -78,4 +162,206 @@ BOOST_FIXTURE_TEST_SUITE(messaging_tests, BasicTestingSetup)
     }
 
 
+    BOOST_AUTO_TEST_CASE(message_cursor_string_test)
+    {
+        CMessageCursor cursor(42, COutPoint(InsecureRand256(), 3));
+        CMessageCursor parsed;
+        BOOST_CHECK(CMessageCursor::FromString(cursor.ToString(), parsed));
+        BOOST_CHECK(parsed == cursor);
+
+        std::string strHash = uint256().GetHex();
+        BOOST_CHECK(!CMessageCursor::FromString("", parsed));
+        BOOST_CHECK(!CMessageCursor::FromString("42", parsed));
+        BOOST_CHECK(!CMessageCursor::FromString("42-" + strHash, parsed));
+        BOOST_CHECK(!CMessageCursor::FromString("-1-" + strHash + "-0", parsed));
+        BOOST_CHECK(!CMessageCursor::FromString("42-" + strHash + "-x", parsed));
+        BOOST_CHECK(!CMessageCursor::FromString("42-" + strHash.substr(1) + "-0", parsed));
+    }
+
+    BOOST_FIXTURE_TEST_CASE(message_index_migration_test, TestingSetup)
+    {
+        BOOST_TEST_MESSAGE("Running Message Index Migration Test");
+
+        CMessageDB db(1 << 20, true, false);
+
+        // Records as written before the indexes existed, only under the primary 'Z' key
+        std::vector<CMessage> vLegacy;
+        for (int nHeight : {12, 4, 8, 4, 20})
+            vLegacy.push_back(MakeMessage(nHeight, nHeight > 8 ? "ASSET~NEW" : "ASSET~OLD", nHeight == 4 ? MessageStatus::READ : MessageStatus::UNREAD));
+        for (const auto& message : vLegacy)
+            BOOST_CHECK(db.Write(std::make_pair('Z', message.out), message));
+
+        std::vector<CMessage> vVisited;
+        auto fnVisit = [&vVisited](const CMessage& message) { vVisited.push_back(message); return true; };
+
+        bool fIndexed = false;
+        BOOST_CHECK(!db.ReadFlag("indexed", fIndexed));
+        BOOST_CHECK(db.ForEachIndexedMessage("", "", CMessageCursor(), fnVisit));
+        BOOST_CHECK(vVisited.empty());
+
+        BOOST_CHECK(db.BuildMessageIndexes());
+        BOOST_CHECK(db.ReadFlag("indexed", fIndexed) && fIndexed);
+
+        BOOST_CHECK(db.ForEachIndexedMessage("", "", CMessageCursor(), fnVisit));
+        BOOST_REQUIRE_EQUAL(vVisited.size(), vLegacy.size());
+        for (size_t i = 1; i < vVisited.size(); i++)
+            BOOST_CHECK(CMessageCursor(vVisited[i - 1]) < CMessageCursor(vVisited[i]));
+
+        vVisited.clear();
+        BOOST_CHECK(db.ForEachIndexedMessage("ASSET~NEW", "", CMessageCursor(), fnVisit));
+        BOOST_REQUIRE_EQUAL(vVisited.size(), 2U);
+        BOOST_CHECK_EQUAL(vVisited[0].nBlockHeight, 12);
+        BOOST_CHECK_EQUAL(vVisited[1].nBlockHeight, 20);
+
+        vVisited.clear();
+        BOOST_CHECK(db.ForEachIndexedMessage("", "READ", CMessageCursor(), fnVisit));
+        BOOST_REQUIRE_EQUAL(vVisited.size(), 2U);
+        BOOST_CHECK_EQUAL(vVisited[0].nBlockHeight, 4);
+        BOOST_CHECK_EQUAL(vVisited[1].nBlockHeight, 4);
+
+        // Once the flag is set the migration does not walk the database again
+        CMessage late = MakeMessage(30, "ASSET~NEW", MessageStatus::UNREAD);
+        BOOST_CHECK(db.Write(std::make_pair('Z', late.out), late));
+        BOOST_CHECK(db.BuildMessageIndexes());
+        vVisited.clear();
+        BOOST_CHECK(db.ForEachIndexedMessage("", "", CMessageCursor(30, COutPoint(uint256(), 0)), fnVisit));
+        BOOST_CHECK(vVisited.empty());
+
+        // Erasing a message drops its index entries with it
+        BOOST_CHECK(db.EraseMessage(vLegacy[0].out));
+        BOOST_CHECK(db.ForEachIndexedMessage("ASSET~NEW", "", CMessageCursor(), fnVisit));
+        BOOST_REQUIRE_EQUAL(vVisited.size(), 1U);
+        BOOST_CHECK(vVisited[0].out == vLegacy[4].out);
+    }
+
+    BOOST_FIXTURE_TEST_CASE(message_pagination_test, TestingSetup)
+    {
+        BOOST_TEST_MESSAGE("Running Message Pagination Test");
+
+        MessageDBSwap swap;
+        FillMessages(swap.db);
+
+        CMessageQuery query;
+        std::vector<CMessage> vAll;
+        bool fMore;
+        BOOST_REQUIRE(LoadMessages(query, vAll, fMore));
+        BOOST_CHECK(!fMore);
+        // Eight stored, two added, two removed
+        BOOST_REQUIRE_EQUAL(vAll.size(), 8U);
+
+        std::set<COutPoint> setOuts;
+        for (size_t i = 0; i < vAll.size(); i++) {
+            setOuts.insert(vAll[i].out);
+            if (i > 0)
+                BOOST_CHECK(CMessageCursor(vAll[i - 1]) < CMessageCursor(vAll[i]));
+        }
+        BOOST_CHECK_EQUAL(setOuts.size(), vAll.size());
+
+        // Every page size walks the same messages, each exactly once, whether or not it divides the total
+        for (size_t nLimit : {1, 2, 3, 8, 9})
+            BOOST_CHECK_MESSAGE(SameMessages(LoadPages(query, nLimit), vAll), "page size " << nLimit);
+
+        // Starting partway through, from a height or from a cursor, returns the tail of the full listing
+        query.start = CMessageCursor(7, COutPoint(uint256(), 0));
+        std::vector<CMessage> vTail;
+        BOOST_REQUIRE(LoadMessages(query, vTail, fMore));
+        BOOST_REQUIRE(!vTail.empty());
+        BOOST_CHECK(SameMessages(vTail, std::vector<CMessage>(vAll.end() - vTail.size(), vAll.end())));
+        BOOST_CHECK(SameMessages(LoadPages(query, 2), vTail));
+
+        query.start = CMessageCursor(vAll[2]);
+        query.fAfterStart = true;
+        BOOST_CHECK(SameMessages(LoadPages(query, 2), std::vector<CMessage>(vAll.begin() + 3, vAll.end())));
+
+        // Filters page the same way
+        for (const std::string& strChannel : {"ASSET~ODD", "ASSET~EVEN"}) {
+            CMessageQuery channel;
+            channel.strChannel = strChannel;
+            std::vector<CMessage> vChannel;
+            BOOST_REQUIRE(LoadMessages(channel, vChannel, fMore));
+            BOOST_CHECK(!vChannel.empty());
+            for (const auto& message : vChannel)
+                BOOST_CHECK_EQUAL(message.strName, strChannel);
+            BOOST_CHECK(SameMessages(LoadPages(channel, 1), vChannel));
+        }
+
+        CMessageQuery status;
+        status.strStatus = "ORPHAN";
+        std::vector<CMessage> vOrphans;
+        BOOST_REQUIRE(LoadMessages(status, vOrphans, fMore));
+        BOOST_REQUIRE_EQUAL(vOrphans.size(), 1U);
+        BOOST_CHECK_EQUAL(vOrphans[0].nBlockHeight, 9);
+
+        status.strStatus = "SPAM";
+        status.strChannel = "ASSET~ODD";
+        std::vector<CMessage> vSpam;
+        BOOST_REQUIRE(LoadMessages(status, vSpam, fMore));
+        BOOST_REQUIRE_EQUAL(vSpam.size(), 1U);
+        BOOST_CHECK_EQUAL(vSpam[0].nBlockHeight, 3);
+
+        // A page boundary stays put while messages are added before it
+        CMessageQuery resume;
+        resume.nLimit = 4;
+        std::vector<CMessage> vFirst, vSecond;
+        BOOST_REQUIRE(LoadMessages(resume, vFirst, fMore));
+        BOOST_REQUIRE(fMore);
+        {
+            LOCK(cs_messaging);
+            AddMessage(MakeMessage(0, "ASSET~EVEN", MessageStatus::UNREAD));
+        }
+        resume.start = CMessageCursor(vFirst.back());
+        resume.fAfterStart = true;
+        BOOST_REQUIRE(LoadMessages(resume, vSecond, fMore));
+        BOOST_CHECK(!fMore);
+        BOOST_CHECK(SameMessages(vSecond, std::vector<CMessage>(vAll.begin() + 4, vAll.end())));
+    }
+
+    BOOST_FIXTURE_TEST_CASE(message_listing_order_test, TestingSetup)
+    {
+        BOOST_TEST_MESSAGE("Running Message Listing Order Test");
+
+        MessageDBSwap swap;
+        FillMessages(swap.db);
+
+        // The listing as viewallmessages built it before the indexes, from the whole database and the dirty caches
+        std::set<CMessage> setMessages;
+        {
+            LOCK(cs_messaging);
+            std::unique_ptr<CDBIterator> pcursor(swap.db.NewIterator());
+            for (pcursor->Seek(std::make_pair('Z', COutPoint())); pcursor->Valid(); pcursor->Next()) {
+                std::pair<char, COutPoint> key;
+                CMessage message;
+                if (!pcursor->GetKey(key) || key.first != 'Z')
+                    break;
+                BOOST_REQUIRE(pcursor->GetValue(message));
+                setMessages.insert(message);
+            }
+            for (auto pair : mapDirtyMessagesOrphaned) {
+                CMessage message = pair.second;
+                message.status = MessageStatus::ORPHAN;
+                setMessages.erase(message);
+                setMessages.insert(message);
+            }
+            for (auto out : setDirtyMessagesRemove) {
+                CMessage message;
+                message.out = out;
+                setMessages.erase(message);
+            }
+            for (auto pair : mapDirtyMessagesAdd) {
+                setMessages.erase(pair.second);
+                setMessages.insert(pair.second);
+            }
+        }
+
+        CMessageQuery query;
+        std::vector<CMessage> vMessages;
+        bool fMore;
+        BOOST_REQUIRE(LoadMessages(query, vMessages, fMore));
+
+        // Sorted the way the unpaged viewallmessages sorts them, the same messages come back in the same order
+        std::sort(vMessages.begin(), vMessages.end());
+        BOOST_CHECK(SameMessages(vMessages, std::vector<CMessage>(setMessages.begin(), setMessages.end())));
+    }
+
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <amount.h>
 #include <base58.h>
 #include <chainparams.h>
+#include <wallet/wallet.h>
 
 BOOST_FIXTURE_TEST_SUITE(serialization_tests, BasicTestingSetup)
 
@@ -175,4 +176,47 @@ BOOST_FIXTURE_TEST_SUITE(serialization_tests, BasicTestingSetup)
         BOOST_CHECK_MESSAGE(IsScriptNewMsgChannelAsset(scriptPubKey), "Script wasn't a message channel");
     }
 
+    BOOST_AUTO_TEST_CASE(asset_output_data_cache_test)
+    {
+        SelectParams(CBaseChainParams::MAIN);
+
+        CTxDestination dest = DecodeDestination(GetParams().GlobalBurnAddress());
+        CScript scriptTransfer = GetScriptForDestination(dest);
+        CAssetTransfer("CACHED_ASSET", 5 * COIN).ConstructTransaction(scriptTransfer);
+        CScript scriptOther = GetScriptForDestination(dest);
+        CAssetTransfer("CACHED_ASSET", 6 * COIN).ConstructTransaction(scriptOther);
+
+        // A parse and the cached answer for the same script agree
+        for (int i = 0; i < 2; i++) {
+            CAssetOutputEntry data;
+            BOOST_CHECK(GetAssetData(scriptTransfer, data));
+            BOOST_CHECK(data.type == TX_TRANSFER_ASSET);
+            BOOST_CHECK_EQUAL(data.assetName, "CACHED_ASSET");
+            BOOST_CHECK_EQUAL(data.nAmount, 5 * COIN);
+            BOOST_CHECK(data.destination == dest);
+            BOOST_CHECK_EQUAL(data.message, "");
+            BOOST_CHECK_EQUAL(data.expireTime, 0);
+        }
+        CAssetOutputEntry data;
+        BOOST_CHECK(GetAssetData(scriptOther, data));
+        BOOST_CHECK_EQUAL(data.nAmount, 6 * COIN);
+
+        // Owner outputs carry no message, so whatever the caller had there is left alone either way
+        CScript scriptOwner = GetScriptForDestination(dest);
+        CNewAsset("CACHED_ASSET", 5 * COIN).ConstructOwnerTransaction(scriptOwner);
+        for (int i = 0; i < 2; i++) {
+            CAssetOutputEntry ownerData;
+            ownerData.message = "unchanged";
+            ownerData.vout = 3;
+            BOOST_CHECK(GetAssetData(scriptOwner, ownerData));
+            BOOST_CHECK(ownerData.type == TX_NEW_ASSET);
+            BOOST_CHECK_EQUAL(ownerData.assetName, "CACHED_ASSET!");
+            BOOST_CHECK_EQUAL(ownerData.nAmount, OWNER_ASSET_AMOUNT);
+            BOOST_CHECK_EQUAL(ownerData.message, "unchanged");
+            BOOST_CHECK_EQUAL(ownerData.vout, 3);
+        }
+
+        BOOST_CHECK(!GetAssetData(GetScriptForDestination(dest), data));
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
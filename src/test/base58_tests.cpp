@@ -80,6 +80,32 @@ BOOST_FIXTURE_TEST_SUITE(base58_tests, BasicTestingSetup)
         BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), expected.begin(), expected.end());
     }
 
+    // Goal: round trip random data of every length through the limb-based codec
+    BOOST_AUTO_TEST_CASE(base58_random_roundtrip_test)
+    {
+        BOOST_TEST_MESSAGE("Running Base58 Random Roundtrip Test");
+
+        std::vector<unsigned char> result;
+        for (unsigned int len = 0; len < 100; len++)
+        {
+            for (unsigned int zeroes = 0; zeroes < 3 && zeroes <= len; zeroes++)
+            {
+                std::vector<unsigned char> data(len);
+                for (unsigned int i = zeroes; i < len; i++)
+                    data[i] = InsecureRandBits(8);
+                std::string str = EncodeBase58(data);
+                BOOST_CHECK(DecodeBase58(str, result));
+                BOOST_CHECK(result == data);
+
+                // Every character that is not part of the alphabet is rejected
+                if (!str.empty()) {
+                    str[InsecureRandRange(str.size())] = '0';
+                    BOOST_CHECK(!DecodeBase58(str, result));
+                }
+            }
+        }
+    }
+
     // Visitor to check address type
     class TestAddrTypeVisitor : public boost::static_visitor<bool>
     {
@@ -402,4 +402,40 @@ BOOST_AUTO_TEST_SUITE(cuckoocache_tests);
         test_cache_generations<CuckooCache::cache<uint256, SignatureCacheHasher>>();
     }
 
+/* Test that get_kept returns exactly the retained entries, and that they can
+ * be re-inserted into a fresh cache (as done when persisting across restarts).
+ */
+    BOOST_AUTO_TEST_CASE(cuckoocache_get_kept_test)
+    {
+        BOOST_TEST_MESSAGE("Running CuckooCache Get Kept Test");
+
+        local_rand_ctx = FastRandomContext(true);
+        CuckooCache::cache<uint256, SignatureCacheHasher> cc{};
+        cc.setup_bytes(1 << 20);
+
+        // Stay well below capacity so that nothing is evicted on insert
+        std::vector<uint256> hashes(1000);
+        for (uint256& h : hashes) {
+            insecure_GetRandHash(h);
+            cc.insert(h);
+        }
+        // Mark every other entry as discardable
+        for (size_t i = 0; i < hashes.size(); i += 2)
+            BOOST_CHECK(cc.contains(hashes[i], true));
+
+        std::vector<uint256> kept;
+        cc.get_kept(kept);
+        BOOST_CHECK_EQUAL(kept.size(), hashes.size() / 2);
+        std::set<uint256> setKept(kept.begin(), kept.end());
+        for (size_t i = 0; i < hashes.size(); ++i)
+            BOOST_CHECK_EQUAL(setKept.count(hashes[i]), (size_t)(i % 2));
+
+        CuckooCache::cache<uint256, SignatureCacheHasher> restored{};
+        restored.setup_bytes(1 << 20);
+        for (const uint256& h : kept)
+            restored.insert(h);
+        for (size_t i = 0; i < hashes.size(); ++i)
+            BOOST_CHECK_EQUAL(restored.contains(hashes[i], false), i % 2 == 1);
+    }
+
 BOOST_AUTO_TEST_SUITE_END();
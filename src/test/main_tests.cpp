@@ -3,6 +3,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "assets/assetdb.h"
 #include "chainparams.h"
 #include "validation.h"
 #include "net.h"
@@ -87,4 +88,39 @@ BOOST_FIXTURE_TEST_SUITE(main_tests, TestingSetup)
         BOOST_CHECK(Test());
     }
 
+    BOOST_FIXTURE_TEST_CASE(verifydb_parallel_test, TestChain100Setup)
+    {
+        BOOST_TEST_MESSAGE("Running VerifyDB Parallel Test");
+
+        // The whole chain spans more than one batch, and the tests run with script check threads
+        BOOST_CHECK(chainActive.Height() > (int)VERIFYDB_BATCH_BLOCKS);
+        BOOST_CHECK(nScriptCheckThreads > 1);
+
+        // The test setup has no asset database, which disconnecting a block reads its asset undo data from
+        std::unique_ptr<CAssetsDB> assetsdb(new CAssetsDB(1 << 20, true));
+        passetsdb = assetsdb.get();
+
+        const uint256 hashBest = pcoinsTip->GetBestBlock();
+        BOOST_CHECK(CVerifyDB().VerifyDB(GetParams(), pcoinsTip, 3, 0));
+        BOOST_CHECK(CVerifyDB().VerifyDB(GetParams(), pcoinsTip, 4, 0));
+        BOOST_CHECK(pcoinsTip->GetBestBlock() == hashBest);
+
+        // Point a block in the second batch at its parent's data: the read back fails its hash check
+        CBlockIndex* pindex = chainActive[chainActive.Height() - VERIFYDB_BATCH_BLOCKS - 10];
+        const unsigned int nDataPos = pindex->nDataPos;
+        {
+            LOCK(cs_main);
+            pindex->nDataPos = pindex->pprev->nDataPos;
+        }
+        BOOST_CHECK(!CVerifyDB().VerifyDB(GetParams(), pcoinsTip, 3, 0));
+        // Not when checking only the blocks above it
+        BOOST_CHECK(CVerifyDB().VerifyDB(GetParams(), pcoinsTip, 3, VERIFYDB_BATCH_BLOCKS));
+        {
+            LOCK(cs_main);
+            pindex->nDataPos = nDataPos;
+        }
+        BOOST_CHECK(CVerifyDB().VerifyDB(GetParams(), pcoinsTip, 3, 0));
+        passetsdb = nullptr;
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -597,4 +597,86 @@ BOOST_FIXTURE_TEST_SUITE(mempool_tests, TestingSetup)
         SetMockTime(0);
     }
 
+    BOOST_AUTO_TEST_CASE(mempool_relay_order_keys_test)
+    {
+        BOOST_TEST_MESSAGE("Running Mempool Relay Order Keys Test");
+
+        CTxMemPool pool;
+        TestMemPoolEntryHelper entry;
+
+        // Independent transactions and a chain with a low fee parent, so both
+        // the ancestor count and the score matter for the order
+        std::vector<uint256> vHashes;
+        uint256 hashParent;
+        for (int i = 0; i < 8; i++) {
+            CMutableTransaction tx;
+            tx.vin.resize(1);
+            tx.vin[0].scriptSig = CScript() << i;
+            if (i >= 5)
+                tx.vin[0].prevout = COutPoint(hashParent, 0);
+            tx.vout.resize(1);
+            tx.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+            tx.vout[0].nValue = 10 * COIN;
+            pool.addUnchecked(tx.GetHash(), entry.Fee(i == 4 ? 0 : (i % 3) * 1000LL).FromTx(tx));
+            hashParent = tx.GetHash();
+            vHashes.push_back(tx.GetHash());
+        }
+        // Not in the mempool
+        vHashes.push_back(uint256S("0x01"));
+
+        std::vector<TxRelayOrderKey> vKeys;
+        pool.GetRelayOrderKeys(vHashes, vKeys);
+        BOOST_CHECK_EQUAL(vKeys.size(), vHashes.size());
+        BOOST_CHECK(!vKeys.back().fInMempool);
+
+        for (const auto& a : vKeys) {
+            for (const auto& b : vKeys) {
+                BOOST_CHECK_EQUAL(a < b, pool.CompareDepthAndScore(a.hash, b.hash));
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(mempool_restricted_index_test)
+    {
+        BOOST_TEST_MESSAGE("Running Mempool Restricted Index Test");
+
+        CTxMemPool pool;
+        const std::string strAsset = "$RESTRICTED";
+        const std::string strAddress = "mfe7MqgYZgBuXzrT2QTFqZwBXwRDqagHTp";
+        uint256 hashA = uint256S("0x0a"), hashB = uint256S("0x0b");
+        size_t nEmptyUsage = pool.RestrictedIndexesUsage();
+
+        // Spending two coins of the same asset and address lists the transaction once
+        pool.mapAddressesMarkedFrozen.Insert(strAddress, strAsset, hashA);
+        pool.mapAddressesMarkedFrozen.Insert(strAddress, strAsset, hashA);
+        pool.mapAddressesMarkedFrozen.Insert(strAddress, strAsset, hashB);
+        pool.mapAssetMarkedGlobalFrozen.Insert(strAsset, hashA);
+
+        const CMempoolRestrictedIndex::TxList* pTxs = pool.mapAddressesMarkedFrozen.Find(strAddress, strAsset);
+        BOOST_REQUIRE(pTxs);
+        BOOST_CHECK_EQUAL(pTxs->size(), 2U);
+        BOOST_CHECK(pool.mapAssetMarkedGlobalFrozen.Exists(strAsset));
+        // Single names and (address, name) pairs are separate keys
+        BOOST_CHECK(!pool.mapAssetMarkedGlobalFrozen.Exists(strAddress, strAsset));
+        BOOST_CHECK(!pool.mapAddressesMarkedFrozen.Exists(strAddress));
+        BOOST_CHECK(!pool.mapAddressesMarkedFrozen.Exists(strAsset, strAddress));
+        BOOST_CHECK(pool.RestrictedIndexesUsage() > nEmptyUsage);
+
+        pool.mapAddressesMarkedFrozen.RemoveTx(hashA);
+        pTxs = pool.mapAddressesMarkedFrozen.Find(strAddress, strAsset);
+        BOOST_REQUIRE(pTxs);
+        BOOST_CHECK_EQUAL(pTxs->size(), 1U);
+        BOOST_CHECK((*pTxs)[0] == hashB);
+
+        // Keys go away with their last transaction, and names with their last key
+        pool.mapAddressesMarkedFrozen.RemoveTx(hashB);
+        BOOST_CHECK(!pool.mapAddressesMarkedFrozen.Exists(strAddress, strAsset));
+        uint32_t nId;
+        BOOST_CHECK(!pool.restrictedNames.Find(strAddress, nId));
+        BOOST_CHECK(pool.restrictedNames.Find(strAsset, nId));
+        pool.mapAssetMarkedGlobalFrozen.RemoveTx(hashA);
+        BOOST_CHECK(!pool.restrictedNames.Find(strAsset, nId));
+        BOOST_CHECK(!pool.mapAssetMarkedGlobalFrozen.Exists(strAsset));
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -168,6 +168,15 @@ BOOST_FIXTURE_TEST_SUITE(miner_tests, TestingSetup)
         return index;
     }
 
+    /* Move the times of the last nMedianTimeSpan blocks, and the median times past cached from them */
+    void ShiftTipTimes(int64_t nOffset)
+    {
+        for (int i = 0; i < CBlockIndex::nMedianTimeSpan; i++)
+            chainActive.Tip()->GetAncestor(chainActive.Tip()->nHeight - i)->nTime += nOffset;
+        for (int i = 0; i < CBlockIndex::nMedianTimeSpan; i++)
+            chainActive.Tip()->GetAncestor(chainActive.Tip()->nHeight - i)->SetMedianTimePast();
+    }
+
     bool TestSequenceLocks(const CTransaction &tx, int flags)
     {
         LOCK(mempool.cs);
@@ -590,11 +599,9 @@ BOOST_FIXTURE_TEST_SUITE(miner_tests, TestingSetup)
         BOOST_CHECK(CheckFinalTx(tx, flags)); // Locktime passes
         BOOST_CHECK(!TestSequenceLocks(tx, flags)); // Sequence locks fail
 
-        for (int i = 0; i < CBlockIndex::nMedianTimeSpan; i++)
-            chainActive.Tip()->GetAncestor(chainActive.Tip()->nHeight - i)->nTime += 512; //Trick the MedianTimePast
+        ShiftTipTimes(512); //Trick the MedianTimePast
         BOOST_CHECK(SequenceLocks(tx, flags, &prevheights, CreateBlockIndex(chainActive.Tip()->nHeight + 1))); // Sequence locks pass 512 seconds later
-        for (int i = 0; i < CBlockIndex::nMedianTimeSpan; i++)
-            chainActive.Tip()->GetAncestor(chainActive.Tip()->nHeight - i)->nTime -= 512; //undo tricked MTP
+        ShiftTipTimes(-512); //undo tricked MTP
 
         // absolute height locked
         tx.vin[0].prevout.hash = txFirst[2]->GetHash();
@@ -640,8 +647,7 @@ BOOST_FIXTURE_TEST_SUITE(miner_tests, TestingSetup)
         // For now these will still generate a valid template until BIP68 soft fork
         BOOST_CHECK_EQUAL(pblocktemplate->block.vtx.size(), (uint64_t)3);
         // However if we advance height by 1 and time by 512, all of them should be mined
-        for (int i = 0; i < CBlockIndex::nMedianTimeSpan; i++)
-            chainActive.Tip()->GetAncestor(chainActive.Tip()->nHeight - i)->nTime += 512; //Trick the MedianTimePast
+        ShiftTipTimes(512); //Trick the MedianTimePast
         chainActive.Tip()->nHeight++;
         SetMockTime(chainActive.Tip()->GetMedianTimePast() + 1);
 
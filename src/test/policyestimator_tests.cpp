@@ -3,8 +3,11 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "clientversion.h"
+#include "fs.h"
 #include "policy/policy.h"
 #include "policy/fees.h"
+#include "streams.h"
 #include "txmempool.h"
 #include "uint256.h"
 #include "util.h"
@@ -205,4 +208,72 @@ BOOST_FIXTURE_TEST_SUITE(policyestimator_tests, BasicTestingSetup)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(block_policy_estimates_persist_test)
+    {
+        BOOST_TEST_MESSAGE("Running Block Policy Estimates Persist Test");
+
+        CBlockPolicyEstimator feeEst;
+        CTxMemPool mpool(&feeEst);
+        TestMemPoolEntryHelper entry;
+        CAmount basefee(2000);
+
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vout.resize(1);
+        tx.vout[0].nValue = 0LL;
+
+        // Run long enough for the short horizon's pending decay to be
+        // folded into its stored averages at least once.
+        // Lower fee transactions wait a block before confirming, and the
+        // mempool is emptied at the end so no unconfirmed counts are left
+        // that a reloaded estimator would not know about.
+        std::vector<CTransactionRef> block, delayed;
+        for (int blocknum = 0; blocknum < 2000; blocknum++)
+        {
+            block.swap(delayed);
+            delayed.clear();
+            for (int j = 0; j < 10; j++)
+            {
+                tx.vin[0].prevout.n = 10000 * blocknum + j;
+                uint256 hash = tx.GetHash();
+                mpool.addUnchecked(hash, entry.Fee(basefee * (j + 1)).Time(GetTime()).Height(blocknum).FromTx(tx));
+                CTransactionRef ptx = mpool.get(hash);
+                if (j < 3)
+                    delayed.push_back(ptx);
+                else
+                    block.push_back(ptx);
+            }
+            mpool.removeForBlock(block, blocknum + 1);
+            block.clear();
+        }
+        mpool.removeForBlock(delayed, 2001);
+        BOOST_CHECK_EQUAL(mpool.size(), 0U);
+
+        fs::path path = fs::temp_directory_path() / fs::unique_path();
+        {
+            CAutoFile fileout(fsbridge::fopen(path, "wb"), SER_DISK, CLIENT_VERSION);
+            BOOST_CHECK(feeEst.Write(fileout));
+        }
+        CBlockPolicyEstimator feeEstRead;
+        {
+            CAutoFile filein(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+            BOOST_CHECK(feeEstRead.Read(filein));
+        }
+        fs::remove(path);
+
+        // The written averages include any decay still pending in memory
+        for (int i = 1; i <= 48; i++)
+        {
+            for (FeeEstimateHorizon horizon : {FeeEstimateHorizon::SHORT_HALFLIFE, FeeEstimateHorizon::MED_HALFLIFE, FeeEstimateHorizon::LONG_HALFLIFE})
+            {
+                if ((unsigned int)i > feeEst.HighestTargetTracked(horizon))
+                    continue;
+                CAmount nOrig = feeEst.estimateRawFee(i, 0.85, horizon).GetFeePerK();
+                CAmount nRead = feeEstRead.estimateRawFee(i, 0.85, horizon).GetFeePerK();
+                BOOST_CHECK(std::abs(nOrig - nRead) <= 1);
+            }
+        }
+        BOOST_CHECK(feeEst.estimateFee(2) != CFeeRate(0));
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -96,4 +96,92 @@ BOOST_FIXTURE_TEST_SUITE(pow_tests, BasicTestingSetup)
         }
     }
 
+    /* DarkGravityWave as it was before its window was cached, without the min-difficulty rule main doesn't use */
+    static unsigned int DarkGravityWaveReference(const CBlockIndex* pindexLast, const CBlockHeader* pblock, const Consensus::Params& params)
+    {
+        const arith_uint256 bnPowLimit = UintToArith256(params.powLimit);
+        int64_t nPastBlocks = 180;
+
+        const CBlockIndex* pindex = pindexLast;
+        arith_uint256 bnPastTargetAvg;
+
+        int nKAWPOWBlocksFound = 0;
+        for (unsigned int nCountBlocks = 1; nCountBlocks <= nPastBlocks; nCountBlocks++) {
+            arith_uint256 bnTarget = arith_uint256().SetCompact(pindex->nBits);
+            if (nCountBlocks == 1) {
+                bnPastTargetAvg = bnTarget;
+            } else {
+                bnPastTargetAvg = (bnPastTargetAvg * nCountBlocks + bnTarget) / (nCountBlocks + 1);
+            }
+            if (pindex->nTime >= nKAWPOWActivationTime) {
+                nKAWPOWBlocksFound++;
+            }
+            if (nCountBlocks != nPastBlocks) {
+                pindex = pindex->pprev;
+            }
+        }
+
+        if (pblock->nTime >= nKAWPOWActivationTime && nKAWPOWBlocksFound != nPastBlocks)
+            return UintToArith256(params.kawpowLimit).GetCompact();
+
+        arith_uint256 bnNew(bnPastTargetAvg);
+        int64_t nActualTimespan = pindexLast->GetBlockTime() - pindex->GetBlockTime();
+        int64_t nTargetTimespan = nPastBlocks * params.nPowTargetSpacing;
+        if (nActualTimespan < nTargetTimespan/3)
+            nActualTimespan = nTargetTimespan/3;
+        if (nActualTimespan > nTargetTimespan*3)
+            nActualTimespan = nTargetTimespan*3;
+        bnNew *= nActualTimespan;
+        bnNew /= nTargetTimespan;
+        if (bnNew > bnPowLimit)
+            bnNew = bnPowLimit;
+        return bnNew.GetCompact();
+    }
+
+    /* Replay a mainnet-like header chain through the KAWPOW switch, checking every retarget against the old formula */
+    BOOST_AUTO_TEST_CASE(dark_gravity_wave_replay_test)
+    {
+        BOOST_TEST_MESSAGE("Running Dark Gravity Wave Replay Test");
+
+        const Consensus::Params& params = GetParams().GetConsensus();
+        const int nBlocks = 2000;
+        std::vector<uint256> vHashes(nBlocks);
+        std::vector<CBlockIndex> blocks(nBlocks);
+        int64_t nTime = nKAWPOWActivationTime - 1000 * params.nPowTargetSpacing;
+
+        for (int i = 0; i < nBlocks; i++) {
+            vHashes[i] = InsecureRand256();
+            blocks[i].phashBlock = &vHashes[i];
+            blocks[i].pprev = i ? &blocks[i - 1] : nullptr;
+            blocks[i].nHeight = 1200000 + i;
+
+            // Mostly steady, with runs of fast and slow blocks that hit both timespan clamps
+            switch ((i / 250) % 4) {
+                case 1: nTime += InsecureRandRange(10); break;
+                case 2: nTime += 200 + InsecureRandRange(400); break;
+                default: nTime += 30 + InsecureRandRange(61); break;
+            }
+            blocks[i].nTime = nTime;
+
+            if (i < 180) {
+                arith_uint256 bnTarget = arith_uint256().SetCompact(0x1b01c2d0) * (uint32_t)(990 + InsecureRandRange(21)) / 1000;
+                blocks[i].nBits = bnTarget.GetCompact();
+                continue;
+            }
+
+            CBlockHeader header;
+            header.nTime = blocks[i].nTime;
+            unsigned int nBits = GetNextWorkRequired(&blocks[i - 1], &header, params);
+            BOOST_CHECK_EQUAL(nBits, DarkGravityWaveReference(&blocks[i - 1], &header, params));
+
+            // Asked again from the same parent, as by a miner, and for a header on the other side of the switch
+            BOOST_CHECK_EQUAL(GetNextWorkRequired(&blocks[i - 1], &header, params), nBits);
+            CBlockHeader other;
+            other.nTime = header.nTime < nKAWPOWActivationTime ? nKAWPOWActivationTime : nKAWPOWActivationTime - 1;
+            BOOST_CHECK_EQUAL(GetNextWorkRequired(&blocks[i - 1], &other, params), DarkGravityWaveReference(&blocks[i - 1], &other, params));
+
+            blocks[i].nBits = nBits;
+        }
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
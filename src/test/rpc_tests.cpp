@@ -18,6 +18,8 @@
 #include <univalue.h>
 #include <validation.h>
 #include <consensus/consensus.h>
+#include <assets/assets.h>
+#include <chainparams.h>
 
 UniValue CallRPC(std::string args)
 {
@@ -365,6 +367,82 @@ BOOST_FIXTURE_TEST_SUITE(rpc_tests, TestingSetup)
         BOOST_CHECK_EQUAL(adr.get_str(), "2001:4d48:ac57:400:cacf:e9ff:fe1d:9c63/128");
     }
 
+    BOOST_AUTO_TEST_CASE(rpc_txtouniv_fields_test)
+    {
+        BOOST_TEST_MESSAGE("Running RPC TxToUniv Fields Test");
+
+        // Two outputs pay the same asset transfer script
+        CScript assetScript = GetScriptForDestination(DecodeDestination("RUrmBNPvWemcczvE9uWMmkaVxHik753vKm"));
+        CAssetTransfer("RAVEN_ASSET", 20000 * COIN).ConstructTransaction(assetScript);
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout = COutPoint(uint256S("a3b807410df0b60fcb9736768df5823938b2f838694939ba45f3c0a1bff150ed"), 0);
+        mtx.vin[0].scriptSig = CScript() << std::vector<unsigned char>(72, 1);
+        mtx.vout.resize(3);
+        mtx.vout[0].scriptPubKey = assetScript;
+        mtx.vout[1].scriptPubKey = GetScriptForDestination(DecodeDestination("rNNjqrDbSHxJZNfC54WsF8dxqbcue9SoiB"));
+        mtx.vout[2].scriptPubKey = assetScript;
+        CTransaction tx(mtx);
+
+        // Reusing scriptPubKey objects leaves the output unchanged
+        UniValue plain(UniValue::VOBJ), cached(UniValue::VOBJ);
+        ScriptPubKeyUnivCache cache;
+        TxToUniv(tx, uint256(), plain);
+        TxToUniv(tx, uint256(), cached, true, 0, SCRIPT_FIELDS_ALL, &cache);
+        BOOST_CHECK_EQUAL(plain.write(), cached.write());
+        BOOST_CHECK_EQUAL(cache.size(), 2U);
+        BOOST_CHECK_EQUAL(find_value(find_value(plain["vout"][2], "scriptPubKey"), "asset")["name"].get_str(), "RAVEN_ASSET");
+
+        // Without script encodings everything else is still there
+        UniValue bare(UniValue::VOBJ);
+        TxToUniv(tx, uint256(), bare, false, 0, 0);
+        BOOST_CHECK(find_value(bare, "hex").isNull());
+        BOOST_CHECK(find_value(bare["vin"][0], "scriptSig").isNull());
+        BOOST_CHECK_EQUAL(find_value(bare["vin"][0], "txid").get_str(), tx.vin[0].prevout.hash.GetHex());
+        const UniValue& scriptPubKey = find_value(bare["vout"][0], "scriptPubKey");
+        BOOST_CHECK(find_value(scriptPubKey, "asm").isNull());
+        BOOST_CHECK(find_value(scriptPubKey, "hex").isNull());
+        BOOST_CHECK_EQUAL(find_value(scriptPubKey, "type").get_str(), "transfer_asset");
+        BOOST_CHECK_EQUAL(find_value(scriptPubKey, "addresses")[0].get_str(), "RUrmBNPvWemcczvE9uWMmkaVxHik753vKm");
+        BOOST_CHECK_EQUAL(find_value(scriptPubKey, "asset")["name"].get_str(), "RAVEN_ASSET");
+
+        // getblock passes the choice on
+        std::string strGenesis = GetParams().GenesisBlock().GetHash().GetHex();
+        UniValue block;
+        BOOST_CHECK_NO_THROW(block = CallRPC("getblock " + strGenesis + " 2 false"));
+        BOOST_CHECK(find_value(block["tx"][0], "hex").isNull());
+        BOOST_CHECK(find_value(find_value(block["tx"][0]["vout"][0], "scriptPubKey"), "asm").isNull());
+        BOOST_CHECK_NO_THROW(block = CallRPC("getblock " + strGenesis + " 2"));
+        BOOST_CHECK(!find_value(block["tx"][0], "hex").isNull());
+        BOOST_CHECK(!find_value(find_value(block["tx"][0]["vout"][0], "scriptPubKey"), "asm").isNull());
+    }
+
+    BOOST_FIXTURE_TEST_CASE(rpc_getrawtransaction_scripts_test, TestChain100Setup)
+    {
+        BOOST_TEST_MESSAGE("Running RPC GetRawTransaction Scripts Test");
+
+        // An unspent coinbase, found through the coins view without -txindex
+        std::string strTxid = coinbaseTxns[0].GetHash().GetHex();
+        UniValue tx;
+        BOOST_CHECK_NO_THROW(tx = CallRPC("getrawtransaction " + strTxid + " true"));
+        BOOST_CHECK(!find_value(tx, "hex").isNull());
+        BOOST_CHECK(!find_value(find_value(tx["vout"][0], "scriptPubKey"), "asm").isNull());
+        BOOST_CHECK(!find_value(find_value(tx["vout"][0], "scriptPubKey"), "hex").isNull());
+
+        BOOST_CHECK_NO_THROW(tx = CallRPC("getrawtransaction " + strTxid + " true false"));
+        BOOST_CHECK(find_value(tx, "hex").isNull());
+        const UniValue& scriptPubKey = find_value(tx["vout"][0], "scriptPubKey");
+        BOOST_CHECK(find_value(scriptPubKey, "asm").isNull());
+        BOOST_CHECK(find_value(scriptPubKey, "hex").isNull());
+        BOOST_CHECK_EQUAL(find_value(scriptPubKey, "type").get_str(), "pubkey");
+        BOOST_CHECK_EQUAL(find_value(tx, "txid").get_str(), strTxid);
+        BOOST_CHECK_EQUAL(find_value(tx, "confirmations").get_int(), 100);
+
+        // Without verbose there is nothing to leave out
+        BOOST_CHECK_NO_THROW(tx = CallRPC("getrawtransaction " + strTxid + " false false"));
+        BOOST_CHECK_EQUAL(tx.get_str(), EncodeHexTx(coinbaseTxns[0], RPCSerializationFlags()));
+    }
+
     BOOST_AUTO_TEST_CASE(rpc_convert_values_generatetoaddress_test)
     {
         BOOST_TEST_MESSAGE("Running RPC Convert Values GenerateToAddress Test");
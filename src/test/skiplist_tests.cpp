@@ -7,6 +7,7 @@
 #include "util.h"
 #include "test/test_raven.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
@@ -203,4 +204,52 @@ BOOST_FIXTURE_TEST_SUITE(skiplist_tests, BasicTestingSetup)
         BOOST_CHECK(!chain.FindEarliestAtLeast(int64_t(std::numeric_limits<unsigned int>::max()) + 1));
     }
 
+    /* Median time past as it was computed on every call, before it was cached */
+    static int64_t MedianTimePastReference(const CBlockIndex* pindex)
+    {
+        std::vector<int64_t> vTimes;
+        for (int i = 0; i < CBlockIndex::nMedianTimeSpan && pindex; i++, pindex = pindex->pprev)
+            vTimes.push_back(pindex->GetBlockTime());
+        std::sort(vTimes.begin(), vTimes.end());
+        return vTimes[vTimes.size() / 2];
+    }
+
+    BOOST_AUTO_TEST_CASE(median_time_past_test)
+    {
+        BOOST_TEST_MESSAGE("Running Median Time Past Test");
+
+        // Block times that wander backwards as well as forwards, as miners' clocks allow
+        std::vector<CBlockIndex> vBlocks(5000);
+        int64_t nTime = 1514764800;
+        for (unsigned int i = 0; i < vBlocks.size(); i++)
+        {
+            vBlocks[i].nHeight = i;
+            vBlocks[i].pprev = i ? &vBlocks[i - 1] : nullptr;
+            nTime += (int64_t)InsecureRandRange(241) - 60;
+            vBlocks[i].nTime = nTime;
+            BOOST_CHECK_EQUAL(vBlocks[i].GetMedianTimePast(), MedianTimePastReference(&vBlocks[i]));
+            vBlocks[i].SetMedianTimePast();
+            BOOST_CHECK_EQUAL(vBlocks[i].nMedianTimePast, MedianTimePastReference(&vBlocks[i]));
+        }
+
+        // Cached values hold for every entry once the whole chain is linked
+        for (unsigned int i = 0; i < vBlocks.size(); i++)
+        {
+            BOOST_CHECK_EQUAL(vBlocks[i].GetMedianTimePast(), MedianTimePastReference(&vBlocks[i]));
+            BOOST_CHECK_EQUAL(vBlocks[i].GetMedianTimePast(), vBlocks[i].ComputeMedianTimePast());
+        }
+
+        // Runs of equal times, and a lone genesis entry
+        for (unsigned int i = 0; i < 20; i++)
+        {
+            vBlocks[i].nTime = 1514764800 + i / 4;
+            vBlocks[i].SetMedianTimePast();
+            BOOST_CHECK_EQUAL(vBlocks[i].GetMedianTimePast(), MedianTimePastReference(&vBlocks[i]));
+        }
+        CBlockIndex genesis;
+        genesis.nTime = 1514764800;
+        genesis.SetMedianTimePast();
+        BOOST_CHECK_EQUAL(genesis.GetMedianTimePast(), 1514764800);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -524,6 +524,65 @@ BOOST_FIXTURE_TEST_SUITE(transaction_tests, BasicTestingSetup)
         threadGroup.join_all();
     }
 
+    BOOST_AUTO_TEST_CASE(produce_signatures_test)
+    {
+        BOOST_TEST_MESSAGE("Running Produce Signatures Test");
+
+        // Inputs spending P2PKH, P2PK and 1-of-2 multisig outputs of a few keys
+        CBasicKeyStore keystore;
+        std::vector<CKey> keys(4);
+        for (CKey& key : keys) {
+            key.MakeNewKey(true);
+            keystore.AddKey(key);
+        }
+        CKey keyMissing;
+        keyMissing.MakeNewKey(true);
+
+        CMutableTransaction mtx;
+        std::vector<CTxOut> vSpent;
+        for (uint32_t i = 0; i < 200; i++) {
+            mtx.vin.emplace_back(COutPoint(InsecureRand256(), i));
+            const CKey& key = keys[i % keys.size()];
+            CScript scriptPubKey;
+            switch (i % 3) {
+                case 0: scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID()); break;
+                case 1: scriptPubKey = GetScriptForRawPubKey(key.GetPubKey()); break;
+                default: scriptPubKey = GetScriptForMultisig(1, {keyMissing.GetPubKey(), key.GetPubKey()}); break;
+            }
+            vSpent.emplace_back(1000 + i, scriptPubKey);
+        }
+        mtx.vout.emplace_back(100000, CScript() << OP_TRUE);
+        const CTransaction tx(mtx);
+
+        // Serially, input by input, as before
+        std::vector<CScript> vExpected;
+        for (uint32_t i = 0; i < tx.vin.size(); i++) {
+            SignatureData sigdata;
+            BOOST_CHECK(ProduceSignature(TransactionSignatureCreator(&keystore, &tx, i, vSpent[i].nValue, SIGHASH_ALL), vSpent[i].scriptPubKey, sigdata));
+            vExpected.push_back(sigdata.scriptSig);
+        }
+
+        // The same signatures whatever the number of threads
+        for (int nThreads : {1, 2, 8}) {
+            std::vector<SignatureData> vSigData;
+            BOOST_CHECK(ProduceSignatures(keystore, tx, vSpent, SIGHASH_ALL, vSigData, nThreads));
+            BOOST_REQUIRE_EQUAL(vSigData.size(), tx.vin.size());
+            for (uint32_t i = 0; i < tx.vin.size(); i++)
+                BOOST_CHECK(vSigData[i].scriptSig == vExpected[i]);
+        }
+
+        // Null outputs are left unsigned; the first input that can't be signed is reported
+        vSpent[5] = CTxOut();
+        vSpent[7] = CTxOut(1000, GetScriptForDestination(keyMissing.GetPubKey().GetID()));
+        vSpent[150] = CTxOut(1000, GetScriptForRawPubKey(keyMissing.GetPubKey()));
+        std::vector<SignatureData> vSigData;
+        unsigned int nFailedIn = 0;
+        BOOST_CHECK(!ProduceSignatures(keystore, tx, vSpent, SIGHASH_ALL, vSigData, 4, &nFailedIn));
+        BOOST_CHECK_EQUAL(nFailedIn, 7U);
+        BOOST_CHECK(vSigData[5].scriptSig.empty());
+        BOOST_CHECK(vSigData[6].scriptSig == vExpected[6]);
+    }
+
     BOOST_AUTO_TEST_CASE(witness_test)
     {
         BOOST_TEST_MESSAGE("Running Witness Test");
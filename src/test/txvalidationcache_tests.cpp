@@ -394,4 +394,81 @@ BOOST_AUTO_TEST_SUITE(tx_validationcache_tests)
         }
     }
 
+    BOOST_FIXTURE_TEST_CASE(tx_mempool_parallel_scriptcheck_test, TestChain100Setup)
+    {
+        BOOST_TEST_MESSAGE("Running TX MemPool Parallel ScriptCheck Test");
+
+        // The blocks built below carry no witness commitment for the transactions added to them
+        TurnOffSegwit();
+
+        // Transactions with at least MEMPOOL_PARALLEL_SCRIPTCHECK_MIN_INPUTS inputs have their
+        // script checks run on the script-checking threads; make sure valid ones are still
+        // accepted and that an invalid input is reported exactly as with serial checking.
+        const unsigned int nInputs = MEMPOOL_PARALLEL_SCRIPTCHECK_MIN_INPUTS + 4;
+        CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+        // Split a mature coinbase into enough outputs and confirm it
+        CMutableTransaction split;
+        split.nVersion = 1;
+        split.vin.resize(1);
+        split.vin[0].prevout.hash = coinbaseTxns[0].GetHash();
+        split.vin[0].prevout.n = 0;
+        split.vout.resize(nInputs);
+        for (unsigned int i = 0; i < nInputs; i++) {
+            split.vout[i].nValue = (coinbaseTxns[0].vout[0].nValue - COIN) / nInputs;
+            split.vout[i].scriptPubKey = scriptPubKey;
+        }
+        std::vector<unsigned char> vchSig;
+        uint256 hash = SignatureHash(scriptPubKey, split, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+        BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char) SIGHASH_ALL);
+        split.vin[0].scriptSig << vchSig;
+
+        CBlock block = CreateAndProcessBlock({split}, scriptPubKey);
+        BOOST_CHECK(chainActive.Tip()->GetBlockHash() == block.GetHash());
+
+        CMutableTransaction spend;
+        spend.nVersion = 1;
+        spend.vin.resize(nInputs);
+        for (unsigned int i = 0; i < nInputs; i++) {
+            spend.vin[i].prevout.hash = split.GetHash();
+            spend.vin[i].prevout.n = i;
+        }
+        spend.vout.resize(1);
+        spend.vout[0].nValue = split.vout[0].nValue * (nInputs - 1);
+        spend.vout[0].scriptPubKey = scriptPubKey;
+
+        // Sign every input but the last one with the right key
+        CKey otherKey;
+        otherKey.MakeNewKey(true);
+        for (unsigned int i = 0; i < nInputs; i++) {
+            vchSig.clear();
+            hash = SignatureHash(scriptPubKey, spend, i, SIGHASH_ALL, 0, SIGVERSION_BASE);
+            BOOST_CHECK((i + 1 < nInputs ? coinbaseKey : otherKey).Sign(hash, vchSig));
+            vchSig.push_back((unsigned char) SIGHASH_ALL);
+            spend.vin[i].scriptSig = CScript() << vchSig;
+        }
+
+        {
+            LOCK(cs_main);
+            CValidationState state;
+            BOOST_CHECK(!AcceptToMemoryPool(mempool, state, MakeTransactionRef(spend), nullptr, nullptr, true, 0));
+            BOOST_CHECK(state.GetRejectReason().find("mandatory-script-verify-flag-failed") == 0);
+            int nDoS = 0;
+            BOOST_CHECK(state.IsInvalid(nDoS));
+            BOOST_CHECK_EQUAL(nDoS, 100);
+        }
+        BOOST_CHECK_EQUAL(mempool.size(), (uint64_t)0);
+
+        // Fix the last input and the transaction is accepted
+        vchSig.clear();
+        hash = SignatureHash(scriptPubKey, spend, nInputs - 1, SIGHASH_ALL, 0, SIGVERSION_BASE);
+        BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char) SIGHASH_ALL);
+        spend.vin[nInputs - 1].scriptSig = CScript() << vchSig;
+
+        BOOST_CHECK(ToMemPool(spend));
+        BOOST_CHECK_EQUAL(mempool.size(), (uint64_t)1);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,196 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "validationinterface.h"
+
+#include "arith_uint256.h"
+#include "consensus/validation.h"
+#include "primitives/block.h"
+#include "test/test_raven.h"
+
+#include <condition_variable>
+#include <mutex>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(validationinterface_tests, TestingSetup)
+
+    // Records the notifications it sees; while held, it stalls inside the first one
+    class TestSubscriber : public CValidationInterface
+    {
+    public:
+        std::mutex cs;
+        std::condition_variable cond;
+        bool fHold = false;
+        bool fEntered = false;
+        std::vector<uint256> vSeen;
+
+        void Release()
+        {
+            {
+                std::lock_guard<std::mutex> lock(cs);
+                fHold = false;
+            }
+            cond.notify_all();
+        }
+
+        void WaitEntered()
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            cond.wait(lock, [this] { return fEntered; });
+        }
+
+        std::vector<uint256> Seen()
+        {
+            std::lock_guard<std::mutex> lock(cs);
+            return vSeen;
+        }
+
+    protected:
+        void Inventory(const uint256& hash) override
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            fEntered = true;
+            cond.notify_all();
+            cond.wait(lock, [this] { return !fHold; });
+            vSeen.push_back(hash);
+        }
+
+        void BlockFound(const uint256& hash) override
+        {
+            Inventory(hash);
+        }
+
+        void ResendWalletTransactions(int64_t nBestBlockTime, CConnman* connman) override
+        {
+            Inventory(ArithToUint256(nBestBlockTime));
+        }
+
+        void BlockChecked(const CBlock& block, const CValidationState& state) override
+        {
+            Inventory(block.GetHash());
+        }
+    };
+
+    static NotificationQueueInfo GetQueueInfo(const std::string& strName)
+    {
+        for (const NotificationQueueInfo& info : GetNotificationQueueInfo())
+            if (info.strName == strName)
+                return info;
+        BOOST_ERROR("no queue named " + strName);
+        return NotificationQueueInfo();
+    }
+
+    BOOST_AUTO_TEST_CASE(queued_subscriber_test)
+    {
+        TestSubscriber slow, sync;
+        slow.fHold = true;
+        RegisterValidationInterfaceQueued(&slow, "slow", NOTIFY_INVENTORY);
+        RegisterValidationInterface(&sync);
+
+        std::vector<uint256> vHashes;
+        for (int i = 0; i < 20; i++) {
+            vHashes.push_back(InsecureRand256());
+            GetMainSignals().Inventory(vHashes.back());
+        }
+
+        // The synchronous subscriber saw everything while the queued one is stuck on the first
+        slow.WaitEntered();
+        BOOST_CHECK(sync.Seen() == vHashes);
+        BOOST_CHECK(slow.Seen().empty());
+        NotificationQueueInfo info = GetQueueInfo("slow");
+        BOOST_CHECK_EQUAL(info.nDepth, 19U);
+        BOOST_CHECK_EQUAL(info.nDropped, 0U);
+
+        slow.Release();
+        GetMainSignals().FlushBackgroundCallbacks();
+        BOOST_CHECK(slow.Seen() == vHashes);
+        info = GetQueueInfo("slow");
+        BOOST_CHECK_EQUAL(info.nDepth, 0U);
+        BOOST_CHECK(info.nMaxDepth >= 19U);
+        BOOST_CHECK_EQUAL(info.nDelivered, 20U);
+        BOOST_CHECK(info.nMaxLatency > 0);
+        BOOST_CHECK(info.nTotalLatency >= info.nMaxLatency);
+
+        UnregisterValidationInterface(&slow);
+        UnregisterValidationInterface(&sync);
+        BOOST_CHECK(GetNotificationQueueInfo().empty());
+    }
+
+    BOOST_AUTO_TEST_CASE(queued_subscriber_drop_test)
+    {
+        TestSubscriber slow;
+        slow.fHold = true;
+        RegisterValidationInterfaceQueued(&slow, "slow", NOTIFY_INVENTORY | NOTIFY_BLOCK_FOUND, 2);
+
+        std::vector<uint256> vHashes;
+        for (int i = 0; i < 6; i++)
+            vHashes.push_back(InsecureRand256());
+        uint256 hashBlock = InsecureRand256();
+
+        GetMainSignals().Inventory(vHashes[0]);
+        slow.WaitEntered();
+        for (int i = 1; i < 6; i++)
+            GetMainSignals().Inventory(vHashes[i]);
+        // Chain notifications are never dropped, even with the queue full
+        GetMainSignals().BlockFound(hashBlock);
+
+        NotificationQueueInfo info = GetQueueInfo("slow");
+        BOOST_CHECK_EQUAL(info.nDepth, 3U);
+        BOOST_CHECK_EQUAL(info.nDropped, 3U);
+
+        slow.Release();
+        // Unregistering delivers what was already queued
+        UnregisterValidationInterface(&slow);
+        std::vector<uint256> vExpected = {vHashes[0], vHashes[1], vHashes[2], hashBlock};
+        BOOST_CHECK(slow.Seen() == vExpected);
+    }
+
+    BOOST_AUTO_TEST_CASE(queued_subscriber_selection_test)
+    {
+        TestSubscriber slow;
+        RegisterValidationInterfaceQueued(&slow, "slow", NOTIFY_INVENTORY | NOTIFY_RESEND_WALLET_TRANSACTIONS);
+
+        // Callbacks left out of the selection never reach the queue
+        CBlock block;
+        GetMainSignals().BlockChecked(block, CValidationState());
+        GetMainSignals().BlockFound(InsecureRand256());
+        uint256 hash = InsecureRand256();
+        GetMainSignals().Inventory(hash);
+        GetMainSignals().Broadcast(42, nullptr);
+
+        // Flushing one subscriber waits for what was queued for it
+        FlushValidationInterfaceQueue(&slow);
+        std::vector<uint256> vExpected = {hash, ArithToUint256(42)};
+        BOOST_CHECK(slow.Seen() == vExpected);
+        BOOST_CHECK_EQUAL(GetQueueInfo("slow").nDelivered, 2U);
+
+        UnregisterValidationInterface(&slow);
+        // Interfaces without a queue have nothing to wait for
+        FlushValidationInterfaceQueue(&slow);
+    }
+
+    BOOST_AUTO_TEST_CASE(queued_subscriber_unbounded_test)
+    {
+        TestSubscriber slow;
+        slow.fHold = true;
+        RegisterValidationInterfaceQueued(&slow, "slow", NOTIFY_INVENTORY, 0);
+
+        std::vector<uint256> vHashes;
+        for (int i = 0; i < 50; i++) {
+            vHashes.push_back(InsecureRand256());
+            GetMainSignals().Inventory(vHashes.back());
+        }
+        slow.WaitEntered();
+
+        NotificationQueueInfo info = GetQueueInfo("slow");
+        BOOST_CHECK_EQUAL(info.nDepth, 49U);
+        BOOST_CHECK_EQUAL(info.nDropped, 0U);
+
+        slow.Release();
+        UnregisterValidationInterface(&slow);
+        BOOST_CHECK(slow.Seen() == vHashes);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -658,71 +658,14 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
     }
 
     // Erase from the restricted asset mempool maps if they match txids
-    if (mapHashToAddressMarkedFrozen.count(hash)) {
-        for (auto item : mapHashToAddressMarkedFrozen.at(hash))
-            mapAddressesMarkedFrozen.at(item).erase(hash);
-        mapHashToAddressMarkedFrozen.erase(hash);
-    }
-
-    if (mapHashMarkedGlobalFrozen.count(hash)) {
-        for (auto item : mapHashMarkedGlobalFrozen.at(hash))
-            mapAssetMarkedGlobalFrozen.at(item).erase(hash);
-        mapHashMarkedGlobalFrozen.erase(hash);
-    }
-
-    if (mapHashQualifiersChanged.count(hash)) {
-        for (auto item : mapHashQualifiersChanged.at(hash))
-            mapAddressesQualifiersChanged.at(item).erase(hash);
-        mapHashQualifiersChanged.erase(hash);
-    }
-
-    if (mapHashVerifierChanged.count(hash)) {
-        for (auto item : mapHashVerifierChanged.at(hash))
-            mapAssetVerifierChanged.at(item).erase(hash);
-        mapHashVerifierChanged.erase(hash);
-    }
-
-    if (mapHashGlobalFreezingAssetTransactions.count(hash)) {
-        for (auto item : mapHashGlobalFreezingAssetTransactions.at(hash)) {
-            if (mapGlobalFreezingAssetTransactions.count(item)) {
-                mapGlobalFreezingAssetTransactions.at(item).erase(hash);
-                if (mapGlobalFreezingAssetTransactions.at(item).size() == 0)
-                    mapGlobalFreezingAssetTransactions.erase(item);
-            }
-        }
-        mapHashGlobalFreezingAssetTransactions.erase(hash);
-    }
-
-    if (mapHashGlobalUnFreezingAssetTransactions.count(hash)) {
-        for (auto item : mapHashGlobalUnFreezingAssetTransactions.at(hash)) {
-            if (mapGlobalUnFreezingAssetTransactions.count(item)) {
-                mapGlobalUnFreezingAssetTransactions.at(item).erase(hash);
-                if (mapGlobalUnFreezingAssetTransactions.at(item).size() == 0)
-                    mapGlobalUnFreezingAssetTransactions.erase(item);
-            }
-        }
-        mapHashGlobalUnFreezingAssetTransactions.erase(hash);
-    }
-
-    if (mapHashToAddressAddedTag.count(hash)) {
-        for (auto item : mapHashToAddressAddedTag.at(hash)) {
-            if (mapAddressAddedTag.count(item)) {
-                mapAddressAddedTag.at(item).erase(hash);
-                if (mapAddressAddedTag.at(item).size() == 0)
-                    mapAddressAddedTag.erase(item);
-            }
-        }
-    }
-
-    if (mapHashToAddressRemoveTag.count(hash)) {
-        for (auto item : mapHashToAddressRemoveTag.at(hash)) {
-            if (mapAddressRemoveTag.count(item)) {
-                mapAddressRemoveTag.at(item).erase(hash);
-                if (mapAddressRemoveTag.at(item).size() == 0)
-                    mapAddressRemoveTag.erase(item);
-            }
-        }
-    }
+    mapAddressesMarkedFrozen.RemoveTx(hash);
+    mapAssetMarkedGlobalFrozen.RemoveTx(hash);
+    mapAddressesQualifiersChanged.RemoveTx(hash);
+    mapAssetVerifierChanged.RemoveTx(hash);
+    mapGlobalFreezingAssetTransactions.RemoveTx(hash);
+    mapGlobalUnFreezingAssetTransactions.RemoveTx(hash);
+    mapAddressAddedTag.RemoveTx(hash);
+    mapAddressRemoveTag.RemoveTx(hash);
     /** RVN END */
 }
 
@@ -872,7 +815,7 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
     /** RVN START */
     // Get the newly added assets, and make sure they are in the entries
     std::vector<CTransaction> trans;
-    for (auto it : connectedBlockData.newAssetsToAdd) {
+    for (const auto& it : connectedBlockData.newAssetsToAdd) {
         if (mapAssetToHash.count(it.asset.strName)) {
             indexed_transaction_set::iterator i = mapTx.find(mapAssetToHash.at(it.asset.strName));
             if (i != mapTx.end()) {
@@ -883,9 +826,9 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
         }
     }
 
-    for (auto it : connectedBlockData.newVerifiersToAdd) {
-        if (mapAssetVerifierChanged.count(it.assetName)) {
-            for (auto hash : mapAssetVerifierChanged.at(it.assetName)) {
+    for (const auto& it : connectedBlockData.newVerifiersToAdd) {
+        if (const CMempoolRestrictedIndex::TxList* pTxs = mapAssetVerifierChanged.Find(it.assetName)) {
+            for (const auto& hash : *pTxs) {
                 indexed_transaction_set::iterator i = mapTx.find(hash);
                 if (i != mapTx.end()) {
                     CValidationState state;
@@ -899,9 +842,9 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
         }
     }
 
-    for (auto it : connectedBlockData.newQualifiersToAdd) {
-        if (mapAddressesQualifiersChanged.count(it.address)) {
-            for (auto hash : mapAddressesQualifiersChanged.at(it.address)) {
+    for (const auto& it : connectedBlockData.newQualifiersToAdd) {
+        if (const CMempoolRestrictedIndex::TxList* pTxs = mapAddressesQualifiersChanged.Find(it.address)) {
+            for (const auto& hash : *pTxs) {
                 indexed_transaction_set::iterator i = mapTx.find(hash);
                 if (i != mapTx.end()) {
                     CValidationState state;
@@ -915,10 +858,10 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
         }
     }
 
-    for (auto it : connectedBlockData.newGlobalRestrictionsToAdd) {
+    for (const auto& it : connectedBlockData.newGlobalRestrictionsToAdd) {
         if (it.type == RestrictedType::GLOBAL_FREEZE) {
-            if (mapAssetMarkedGlobalFrozen.count(it.assetName)) {
-                for (auto hash : mapAssetMarkedGlobalFrozen.at(it.assetName)) {
+            if (const CMempoolRestrictedIndex::TxList* pTxs = mapAssetMarkedGlobalFrozen.Find(it.assetName)) {
+                for (const auto& hash : *pTxs) {
                     indexed_transaction_set::iterator i = mapTx.find(hash);
                     if (i != mapTx.end()) {
                         CValidationState state;
@@ -931,8 +874,8 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
                 }
             }
 
-            if (mapGlobalFreezingAssetTransactions.count(it.assetName)) {
-                for (auto hash : mapGlobalFreezingAssetTransactions.at(it.assetName)) {
+            if (const CMempoolRestrictedIndex::TxList* pTxs = mapGlobalFreezingAssetTransactions.Find(it.assetName)) {
+                for (const auto& hash : *pTxs) {
                     indexed_transaction_set::iterator i = mapTx.find(hash);
                     if (i != mapTx.end()) {
                         CValidationState state;
@@ -945,8 +888,8 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
                 }
             }
         } else if (it.type == RestrictedType::GLOBAL_UNFREEZE) {
-            if (mapGlobalUnFreezingAssetTransactions.count(it.assetName)) {
-                for (auto hash : mapGlobalUnFreezingAssetTransactions.at(it.assetName)) {
+            if (const CMempoolRestrictedIndex::TxList* pTxs = mapGlobalUnFreezingAssetTransactions.Find(it.assetName)) {
+                for (const auto& hash : *pTxs) {
                     indexed_transaction_set::iterator i = mapTx.find(hash);
                     if (i != mapTx.end()) {
                         CValidationState state;
@@ -961,11 +904,10 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
         }
     }
 
-    for (auto it : connectedBlockData.newAddressRestrictionsToAdd) {
+    for (const auto& it : connectedBlockData.newAddressRestrictionsToAdd) {
         if (it.type == RestrictedType::FREEZE_ADDRESS) {
-            auto pair = std::make_pair(it.address, it.assetName);
-            if (mapAddressesMarkedFrozen.count(pair)) {
-                for (auto hash : mapAddressesMarkedFrozen.at(pair)) {
+            if (const CMempoolRestrictedIndex::TxList* pTxs = mapAddressesMarkedFrozen.Find(it.address, it.assetName)) {
+                for (const auto& hash : *pTxs) {
                     indexed_transaction_set::iterator i = mapTx.find(hash);
                     if (i != mapTx.end()) {
                         CValidationState state;
@@ -1029,25 +971,18 @@ void CTxMemPool::_clear()
     mapAssetToHash.clear();
     mapHashToAsset.clear();
 
-    mapAddressesMarkedFrozen.clear();
-    mapHashToAddressMarkedFrozen.clear();
-    mapAssetMarkedGlobalFrozen.clear();
-    mapHashMarkedGlobalFrozen.clear();
-    mapAddressesQualifiersChanged.clear();
-    mapHashQualifiersChanged.clear();
-    mapAssetVerifierChanged.clear();
-    mapHashVerifierChanged.clear();
+    mapAddressesMarkedFrozen.Clear();
+    mapAssetMarkedGlobalFrozen.Clear();
+    mapAddressesQualifiersChanged.Clear();
+    mapAssetVerifierChanged.Clear();
 
-    mapHashToAddressAddedTag.clear();
-    mapAddressAddedTag.clear();
-    mapHashToAddressRemoveTag.clear();
-    mapAddressRemoveTag.clear();
+    mapAddressAddedTag.Clear();
+    mapAddressRemoveTag.Clear();
 
-    mapGlobalFreezingAssetTransactions.clear();
-    mapHashGlobalFreezingAssetTransactions.clear();
+    mapGlobalFreezingAssetTransactions.Clear();
 
-    mapGlobalUnFreezingAssetTransactions.clear();
-    mapHashGlobalUnFreezingAssetTransactions.clear();
+    mapGlobalUnFreezingAssetTransactions.Clear();
+    restrictedNames.Clear();
 }
 
 void CTxMemPool::clear()
@@ -1208,6 +1143,24 @@ bool CTxMemPool::CompareDepthAndScore(const uint256& hasha, const uint256& hashb
     return counta < countb;
 }
 
+void CTxMemPool::GetRelayOrderKeys(const std::vector<uint256>& vHashes, std::vector<TxRelayOrderKey>& vKeys) const
+{
+    vKeys.clear();
+    vKeys.reserve(vHashes.size());
+
+    LOCK(cs);
+    for (const uint256& hash : vHashes) {
+        TxRelayOrderKey key;
+        key.hash = hash;
+        indexed_transaction_set::const_iterator i = mapTx.find(hash);
+        key.fInMempool = i != mapTx.end();
+        key.nCountWithAncestors = key.fInMempool ? i->GetCountWithAncestors() : 0;
+        key.nModFee = key.fInMempool ? i->GetModifiedFee() : 0;
+        key.nTxSize = key.fInMempool ? i->GetTxSize() : 0;
+        vKeys.push_back(key);
+    }
+}
+
 namespace {
 class DepthAndScoreComparator
 {
@@ -1362,7 +1315,15 @@ bool CCoinsViewMemPool::GetCoin(const COutPoint &outpoint, Coin &coin) const {
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
     // Estimate the overhead of mapTx to be 15 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage + RestrictedIndexesUsage();
+}
+
+size_t CTxMemPool::RestrictedIndexesUsage() const {
+    return restrictedNames.DynamicMemoryUsage() +
+           mapAddressesMarkedFrozen.DynamicMemoryUsage() + mapAssetMarkedGlobalFrozen.DynamicMemoryUsage() +
+           mapAddressesQualifiersChanged.DynamicMemoryUsage() + mapAssetVerifierChanged.DynamicMemoryUsage() +
+           mapGlobalFreezingAssetTransactions.DynamicMemoryUsage() + mapGlobalUnFreezingAssetTransactions.DynamicMemoryUsage() +
+           mapAddressAddedTag.DynamicMemoryUsage() + mapAddressRemoveTag.DynamicMemoryUsage();
 }
 
 void CTxMemPool::RemoveStaged(setEntries &stage, bool updateDescendants, MemPoolRemovalReason reason) {
@@ -1518,3 +1479,163 @@ bool CTxMemPool::TransactionWithinChainLimit(const uint256& txid, size_t chainLi
 }
 
 SaltedTxidHasher::SaltedTxidHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+SaltedStringHasher::SaltedStringHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+// Heap used by a string, nothing when it fits in the string itself
+static size_t NameUsage(const std::string& str)
+{
+    return str.capacity() > 15 ? memusage::MallocUsage(str.capacity() + 1) : 0;
+}
+
+uint32_t CMempoolNameTable::Acquire(const std::string& str)
+{
+    auto it = mapIds.find(str);
+    if (it == mapIds.end()) {
+        uint32_t nId;
+        if (vFreeIds.empty()) {
+            nId = vNames.size();
+            vNames.push_back(nullptr);
+        } else {
+            nId = vFreeIds.back();
+            vFreeIds.pop_back();
+        }
+        it = mapIds.emplace(str, Entry{nId, 0}).first;
+        vNames[nId] = &it->first;
+        nNameUsage += NameUsage(it->first);
+    }
+    it->second.nRefs++;
+    return it->second.nId;
+}
+
+void CMempoolNameTable::Release(uint32_t nId)
+{
+    assert(nId < vNames.size() && vNames[nId]);
+    auto it = mapIds.find(*vNames[nId]);
+    assert(it != mapIds.end());
+    if (--it->second.nRefs == 0) {
+        nNameUsage -= NameUsage(it->first);
+        vNames[nId] = nullptr;
+        vFreeIds.push_back(nId);
+        mapIds.erase(it);
+    }
+}
+
+bool CMempoolNameTable::Find(const std::string& str, uint32_t& nId) const
+{
+    auto it = mapIds.find(str);
+    if (it == mapIds.end())
+        return false;
+    nId = it->second.nId;
+    return true;
+}
+
+void CMempoolNameTable::Clear()
+{
+    mapIds.clear();
+    vNames.clear();
+    vFreeIds.clear();
+    nNameUsage = 0;
+}
+
+size_t CMempoolNameTable::DynamicMemoryUsage() const
+{
+    // An empty unordered_map has not allocated its buckets yet
+    return (mapIds.empty() ? 0 : memusage::DynamicUsage(mapIds)) + memusage::DynamicUsage(vNames) + memusage::DynamicUsage(vFreeIds) + nNameUsage;
+}
+
+void CMempoolRestrictedIndex::Insert(const std::string& strFirst, const std::string* pstrSecond, const uint256& hash)
+{
+    uint32_t nFirst = names.Acquire(strFirst);
+    uint32_t nSecond = pstrSecond ? names.Acquire(*pstrSecond) : NO_ID;
+    Key key = MakeKey(nFirst, nSecond);
+
+    // The ids taken above are held for as long as the key is in mapTxs
+    auto it = mapTxs.find(key);
+    bool fNewKey = it == mapTxs.end();
+    if (!fNewKey) {
+        names.Release(nFirst);
+        if (nSecond != NO_ID)
+            names.Release(nSecond);
+    }
+
+    // A transaction spending several coins of the same asset and address is listed once
+    prevector<4, KeyPos>& vKeys = mapKeys[hash];
+    if (!fNewKey) {
+        for (const KeyPos& keypos : vKeys)
+            if (keypos.key == key)
+                return;
+    } else {
+        it = mapTxs.emplace(key, TxList()).first;
+    }
+
+    nListUsage -= memusage::DynamicUsage(vKeys) + memusage::DynamicUsage(it->second);
+    vKeys.push_back(KeyPos{key, (uint32_t)it->second.size()});
+    it->second.push_back(hash);
+    nListUsage += memusage::DynamicUsage(vKeys) + memusage::DynamicUsage(it->second);
+}
+
+const CMempoolRestrictedIndex::TxList* CMempoolRestrictedIndex::Find(const std::string& strFirst, const std::string* pstrSecond) const
+{
+    uint32_t nFirst, nSecond = NO_ID;
+    if (!names.Find(strFirst, nFirst) || (pstrSecond && !names.Find(*pstrSecond, nSecond)))
+        return nullptr;
+    auto it = mapTxs.find(MakeKey(nFirst, nSecond));
+    if (it == mapTxs.end())
+        return nullptr;
+    return &it->second;
+}
+
+void CMempoolRestrictedIndex::RemoveTx(const uint256& hash)
+{
+    auto itKeys = mapKeys.find(hash);
+    if (itKeys == mapKeys.end())
+        return;
+
+    for (const KeyPos& keypos : itKeys->second) {
+        auto it = mapTxs.find(keypos.key);
+        assert(it != mapTxs.end());
+        TxList& vTxs = it->second;
+        assert(keypos.nPos < vTxs.size() && vTxs[keypos.nPos] == hash);
+        if (vTxs.size() == 1) {
+            nListUsage -= memusage::DynamicUsage(vTxs);
+            mapTxs.erase(it);
+            names.Release(keypos.key >> 32);
+            if ((uint32_t)keypos.key != NO_ID)
+                names.Release((uint32_t)keypos.key);
+            continue;
+        }
+
+        // Move the last transaction into the gap and tell it where it went
+        const uint256 hashMoved = vTxs.back();
+        if (hashMoved != hash) {
+            vTxs[keypos.nPos] = hashMoved;
+            for (KeyPos& keyposMoved : mapKeys.at(hashMoved)) {
+                if (keyposMoved.key == keypos.key) {
+                    keyposMoved.nPos = keypos.nPos;
+                    break;
+                }
+            }
+        }
+        nListUsage -= memusage::DynamicUsage(vTxs);
+        vTxs.pop_back();
+        nListUsage += memusage::DynamicUsage(vTxs);
+    }
+    nListUsage -= memusage::DynamicUsage(itKeys->second);
+    mapKeys.erase(itKeys);
+}
+
+void CMempoolRestrictedIndex::Clear()
+{
+    // The name table is cleared along with every index using it
+    mapTxs.clear();
+    mapKeys.clear();
+    nListUsage = 0;
+}
+
+size_t CMempoolRestrictedIndex::DynamicMemoryUsage() const
+{
+    if (mapKeys.empty())
+        return 0;
+    return memusage::DynamicUsage(mapTxs) + memusage::DynamicUsage(mapKeys) + nListUsage;
+}
@@ -10,6 +10,7 @@
 #include <memory>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <string>
@@ -20,6 +21,7 @@
 #include "coins.h"
 #include "indirectmap.h"
 #include "policy/feerate.h"
+#include "prevector.h"
 #include "primitives/transaction.h"
 #include "sync.h"
 #include "random.h"
@@ -256,6 +258,33 @@ public:
     }
 };
 
+/** The fields CTxMemPool::CompareDepthAndScore orders by, copied out of the mempool so that
+ *  many transactions can be ordered for relay without repeated lookups under cs */
+struct TxRelayOrderKey
+{
+    uint256 hash;
+    bool fInMempool;
+    uint64_t nCountWithAncestors;
+    CAmount nModFee;
+    size_t nTxSize;
+
+    /** Same order as CompareDepthAndScore: fewest ancestors, then highest score, first.
+     *  Transactions no longer in the mempool sort last */
+    bool operator<(const TxRelayOrderKey& other) const
+    {
+        if (!fInMempool) return false;
+        if (!other.fInMempool) return true;
+        if (nCountWithAncestors != other.nCountWithAncestors)
+            return nCountWithAncestors < other.nCountWithAncestors;
+        double f1 = (double)nModFee * other.nTxSize;
+        double f2 = (double)other.nModFee * nTxSize;
+        if (f1 == f2) {
+            return other.hash < hash;
+        }
+        return f1 > f2;
+    }
+};
+
 class CompareTxMemPoolEntryByEntryTime
 {
 public:
@@ -341,6 +370,99 @@ public:
     }
 };
 
+class SaltedStringHasher
+{
+private:
+    /** Salt */
+    const uint64_t k0, k1;
+
+public:
+    SaltedStringHasher();
+
+    size_t operator()(const std::string& str) const {
+        return CSipHasher(k0, k1).Write((const unsigned char*)str.data(), str.size()).Finalize();
+    }
+};
+
+/**
+ * Gives each asset name and address the restricted asset indexes refer to a
+ * small id, so those indexes hash and compare integers rather than strings.
+ * Ids are reference counted and reused once nothing refers to them.
+ */
+class CMempoolNameTable
+{
+private:
+    struct Entry {
+        uint32_t nId;
+        uint32_t nRefs;
+    };
+    std::unordered_map<std::string, Entry, SaltedStringHasher> mapIds;
+    std::vector<const std::string*> vNames; //!< id -> name, nullptr for free ids
+    std::vector<uint32_t> vFreeIds;
+    size_t nNameUsage;                      //!< heap used by the names themselves
+
+public:
+    CMempoolNameTable() : nNameUsage(0) {}
+
+    //! Return the id of str, adding a reference to it
+    uint32_t Acquire(const std::string& str);
+    //! Drop a reference taken by Acquire
+    void Release(uint32_t nId);
+    bool Find(const std::string& str, uint32_t& nId) const;
+    void Clear();
+    size_t DynamicMemoryUsage() const;
+};
+
+/**
+ * Mempool transactions involving a restricted asset name or an (address,
+ * asset name) pair, and for each of those transactions the keys it is listed
+ * under so that it can be removed again. Both sides are hash maps keyed on
+ * interned ids with small inline lists as values. Lists are unordered, so a
+ * transaction is removed by moving the last one into its place.
+ */
+class CMempoolRestrictedIndex
+{
+public:
+    typedef prevector<2, uint256> TxList;
+
+private:
+    typedef uint64_t Key;
+    static const uint32_t NO_ID = std::numeric_limits<uint32_t>::max();
+
+    //! A key a transaction is listed under, and where in that key's list it is
+    struct KeyPos {
+        Key key;
+        uint32_t nPos;
+    };
+
+    CMempoolNameTable& names;
+    std::unordered_map<Key, TxList> mapTxs;
+    std::unordered_map<uint256, prevector<4, KeyPos>, SaltedTxidHasher> mapKeys;
+    size_t nListUsage; //!< heap used by lists that outgrew their inline space
+
+    static Key MakeKey(uint32_t nFirst, uint32_t nSecond) { return ((Key)nFirst << 32) | nSecond; }
+    void Insert(const std::string& strFirst, const std::string* pstrSecond, const uint256& hash);
+    const TxList* Find(const std::string& strFirst, const std::string* pstrSecond) const;
+
+public:
+    explicit CMempoolRestrictedIndex(CMempoolNameTable& namesIn) : names(namesIn), nListUsage(0) {}
+
+    void Insert(const std::string& strName, const uint256& hash) { Insert(strName, nullptr, hash); }
+    void Insert(const std::string& strAddress, const std::string& strName, const uint256& hash) { Insert(strAddress, &strName, hash); }
+
+    //! The transactions listed under a key, or nullptr if there are none
+    const TxList* Find(const std::string& strName) const { return Find(strName, nullptr); }
+    const TxList* Find(const std::string& strAddress, const std::string& strName) const { return Find(strAddress, &strName); }
+
+    bool Exists(const std::string& strName) const { return Find(strName) != nullptr; }
+    bool Exists(const std::string& strAddress, const std::string& strName) const { return Find(strAddress, strName) != nullptr; }
+
+    //! Remove a transaction from every key it is listed under
+    void RemoveTx(const uint256& hash);
+    void Clear();
+    size_t DynamicMemoryUsage() const;
+};
+
 /**
  * CTxMemPool stores valid-according-to-the-current-best-chain transactions
  * that may be included in the next block.
@@ -472,36 +594,31 @@ public:
     std::map<uint256, std::string> mapHashToAsset;
 
     /** Restricted assets maps */
-    // Helper maps for when addresses are marked as frozen
-    std::map<std::pair<std::string, std::string>, std::set<uint256> > mapAddressesMarkedFrozen;
-    std::map<uint256, std::set<std::pair<std::string, std::string>>> mapHashToAddressMarkedFrozen;
+    // Asset names and addresses the maps below are keyed on
+    CMempoolNameTable restrictedNames;
+
+    // Helper maps for when addresses are marked as frozen, keyed on (address, asset name)
+    CMempoolRestrictedIndex mapAddressesMarkedFrozen{restrictedNames};
 
     // Helper maps for when restricted assets are globally frozen
-    std::map<std::string, std::set<uint256>> mapAssetMarkedGlobalFrozen;
-    std::map<uint256, std::set<std::string>> mapHashMarkedGlobalFrozen;
+    CMempoolRestrictedIndex mapAssetMarkedGlobalFrozen{restrictedNames};
 
     // Helper maps for when qualifiers are added or removed from addresses
-    std::map<std::string, std::set<uint256>> mapAddressesQualifiersChanged;
-    std::map<uint256, std::set<std::string>> mapHashQualifiersChanged;
+    CMempoolRestrictedIndex mapAddressesQualifiersChanged{restrictedNames};
 
     // Helper maps for when verifier string are changed
-    std::map<std::string, std::set<uint256>> mapAssetVerifierChanged;
-    std::map<uint256, std::set<std::string>> mapHashVerifierChanged;
+    CMempoolRestrictedIndex mapAssetVerifierChanged{restrictedNames};
 
     // Helper map for when an asset already in mempool that is globally freezing
-    std::map<std::string, std::set<uint256>> mapGlobalFreezingAssetTransactions;
-    std::map<uint256, std::set<std::string>> mapHashGlobalFreezingAssetTransactions;
+    CMempoolRestrictedIndex mapGlobalFreezingAssetTransactions{restrictedNames};
 
-    // Helper map for when a qualfier is added to an address
-    std::map<std::pair<std::string, std::string>, std::set<uint256> > mapAddressAddedTag;
-    std::map<uint256, std::set<std::pair<std::string, std::string>>> mapHashToAddressAddedTag;
+    // Helper map for when a qualfier is added to an address, keyed on (address, qualifier)
+    CMempoolRestrictedIndex mapAddressAddedTag{restrictedNames};
 
-    // Helper map for when a qualfier is added to an address
-    std::map<std::pair<std::string, std::string>, std::set<uint256> > mapAddressRemoveTag;
-    std::map<uint256, std::set<std::pair<std::string, std::string>>> mapHashToAddressRemoveTag;
+    // Helper map for when a qualfier is removed from an address, keyed on (address, qualifier)
+    CMempoolRestrictedIndex mapAddressRemoveTag{restrictedNames};
 
-    std::map<std::string, std::set<uint256>> mapGlobalUnFreezingAssetTransactions;
-    std::map<uint256, std::set<std::string>> mapHashGlobalUnFreezingAssetTransactions;
+    CMempoolRestrictedIndex mapGlobalUnFreezingAssetTransactions{restrictedNames};
 
     typedef indexed_transaction_set::nth_index<0>::type::iterator txiter;
     std::vector<std::pair<uint256, txiter> > vTxHashes; //!< All tx witness hashes/entries in mapTx, in random order
@@ -587,6 +704,8 @@ public:
     void clear();
     void _clear(); //lock free
     bool CompareDepthAndScore(const uint256& hasha, const uint256& hashb);
+    /** Fill vKeys with the relay order keys of vHashes, taking cs once */
+    void GetRelayOrderKeys(const std::vector<uint256>& vHashes, std::vector<TxRelayOrderKey>& vKeys) const;
     void queryHashes(std::vector<uint256>& vtxid);
     bool isSpent(const COutPoint& outpoint);
     unsigned int GetTransactionsUpdated() const;
@@ -683,6 +802,8 @@ public:
     std::vector<TxMempoolInfo> infoAll() const;
 
     size_t DynamicMemoryUsage() const;
+    //! Memory used by the restricted asset maps, included in DynamicMemoryUsage
+    size_t RestrictedIndexesUsage() const;
 
     boost::signals2::signal<void (CTransactionRef)> NotifyEntryAdded;
     boost::signals2::signal<void (CTransactionRef, MemPoolRemovalReason)> NotifyEntryRemoved;
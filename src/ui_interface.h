@@ -7,6 +7,7 @@
 #ifndef RAVEN_UI_INTERFACE_H
 #define RAVEN_UI_INTERFACE_H
 
+#include <set>
 #include <stdint.h>
 #include <string>
 
@@ -113,6 +114,9 @@ public:
 
     /** Banlist did change. */
     boost::signals2::signal<void (void)> BannedListChanged;
+
+    /** Assets were issued, reissued or removed by a block being connected or disconnected */
+    boost::signals2::signal<void (const std::set<std::string>& assetNames)> NotifyAssetDataChanged;
 };
 
 /** Show warning message **/
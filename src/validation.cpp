@@ -15,6 +15,7 @@
 #include "consensus/merkle.h"
 #include "consensus/tx_verify.h"
 #include "consensus/validation.h"
+#include "crypto/common.h"
 #include "cuckoocache.h"
 #include "fs.h"
 #include "hash.h"
@@ -45,7 +46,14 @@
 #include "net.h"
 
 #include <atomic>
+#include <list>
 #include <sstream>
+#include <thread>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/join.hpp>
@@ -106,6 +114,7 @@ bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
 size_t nCoinCacheUsage = 5000 * 300;
+unsigned int nTxIndexCacheSize = DEFAULT_TXINDEX_CACHE;
 uint64_t nPruneTarget = 0;
 int64_t nMaxTipAge = DEFAULT_MAX_TIP_AGE;
 bool fEnableReplacement = DEFAULT_ENABLE_REPLACEMENT;
@@ -238,6 +247,7 @@ CBlockTreeDB *pblocktree = nullptr;
 CAssetsDB *passetsdb = nullptr;
 CAssetsCache *passets = nullptr;
 CLRUCache<std::string, CDatabasedAssetData> *passetsCache = nullptr;
+CLRUCache<std::string, std::shared_ptr<const std::vector<unsigned char>>> *passetsDataPayloadCache = nullptr;
 CLRUCache<std::string, CMessage> *pMessagesCache = nullptr;
 CLRUCache<std::string, int> *pMessageSubscribedChannelsCache = nullptr;
 CLRUCache<std::string, int> *pMessagesSeenAddressCache = nullptr;
@@ -478,6 +488,34 @@ void UpdateMempoolForReorg(DisconnectedBlockTransactions &disconnectpool, bool f
     LimitMempoolSize(mempool, gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000, gArgs.GetArg("-mempoolexpiry", DEFAULT_MEMPOOL_EXPIRY) * 60 * 60);
 }
 
+static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+
+/**
+ * Script-check a loose transaction's inputs for mempool acceptance. Transactions with many inputs
+ * have their per-input script checks spread over the script verification threads (the same ones
+ * ConnectBlock uses; both run under cs_main, so they never compete for the queue). If any check
+ * fails, the inputs are re-checked serially so that state carries the exact reject reason and
+ * DoS score of the failing input, as it would have without the parallel pass.
+ */
+static bool CheckInputsForMempool(const CTransaction& tx, CValidationState &state, const CCoinsViewCache &view,
+                 unsigned int flags, bool cacheSigStore, PrecomputedTransactionData& txdata) {
+    AssertLockHeld(cs_main);
+
+    if (!nScriptCheckThreads || tx.vin.size() < MEMPOOL_PARALLEL_SCRIPTCHECK_MIN_INPUTS)
+        return CheckInputs(tx, state, view, true, flags, cacheSigStore, false, txdata);
+
+    std::vector<CScriptCheck> vChecks;
+    if (!CheckInputs(tx, state, view, true, flags, cacheSigStore, false, txdata, &vChecks))
+        return false;
+
+    CCheckQueueControl<CScriptCheck> control(&scriptcheckqueue);
+    control.Add(vChecks);
+    if (control.Wait())
+        return true;
+
+    return CheckInputs(tx, state, view, true, flags, cacheSigStore, false, txdata);
+}
+
 // Used to avoid mempool polluting consensus critical paths if CCoinsViewMempool
 // were somehow broken and returning the wrong scriptPubKeys
 static bool CheckInputsFromMempoolAndCache(const CTransaction& tx, CValidationState &state, const CCoinsViewCache &view, CTxMemPool& pool,
@@ -889,7 +927,7 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
         // Check against previous transactions
         // This is done last to help prevent CPU exhaustion denial-of-service attacks.
         PrecomputedTransactionData txdata(tx);
-        if (!CheckInputs(tx, state, view, true, scriptVerifyFlags, true, false, txdata)) {
+        if (!CheckInputsForMempool(tx, state, view, scriptVerifyFlags, true, txdata)) {
             // SCRIPT_VERIFY_CLEANSTACK requires SCRIPT_VERIFY_WITNESS, so we
             // need to turn both off, and compare against just turning off CLEANSTACK
             // to see if the failure is specifically due to witness validation.
@@ -1001,29 +1039,25 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
                     if (AreRestrictedAssetsDeployed()) {
                         if (IsAssetNameAnRestricted(data.assetName)) {
                             std::string address = EncodeDestination(data.destination);
-                            pool.mapAddressesQualifiersChanged[address].insert(hash);
-                            pool.mapHashQualifiersChanged[hash].insert(address);
+                            pool.mapAddressesQualifiersChanged.Insert(address, hash);
 
-                            pool.mapAssetVerifierChanged[data.assetName].insert(hash);
-                            pool.mapHashVerifierChanged[hash].insert(data.assetName);
+                            pool.mapAssetVerifierChanged.Insert(data.assetName, hash);
                         }
                     }
                 } else if (out.scriptPubKey.IsNullGlobalRestrictionAssetTxDataScript()) {
                     CNullAssetTxData globalNullData;
                     if (GlobalAssetNullDataFromScript(out.scriptPubKey, globalNullData)) {
                         if (globalNullData.flag == 1) {
-                            if (pool.mapGlobalFreezingAssetTransactions.count(globalNullData.asset_name)) {
+                            if (pool.mapGlobalFreezingAssetTransactions.Exists(globalNullData.asset_name)) {
                                 return state.DoS(0, false, REJECT_INVALID, "bad-txns-global-freeze-already-in-mempool");
                             } else {
-                                pool.mapGlobalFreezingAssetTransactions[globalNullData.asset_name].insert(tx.GetHash());
-                                pool.mapHashGlobalFreezingAssetTransactions[tx.GetHash()].insert(globalNullData.asset_name);
+                                pool.mapGlobalFreezingAssetTransactions.Insert(globalNullData.asset_name, tx.GetHash());
                             }
                         } else if (globalNullData.flag == 0) {
-                            if (pool.mapGlobalUnFreezingAssetTransactions.count(globalNullData.asset_name)) {
+                            if (pool.mapGlobalUnFreezingAssetTransactions.Exists(globalNullData.asset_name)) {
                                 return state.DoS(0, false, REJECT_INVALID, "bad-txns-global-unfreeze-already-in-mempool");
                             } else {
-                                pool.mapGlobalUnFreezingAssetTransactions[globalNullData.asset_name].insert(tx.GetHash());
-                                pool.mapHashGlobalUnFreezingAssetTransactions[tx.GetHash()].insert(globalNullData.asset_name);
+                                pool.mapGlobalUnFreezingAssetTransactions.Insert(globalNullData.asset_name, tx.GetHash());
                             }
                         }
                     }
@@ -1035,21 +1069,19 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
                     if (AssetNullDataFromScript(out.scriptPubKey, addressNullData, address)) {
                         if (IsAssetNameAQualifier(addressNullData.asset_name)) {
                             if (addressNullData.flag == (int) QualifierType::ADD_QUALIFIER) {
-                                if (pool.mapAddressAddedTag.count(std::make_pair(address, addressNullData.asset_name))) {
+                                if (pool.mapAddressAddedTag.Exists(address, addressNullData.asset_name)) {
                                     return state.DoS(0, false, REJECT_INVALID,
                                                      "bad-txns-adding-tag-already-in-mempool");
                                 }
                                 // Adding a qualifier to an address
-                                pool.mapAddressAddedTag[std::make_pair(address, addressNullData.asset_name)].insert(tx.GetHash());
-                                pool.mapHashToAddressAddedTag[tx.GetHash()].insert(std::make_pair(address, addressNullData.asset_name));
+                                pool.mapAddressAddedTag.Insert(address, addressNullData.asset_name, tx.GetHash());
                             } else {
-                                    if (pool.mapAddressRemoveTag.count(std::make_pair(address, addressNullData.asset_name))) {
+                                    if (pool.mapAddressRemoveTag.Exists(address, addressNullData.asset_name)) {
                                         return state.DoS(0, false, REJECT_INVALID,
                                                          "bad-txns-remove-tag-already-in-mempool");
                                     }
 
-                                pool.mapAddressRemoveTag[std::make_pair(address, addressNullData.asset_name)].insert(tx.GetHash());
-                                pool.mapHashToAddressRemoveTag[tx.GetHash()].insert(std::make_pair(address, addressNullData.asset_name));
+                                pool.mapAddressRemoveTag.Insert(address, addressNullData.asset_name, tx.GetHash());
                             }
                         }
                     }
@@ -1069,12 +1101,8 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
                 if (GetAssetData(coin.out.scriptPubKey, data)) {
 
                     if (IsAssetNameAnRestricted(data.assetName)) {
-                        pool.mapAssetMarkedGlobalFrozen[data.assetName].insert(hash);
-                        pool.mapHashMarkedGlobalFrozen[hash].insert(data.assetName);
-
-                        auto pair = std::make_pair(EncodeDestination(data.destination), data.assetName);
-                        pool.mapAddressesMarkedFrozen[pair].insert(hash);
-                        pool.mapHashToAddressMarkedFrozen[hash].insert(pair);
+                        pool.mapAssetMarkedGlobalFrozen.Insert(data.assetName, hash);
+                        pool.mapAddressesMarkedFrozen.Insert(EncodeDestination(data.destination), data.assetName, hash);
                     }
                 }
             }
@@ -1212,20 +1240,24 @@ bool GetTransaction(const uint256 &hash, CTransactionRef &txOut, const Consensus
     if (fTxIndex) {
         CDiskTxPos postx;
         if (pblocktree->ReadTxIndex(hash, postx)) {
-            CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
-            if (file.IsNull())
-                return error("%s: OpenBlockFile failed", __func__);
-            CBlockHeader header;
-            try {
-                file >> header;
-                fseek(file.Get(), postx.nTxOffset, SEEK_CUR);
-                file >> txOut;
-            } catch (const std::exception& e) {
-                return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+            // Transactions recently read from disk. The cached position must still match the
+            // index, which rewrites it when the transaction is connected in a different block.
+            static CLRUCache<uint256, std::pair<CDiskTxPos, std::pair<CTransactionRef, uint256>>, SaltedTxidHasher> txIndexCache(nTxIndexCacheSize);
+            if (txIndexCache.Exists(hash)) {
+                const auto& cached = txIndexCache.Get(hash);
+                if (cached.first.nFile == postx.nFile && cached.first.nPos == postx.nPos && cached.first.nTxOffset == postx.nTxOffset) {
+                    txOut = cached.second.first;
+                    hashBlock = cached.second.second;
+                    return true;
+                }
             }
-            hashBlock = header.GetHash();
+
+            if (!ReadTransactionFromDisk(postx, txOut, hashBlock))
+                return false;
             if (txOut->GetHash() != hash)
                 return error("%s: txid mismatch", __func__);
+            if (nTxIndexCacheSize)
+                txIndexCache.Put(hash, std::make_pair(postx, std::make_pair(txOut, hashBlock)));
             return true;
         }
 
@@ -1289,19 +1321,43 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
 {
     block.SetNull();
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+    // Every block on disk is preceded by its message start and serialized size, so the
+    // whole block can be pulled in with a single read and deserialized from memory rather
+    // than through one fread call per field. The buffer is kept per thread and reused
+    // across calls so that block-scoped reads don't hit the allocator every time.
+    static thread_local std::vector<unsigned char> vchBlockBuffer;
+
+    if (pos.nPos < sizeof(uint32_t))
+        return error("ReadBlockFromDisk: Invalid block position %s", pos.ToString());
+
+    // Open history file to read, positioned at the size field
+    CDiskBlockPos hpos = pos;
+    hpos.nPos -= sizeof(uint32_t);
+    CAutoFile filein(OpenBlockFile(hpos, true), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull())
         return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
 
     // Read block
     try {
-        filein >> block;
+        unsigned int nSize;
+        filein >> nSize;
+        if (nSize < 80 || nSize > GetMaxBlockSerializedSize())
+            return error("%s: Block size %u out of range at %s", __func__, nSize, pos.ToString());
+
+        vchBlockBuffer.resize(nSize);
+        filein.read((char*)vchBlockBuffer.data(), nSize);
+
+        VectorReader reader(SER_DISK, CLIENT_VERSION, vchBlockBuffer, 0);
+        reader >> block;
     }
     catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
 
+    // Don't pin a large buffer to the thread after reading an unusually big block
+    if (vchBlockBuffer.capacity() > MAX_BLOCK_READ_BUFFER_RETAIN)
+        std::vector<unsigned char>().swap(vchBlockBuffer);
+
     // Check the header
     if (!CheckProofOfWork(block.GetHash(), block.nBits, consensusParams))
         return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
@@ -1309,6 +1365,177 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
     return true;
 }
 
+/**
+ * Block files recently read from at txindex positions, kept open so that a
+ * lookup costs one positioned read rather than an open, a seek and a close,
+ * and the hashes of the blocks read there, which cost far more to compute
+ * than the read itself.
+ */
+class CBlockFileReadCache
+{
+private:
+    static const size_t MAX_OPEN_FILES = 8;
+    static const size_t MAX_BLOCK_HASHES = 4096;
+
+    std::mutex cs;
+    //! (nFile, descriptor), most recently used first
+    std::list<std::pair<int, int>> listFiles;
+    //! block hash by ((nFile << 32) | nPos)
+    CLRUCache<uint64_t, uint256> blockHashes{MAX_BLOCK_HASHES};
+
+    static uint64_t PosKey(const CDiskBlockPos& pos) { return ((uint64_t)pos.nFile << 32) | pos.nPos; }
+
+public:
+    ~CBlockFileReadCache()
+    {
+        for (const auto& file : listFiles)
+            CloseFile(file.second);
+    }
+
+    static void CloseFile(int fd)
+    {
+#ifndef WIN32
+        close(fd);
+#endif
+    }
+
+    //! Read up to nSize bytes of a block file at pos. Returns the number of bytes read, or -1 on error.
+    int64_t Read(const CDiskBlockPos& pos, char* pch, size_t nSize)
+    {
+#ifdef WIN32
+        CAutoFile file(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+        if (file.IsNull())
+            return -1;
+        return fread(pch, 1, nSize, file.Get());
+#else
+        std::lock_guard<std::mutex> lock(cs);
+        auto it = std::find_if(listFiles.begin(), listFiles.end(),
+            [&pos](const std::pair<int, int>& file) { return file.first == pos.nFile; });
+        if (it != listFiles.end()) {
+            listFiles.splice(listFiles.begin(), listFiles, it);
+        } else {
+            int fd = open(GetBlockPosFilename(pos, "blk").string().c_str(), O_RDONLY);
+            if (fd == -1)
+                return -1;
+            listFiles.emplace_front(pos.nFile, fd);
+            if (listFiles.size() > MAX_OPEN_FILES) {
+                CloseFile(listFiles.back().second);
+                listFiles.pop_back();
+            }
+        }
+        int fd = listFiles.front().second;
+
+        size_t nRead = 0;
+        while (nRead < nSize) {
+            ssize_t n = pread(fd, pch + nRead, nSize - nRead, pos.nPos + nRead);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+                return -1;
+            if (n == 0)
+                break;
+            nRead += n;
+        }
+        return nRead;
+#endif
+    }
+
+    bool GetBlockHash(const CDiskBlockPos& pos, uint256& hash)
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        if (!blockHashes.Exists(PosKey(pos)))
+            return false;
+        hash = blockHashes.Get(PosKey(pos));
+        return true;
+    }
+
+    void SetBlockHash(const CDiskBlockPos& pos, const uint256& hash)
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        blockHashes.Put(PosKey(pos), hash);
+    }
+
+    //! Forget a block file that is about to be deleted
+    void Close(int nFile)
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        blockHashes.Clear();
+        for (auto it = listFiles.begin(); it != listFiles.end(); ++it) {
+            if (it->first == nFile) {
+                CloseFile(it->second);
+                listFiles.erase(it);
+                return;
+            }
+        }
+    }
+};
+
+static CBlockFileReadCache blockFileReadCache;
+
+bool ReadTransactionFromDisk(const CDiskTxPos& postx, CTransactionRef& txOut, uint256& hashBlock)
+{
+    // Enough for the block size field and the largest block header
+    static const size_t HEADER_READ_SIZE = sizeof(uint32_t) + 128;
+    // Enough for most transactions; a larger one is read again with a bigger window
+    static const size_t TX_READ_GUESS = 2048;
+    static thread_local std::vector<unsigned char> vchTxBuffer;
+
+    if (postx.nPos < sizeof(uint32_t))
+        return error("%s: Invalid transaction position %s", __func__, postx.ToString());
+
+    // Read the size field and the header, which locates the transaction and hashes the block
+    CDiskBlockPos hpos(postx.nFile, postx.nPos - sizeof(uint32_t));
+    vchTxBuffer.resize(HEADER_READ_SIZE);
+    int64_t nRead = blockFileReadCache.Read(hpos, (char*)vchTxBuffer.data(), HEADER_READ_SIZE);
+    if (nRead < (int64_t)sizeof(uint32_t))
+        return error("%s: Failed to read block file at %s", __func__, postx.ToString());
+    vchTxBuffer.resize(nRead);
+
+    uint32_t nBlockSize = ReadLE32(vchTxBuffer.data());
+    if (nBlockSize < 80 || nBlockSize > GetMaxBlockSerializedSize())
+        return error("%s: Block size %u out of range at %s", __func__, nBlockSize, postx.ToString());
+
+    CBlockHeader header;
+    size_t nHeaderSize;
+    try {
+        VectorReader reader(SER_DISK, CLIENT_VERSION, vchTxBuffer, sizeof(uint32_t));
+        reader >> header;
+        nHeaderSize = vchTxBuffer.size() - sizeof(uint32_t) - reader.size();
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), postx.ToString());
+    }
+    if (nHeaderSize + postx.nTxOffset >= nBlockSize)
+        return error("%s: Transaction offset out of range at %s", __func__, postx.ToString());
+
+    // Then just the transaction, never reading past the end of the block
+    CDiskBlockPos txpos(postx.nFile, postx.nPos + nHeaderSize + postx.nTxOffset);
+    size_t nMaxSize = nBlockSize - nHeaderSize - postx.nTxOffset;
+    for (size_t nSize = std::min(TX_READ_GUESS, nMaxSize); ; nSize = std::min(nSize * 8, nMaxSize)) {
+        vchTxBuffer.resize(nSize);
+        if (blockFileReadCache.Read(txpos, (char*)vchTxBuffer.data(), nSize) != (int64_t)nSize)
+            return error("%s: Failed to read block file at %s", __func__, postx.ToString());
+        try {
+            VectorReader reader(SER_DISK, CLIENT_VERSION, vchTxBuffer, 0);
+            reader >> txOut;
+            break;
+        } catch (const std::exception& e) {
+            if (nSize == nMaxSize)
+                return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), postx.ToString());
+        }
+    }
+
+    if (!blockFileReadCache.GetBlockHash(postx, hashBlock)) {
+        hashBlock = header.GetHash();
+        blockFileReadCache.SetBlockHash(postx, hashBlock);
+    }
+
+    // Don't pin a large buffer to the thread after reading an unusually big transaction
+    if (vchTxBuffer.capacity() > MAX_BLOCK_READ_BUFFER_RETAIN)
+        std::vector<unsigned char>().swap(vchTxBuffer);
+
+    return true;
+}
+
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
 {
     if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), consensusParams))
@@ -1841,8 +2068,14 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
     std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
 
+    // Spending the outputs being undone goes through a scratch asset cache: its bookkeeping is thrown
+    // away, only whether each asset output can be spent matters. That doesn't depend on the cache's
+    // contents, so start from an empty cache rather than copying assetsCache, which for callers that
+    // accumulate many blocks in one cache (VerifyDB, RollbackBlock) is a copy per block of everything
+    // undone so far.
+    CAssetsCache tempCache;
+
     // undo transactions in reverse order
-    CAssetsCache tempCache(*assetsCache);
     for (int i = block.vtx.size() - 1; i >= 0; i--) {
         const CTransaction &tx = *(block.vtx[i]);
         uint256 hash = tx.GetHash();
@@ -1912,7 +2145,7 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
             if (!tx.vout[o].scriptPubKey.IsUnspendable()) {
                 COutPoint out(hash, o);
                 Coin coin;
-                bool is_spent = view.SpendCoin(out, &coin, &tempCache); /** RVN START */ /* Pass assetsCache into the SpendCoin function */ /** RVN END */
+                bool is_spent = view.SpendCoin(out, &coin, assetsCache ? &tempCache : nullptr); /** RVN START */ /* Pass assetsCache into the SpendCoin function */ /** RVN END */
                 if (!is_spent || tx.vout[o] != coin.out || pindex->nHeight != coin.nHeight || is_coinbase != coin.fCoinBase) {
                     fClean = false; // transaction output mismatch
                 }
@@ -2281,8 +2514,6 @@ void static FlushBlockFile(bool fFinalize = false)
 
 static bool FindUndoPos(CValidationState &state, int nFile, CDiskBlockPos &pos, unsigned int nAddSize);
 
-static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
-
 void ThreadScriptCheck() {
     RenameThread("raven-scriptch");
     scriptcheckqueue.Thread();
@@ -2768,7 +2999,10 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         }
 
         if (vUndoAssetData.size()) {
-            if (!passetsdb->WriteBlockUndoAssetData(block.GetHash(), vUndoAssetData))
+            // During initial block download it goes to disk with the block index, in FlushStateToDisk
+            if (IsInitialBlockDownload())
+                passetsdb->AddPendingBlockUndoAssetData(block.GetHash(), vUndoAssetData);
+            else if (!passetsdb->WriteBlockUndoAssetData(block.GetHash(), vUndoAssetData))
                 return AbortNode(state, "Failed to write asset undo data");
         }
 
@@ -2928,8 +3162,11 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
                 messageCacheSize = GetMessageDirtyCacheSize();
         }
 
+        // Asset undo data held back during initial block download is only written by a flush that writes the block index
+        int64_t assetPendingUndoSize = passetsdb ? passetsdb->PendingBlockUndoDynamicMemoryUsage() : 0;
+
         int64_t nMempoolSizeMax = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
-        int64_t cacheSize = pcoinsTip->DynamicMemoryUsage() + assetDynamicSize + assetDirtyCacheSize + messageCacheSize;
+        int64_t cacheSize = pcoinsTip->DynamicMemoryUsage() + assetDynamicSize + assetDirtyCacheSize + messageCacheSize + assetPendingUndoSize;
         int64_t nTotalSpace = nCoinCacheUsage + std::max<int64_t>(nMempoolSizeMax - nMempoolUsage, 0);
         // The cache is large and we're within 10% and 10 MiB of the limit, but we have time now (not in the middle of a block processing).
         bool fCacheLarge = mode == FLUSH_STATE_PERIODIC && cacheSize > std::max((9 * nTotalSpace) / 10, nTotalSpace - MAX_BLOCK_COINSDB_USAGE * 1024 * 1024);
@@ -2955,6 +3192,10 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
                 return state.Error("out of disk space");
             // First make sure all block and undo data is flushed to disk.
             FlushBlockFile();
+            /** RVN START */
+            if (passetsdb && !passetsdb->WritePendingBlockUndoAssetData())
+                return AbortNode(state, "Failed to write asset undo data");
+            /** RVN END */
             // Then update all block file information (which may refer to block and undo files).
             {
                 std::vector<std::pair<int, const CBlockFileInfo*> > vFiles;
@@ -3117,6 +3358,38 @@ void static UpdateTip(CBlockIndex *pindexNew, const CChainParams& chainParams) {
 
 }
 
+/**
+ * Coins and mempool work shared by all DisconnectTip and ConnectTip calls of one reorganization in
+ * ActivateBestChainStep. Blocks are applied to view rather than pcoinsTip, and the mempool updates and
+ * BlockConnected notifications of connected blocks wait until CommitReorgBatch writes view back once.
+ */
+struct ReorgBatch {
+    CCoinsViewCache view;
+    //! Blocks connected so far, in order
+    std::vector<std::pair<CBlockIndex*, std::shared_ptr<const CBlock>>> vConnected;
+    //! Asset changes of the blocks connected so far, a later block's entry replacing an earlier one's
+    ConnectedBlockAssetData assetData;
+
+    explicit ReorgBatch(CCoinsView* pcoinsIn) : view(pcoinsIn) {}
+
+    template <typename T>
+    static void Merge(std::set<T>& setTo, const std::set<T>& setFrom) {
+        for (const T& item : setFrom) {
+            setTo.erase(item);
+            setTo.insert(item);
+        }
+    }
+
+    void AddConnectedBlock(CBlockIndex* pindex, std::shared_ptr<const CBlock> pblock, const ConnectedBlockAssetData& blockAssetData) {
+        vConnected.emplace_back(pindex, std::move(pblock));
+        Merge(assetData.newAssetsToAdd, blockAssetData.newAssetsToAdd);
+        Merge(assetData.newVerifiersToAdd, blockAssetData.newVerifiersToAdd);
+        Merge(assetData.newAddressRestrictionsToAdd, blockAssetData.newAddressRestrictionsToAdd);
+        Merge(assetData.newGlobalRestrictionsToAdd, blockAssetData.newGlobalRestrictionsToAdd);
+        Merge(assetData.newQualifiersToAdd, blockAssetData.newQualifiersToAdd);
+    }
+};
+
 /** Disconnect chainActive's tip.
   * After calling, the mempool will be in an inconsistent state, with
   * transactions from disconnected blocks being added to disconnectpool.  You
@@ -3126,8 +3399,11 @@ void static UpdateTip(CBlockIndex *pindexNew, const CChainParams& chainParams) {
   * If disconnectpool is nullptr, then no disconnected transactions are added to
   * disconnectpool (note that the caller is responsible for mempool consistency
   * in any case).
+  *
+  * If batch is set, the block is undone in batch->view and the chain state is
+  * not written to disk until the batch is committed.
   */
-bool static DisconnectTip(CValidationState& state, const CChainParams& chainparams, DisconnectedBlockTransactions *disconnectpool)
+bool static DisconnectTip(CValidationState& state, const CChainParams& chainparams, DisconnectedBlockTransactions *disconnectpool, ReorgBatch* batch = nullptr)
 {
     CBlockIndex *pindexDelete = chainActive.Tip();
     assert(pindexDelete);
@@ -3139,7 +3415,7 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
     // Apply the block atomically to the chain state.
     int64_t nStart = GetTimeMicros();
     {
-        CCoinsViewCache view(pcoinsTip);
+        CCoinsViewCache view(batch ? &batch->view : pcoinsTip);
         CAssetsCache assetCache;
 
         assert(view.GetBestBlock() == pindexDelete->GetBlockHash());
@@ -3153,7 +3429,7 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
     }
     LogPrint(BCLog::BENCH, "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * MILLI);
     // Write the chain state to disk, if necessary.
-    if (!FlushStateToDisk(chainparams, state, FLUSH_STATE_IF_NEEDED))
+    if (!batch && !FlushStateToDisk(chainparams, state, FLUSH_STATE_IF_NEEDED))
         return false;
 
     if (disconnectpool) {
@@ -3255,8 +3531,11 @@ public:
  * corresponding to pindexNew, to bypass loading it again from disk.
  *
  * The block is added to connectTrace if connection succeeds.
+ *
+ * If batch is set, the block is applied to batch->view, and writing the chain state,
+ * updating the mempool and adding the block to connectTrace wait for CommitReorgBatch.
  */
-bool static ConnectTip(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions &disconnectpool)
+bool static ConnectTip(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions &disconnectpool, ReorgBatch* batch)
 {
     assert(pindexNew->pprev == chainActive.Tip());
     // Read block from disk.
@@ -3284,7 +3563,7 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     /** RVN END */
 
     {
-        CCoinsViewCache view(pcoinsTip);
+        CCoinsViewCache view(batch ? &batch->view : pcoinsTip);
         /** RVN START */
         // Create the empty asset cache, that will be sent into the connect block
         // All new data will be added to the cache, and will be flushed back into passets after a successful
@@ -3340,13 +3619,17 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     }
 
     // Write the chain state to disk, if necessary.
-    if (!FlushStateToDisk(chainparams, state, FLUSH_STATE_IF_NEEDED))
+    if (!batch && !FlushStateToDisk(chainparams, state, FLUSH_STATE_IF_NEEDED))
         return false;
     int64_t nTime5 = GetTimeMicros(); nTimeChainState += nTime5 - nTime4;
     LogPrint(BCLog::BENCH, "  - Writing chainstate: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime5 - nTime4) * MILLI, nTimeChainState * MICRO, nTimeChainState * MILLI / nBlocksTotal);
-    // Remove conflicting transactions from the mempool.;
-    mempool.removeForBlock(blockConnecting.vtx, pindexNew->nHeight, assetDataFromBlock);
-    disconnectpool.removeForBlock(blockConnecting.vtx);
+    if (batch) {
+        batch->AddConnectedBlock(pindexNew, pthisBlock, assetDataFromBlock);
+    } else {
+        // Remove conflicting transactions from the mempool.;
+        mempool.removeForBlock(blockConnecting.vtx, pindexNew->nHeight, assetDataFromBlock);
+        disconnectpool.removeForBlock(blockConnecting.vtx);
+    }
     // Update chainActive & related variables.
     UpdateTip(pindexNew, chainparams);
 
@@ -3354,7 +3637,8 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     LogPrint(BCLog::BENCH, "  - Connect postprocess: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime6 - nTime5) * MILLI, nTimePostConnect * MICRO, nTimePostConnect * MILLI / nBlocksTotal);
     LogPrint(BCLog::BENCH, "- Connect block: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime6 - nTime1) * MILLI, nTimeTotal * MICRO, nTimeTotal * MILLI / nBlocksTotal);
 
-    connectTrace.BlockConnected(pindexNew, std::move(pthisBlock));
+    if (!batch)
+        connectTrace.BlockConnected(pindexNew, std::move(pthisBlock));
 
     /** RVN START */
 
@@ -3388,6 +3672,33 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     return true;
 }
 
+/**
+ * Write a reorganization's coins back to pcoinsTip and catch the mempool and connectTrace up
+ * with the blocks it connected. Mempool transactions are checked against the asset changes of
+ * the whole fork once, together with the last block connected.
+ */
+static bool CommitReorgBatch(CValidationState& state, const CChainParams& chainparams, ReorgBatch& batch, ConnectTrace& connectTrace, DisconnectedBlockTransactions& disconnectpool)
+{
+    int64_t nStart = GetTimeMicros();
+    bool flushed = batch.view.Flush();
+    assert(flushed);
+
+    for (size_t i = 0; i < batch.vConnected.size(); i++) {
+        CBlockIndex* pindex = batch.vConnected[i].first;
+        std::shared_ptr<const CBlock>& pblock = batch.vConnected[i].second;
+        if (i + 1 == batch.vConnected.size())
+            mempool.removeForBlock(pblock->vtx, pindex->nHeight, batch.assetData);
+        else
+            mempool.removeForBlock(pblock->vtx, pindex->nHeight);
+        disconnectpool.removeForBlock(pblock->vtx);
+        connectTrace.BlockConnected(pindex, std::move(pblock));
+    }
+    LogPrint(BCLog::BENCH, "- Commit reorg of %u connected blocks: %.2fms\n", batch.vConnected.size(), (GetTimeMicros() - nStart) * MILLI);
+    batch.vConnected.clear();
+
+    return FlushStateToDisk(chainparams, state, FLUSH_STATE_IF_NEEDED);
+}
+
 /**
  * Return the tip of the chain with the most work in it, that isn't
  * known to be invalid (it's however far from certain to be valid).
@@ -3468,13 +3779,19 @@ static bool ActivateBestChainStep(CValidationState& state, const CChainParams& c
     const CBlockIndex *pindexOldTip = chainActive.Tip();
     const CBlockIndex *pindexFork = chainActive.FindFork(pindexMostWork);
 
+    // A reorganization is applied to one coins view and committed once, rather than block by block.
+    std::unique_ptr<ReorgBatch> batch;
+    if (chainActive.Tip() && chainActive.Tip() != pindexFork)
+        batch.reset(new ReorgBatch(pcoinsTip));
+
     // Disconnect active blocks which are no longer in the best chain.
     bool fBlocksDisconnected = false;
     DisconnectedBlockTransactions disconnectpool;
     while (chainActive.Tip() && chainActive.Tip() != pindexFork) {
-        if (!DisconnectTip(state, chainparams, &disconnectpool)) {
+        if (!DisconnectTip(state, chainparams, &disconnectpool, batch.get())) {
             // This is likely a fatal error, but keep the mempool consistent,
             // just in case. Only remove from the mempool in this case.
+            CommitReorgBatch(state, chainparams, *batch, connectTrace, disconnectpool);
             UpdateMempoolForReorg(disconnectpool, false);
             return false;
         }
@@ -3500,7 +3817,7 @@ static bool ActivateBestChainStep(CValidationState& state, const CChainParams& c
 
         // Connect new blocks.
         for (CBlockIndex *pindexConnect : reverse_iterate(vpindexToConnect)) {
-            if (!ConnectTip(state, chainparams, pindexConnect, pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(), connectTrace, disconnectpool)) {
+            if (!ConnectTip(state, chainparams, pindexConnect, pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(), connectTrace, disconnectpool, batch.get())) {
                 if (state.IsInvalid()) {
                     // The block violates a consensus rule.
                     if (!state.CorruptionPossible()) {
@@ -3514,6 +3831,8 @@ static bool ActivateBestChainStep(CValidationState& state, const CChainParams& c
                     // A system error occurred (disk space, database error, ...).
                     // Make the mempool consistent with the current tip, just in case
                     // any observers try to use it before shutdown.
+                    if (batch)
+                        CommitReorgBatch(state, chainparams, *batch, connectTrace, disconnectpool);
                     UpdateMempoolForReorg(disconnectpool, false);
                     return false;
                 }
@@ -3528,6 +3847,11 @@ static bool ActivateBestChainStep(CValidationState& state, const CChainParams& c
         }
     }
 
+    if (batch && !CommitReorgBatch(state, chainparams, *batch, connectTrace, disconnectpool)) {
+        UpdateMempoolForReorg(disconnectpool, false);
+        return false;
+    }
+
     if (fBlocksDisconnected) {
         // If any blocks were disconnected, disconnectpool may be non empty.  Add
         // any disconnected transactions back to the mempool.
@@ -3788,6 +4112,7 @@ static CBlockIndex* AddToBlockIndex(const CBlockHeader& block)
         pindexNew->nHeight = pindexNew->pprev->nHeight + 1;
         pindexNew->BuildSkip();
     }
+    pindexNew->SetMedianTimePast();
     pindexNew->nTimeMax = (pindexNew->pprev ? std::max(pindexNew->pprev->nTimeMax, pindexNew->nTime) : pindexNew->nTime);
     pindexNew->nChainWork = (pindexNew->pprev ? pindexNew->pprev->nChainWork : 0) + GetBlockProof(*pindexNew);
     pindexNew->RaiseValidity(BLOCK_VALID_TREE);
@@ -3965,6 +4290,22 @@ static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state,
     return true;
 }
 
+static bool CheckBlockMerkleRoot(const CBlock& block, CValidationState& state)
+{
+    bool mutated;
+    uint256 hashMerkleRoot2 = BlockMerkleRoot(block, &mutated);
+    if (block.hashMerkleRoot != hashMerkleRoot2)
+        return state.DoS(100, false, REJECT_INVALID, "bad-txnmrklroot", true, "hashMerkleRoot mismatch");
+
+    // Check for merkle tree malleability (CVE-2012-2459): repeating sequences
+    // of transactions in a block without affecting the merkle root of a block,
+    // while still invalidating it.
+    if (mutated)
+        return state.DoS(100, false, REJECT_INVALID, "bad-txns-duplicate", true, "duplicate transaction");
+
+    return true;
+}
+
 bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW, bool fCheckMerkleRoot, bool fDBCheck)
 {
     // These are checks that are independent of context.
@@ -3978,18 +4319,8 @@ bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::P
         return error("%s: Consensus::CheckBlockHeader: %s", __func__, FormatStateMessage(state));
 
     // Check the merkle root.
-    if (fCheckMerkleRoot) {
-        bool mutated;
-        uint256 hashMerkleRoot2 = BlockMerkleRoot(block, &mutated);
-        if (block.hashMerkleRoot != hashMerkleRoot2)
-            return state.DoS(100, false, REJECT_INVALID, "bad-txnmrklroot", true, "hashMerkleRoot mismatch");
-
-        // Check for merkle tree malleability (CVE-2012-2459): repeating sequences
-        // of transactions in a block without affecting the merkle root of a block,
-        // while still invalidating it.
-        if (mutated)
-            return state.DoS(100, false, REJECT_INVALID, "bad-txns-duplicate", true, "duplicate transaction");
-    }
+    if (fCheckMerkleRoot && !CheckBlockMerkleRoot(block, state))
+        return false;
 
     // All potential-corruption validation must be done before we do any
     // transaction validation, as otherwise we may mark the header as invalid
@@ -4544,6 +4875,7 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune)
 {
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it) {
         CDiskBlockPos pos(*it, 0);
+        blockFileReadCache.Close(*it);
         fs::remove(GetBlockPosFilename(pos, "blk"));
         fs::remove(GetBlockPosFilename(pos, "rev"));
         LogPrintf("Prune: %s deleted blk/rev (%05u)\n", __func__, *it);
@@ -4729,6 +5061,7 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
         CBlockIndex* pindex = item.second;
         pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
         pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
+        pindex->SetMedianTimePast();
         // We can link the chain of blocks for which we've received transactions at some point.
         // Pruned nodes may have deleted the block.
         if (pindex->nTx > 0) {
@@ -4862,6 +5195,71 @@ CVerifyDB::~CVerifyDB()
     uiInterface.ShowProgress("", 100, false);
 }
 
+/** A block read back by VerifyDB's workers, with what they found wrong with it */
+struct VerifyDBBlockCheck {
+    CBlock block;
+    std::string strError;
+    std::string strUndoError;
+    bool fDone = false;
+};
+
+/**
+ * Read vIndexes[nStart, nStart + vChecks.size()) back on up to nThreads threads, checking their
+ * header, merkle root and undo data. The transaction checks look up deployment state under
+ * cs_main, which the caller holds, so they are left to it. Blocks are claimed in order and the
+ * workers stop at the first failure, so every check before a failed one is done.
+ */
+static void VerifyDBReadBlocks(const CChainParams& chainparams, const std::vector<CBlockIndex*>& vIndexes, size_t nStart,
+                               std::vector<VerifyDBBlockCheck>& vChecks, int nCheckLevel, int nThreads)
+{
+    const size_t nChecks = vChecks.size();
+    std::atomic<size_t> nNext(0);
+    std::exception_ptr error;
+    std::mutex csError;
+    auto worker = [&]() {
+        try {
+            for (size_t i = nNext++; i < nChecks; i = nNext++) {
+                const CBlockIndex* pindex = vIndexes[nStart + i];
+                VerifyDBBlockCheck& check = vChecks[i];
+                CValidationState state;
+                // check level 0: read from disk
+                if (!ReadBlockFromDisk(check.block, pindex, chainparams.GetConsensus())) {
+                    check.strError = strprintf("VerifyDB(): *** ReadBlockFromDisk failed at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
+                } else if (nCheckLevel >= 1 && (!CheckBlockHeader(check.block, state, chainparams.GetConsensus()) || !CheckBlockMerkleRoot(check.block, state))) {
+                    check.strError = strprintf("VerifyDB: *** found bad block at %d, hash=%s (%s)\n",
+                                               pindex->nHeight, pindex->GetBlockHash().ToString(), FormatStateMessage(state));
+                }
+                // check level 2: verify undo validity
+                if (check.strError.empty() && nCheckLevel >= 2) {
+                    CBlockUndo undo;
+                    CDiskBlockPos pos = pindex->GetUndoPos();
+                    if (!pos.IsNull()) {
+                        if (!UndoReadFromDisk(undo, pos, pindex->pprev->GetBlockHash()))
+                            check.strUndoError = strprintf("VerifyDB(): *** found bad undo data at %d, hash=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString());
+                    }
+                }
+                check.fDone = true;
+                if (!check.strError.empty() || !check.strUndoError.empty() || ShutdownRequested())
+                    nNext = nChecks;
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(csError);
+            if (!error)
+                error = std::current_exception();
+            nNext = nChecks;
+        }
+    };
+
+    std::vector<std::thread> vThreads;
+    for (int i = 1; i < nThreads && (size_t)i < nChecks; i++)
+        vThreads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : vThreads)
+        thread.join();
+    if (error)
+        std::rethrow_exception(error);
+}
+
 bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview, int nCheckLevel, int nCheckDepth)
 {
     LOCK(cs_main);
@@ -4882,17 +5280,10 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
 
     auto currentActiveAssetCache = GetCurrentAssetCache();
     CAssetsCache assetCache(*currentActiveAssetCache);
-    LogPrintf("[0%%]...");
+
+    std::vector<CBlockIndex*> vIndexes;
     for (CBlockIndex* pindex = chainActive.Tip(); pindex && pindex->pprev; pindex = pindex->pprev)
     {
-        boost::this_thread::interruption_point();
-        int percentageDone = std::max(1, std::min(99, (int)(((double)(chainActive.Height() - pindex->nHeight)) / (double)nCheckDepth * (nCheckLevel >= 4 ? 50 : 100))));
-        if (reportDone < percentageDone/10) {
-            // report every 10% step
-            LogPrintf("[%d%%]...", percentageDone);
-            reportDone = percentageDone/10;
-        }
-        uiInterface.ShowProgress(_("Verifying blocks..."), percentageDone, false);
         if (pindex->nHeight < chainActive.Height()-nCheckDepth)
             break;
         if (fPruneMode && !(pindex->nStatus & BLOCK_HAVE_DATA)) {
@@ -4900,43 +5291,66 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
             LogPrintf("VerifyDB(): block verification stopping at height %d (pruning, no data)\n", pindex->nHeight);
             break;
         }
-        CBlock block;
-        // check level 0: read from disk
-        if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()))
-            return error("VerifyDB(): *** ReadBlockFromDisk failed at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
-        // check level 1: verify block validity
-        bool fCheckPoW = true;
-        bool fCheckMerkleRoot = true;
-        bool fDBCheck = true;
-        if (nCheckLevel >= 1 && !CheckBlock(block, state, chainparams.GetConsensus(), fCheckPoW, fCheckMerkleRoot, fDBCheck)) // fCheckAssetDuplicate set to false, because we don't want to fail because the asset exists in our database, when loading blocks from our asset databse
-            return error("%s: *** found bad block at %d, hash=%s (%s)\n", __func__,
-                         pindex->nHeight, pindex->GetBlockHash().ToString(), FormatStateMessage(state));
-        // check level 2: verify undo validity
-        if (nCheckLevel >= 2 && pindex) {
-            CBlockUndo undo;
-            CDiskBlockPos pos = pindex->GetUndoPos();
-            if (!pos.IsNull()) {
-                if (!UndoReadFromDisk(undo, pos, pindex->pprev->GetBlockHash()))
-                    return error("VerifyDB(): *** found bad undo data at %d, hash=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString());
-            }
-        }
-        // check level 3: check for inconsistencies during memory-only disconnect of tip blocks
-        if (nCheckLevel >= 3 && pindex == pindexState && (coins.DynamicMemoryUsage() + pcoinsTip->DynamicMemoryUsage()) <= nCoinCacheUsage) {
-            assert(coins.GetBestBlock() == pindex->GetBlockHash());
-            DisconnectResult res = DisconnectBlock(block, pindex, coins, &assetCache, true, false);
-            if (res == DISCONNECT_FAILED) {
-                return error("VerifyDB(): *** irrecoverable inconsistency in block data at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
+        vIndexes.push_back(pindex);
+    }
+
+    // Reading the blocks back and hashing them is most of levels 0-2, and needs nothing but the
+    // block itself: that runs on as many threads as script checks do, a batch at a time. The
+    // rest, and the disconnects of level 3 which have to go tip first, stay on this thread.
+    const int nThreads = std::max(1, nScriptCheckThreads);
+    LogPrintf("[0%%]...");
+    for (size_t nBatchStart = 0; nBatchStart < vIndexes.size(); nBatchStart += VERIFYDB_BATCH_BLOCKS)
+    {
+        boost::this_thread::interruption_point();
+        const size_t nBatchEnd = std::min(vIndexes.size(), nBatchStart + VERIFYDB_BATCH_BLOCKS);
+        std::vector<VerifyDBBlockCheck> vChecks(nBatchEnd - nBatchStart);
+        VerifyDBReadBlocks(chainparams, vIndexes, nBatchStart, vChecks, nCheckLevel, nThreads);
+
+        for (size_t i = nBatchStart; i < nBatchEnd; i++)
+        {
+            CBlockIndex* pindex = vIndexes[i];
+            VerifyDBBlockCheck& check = vChecks[i - nBatchStart];
+            boost::this_thread::interruption_point();
+            int percentageDone = std::max(1, std::min(99, (int)(((double)(chainActive.Height() - pindex->nHeight)) / (double)nCheckDepth * (nCheckLevel >= 4 ? 50 : 100))));
+            if (reportDone < percentageDone/10) {
+                // report every 10% step
+                LogPrintf("[%d%%]...", percentageDone);
+                reportDone = percentageDone/10;
             }
-            pindexState = pindex->pprev;
-            if (res == DISCONNECT_UNCLEAN) {
-                nGoodTransactions = 0;
-                pindexFailure = pindex;
-            } else {
-                nGoodTransactions += block.vtx.size();
+            uiInterface.ShowProgress(_("Verifying blocks..."), percentageDone, false);
+            // The workers only leave checks undone after a failure further up, or when shutting down
+            if (!check.fDone)
+                return true;
+            if (!check.strError.empty())
+                return error("%s", check.strError);
+            const CBlock& block = check.block;
+            // check level 1: verify block validity, past the header and merkle root checked above
+            bool fCheckPoW = false;
+            bool fCheckMerkleRoot = false;
+            bool fDBCheck = true;
+            if (nCheckLevel >= 1 && !CheckBlock(block, state, chainparams.GetConsensus(), fCheckPoW, fCheckMerkleRoot, fDBCheck)) // fCheckAssetDuplicate set to false, because we don't want to fail because the asset exists in our database, when loading blocks from our asset databse
+                return error("%s: *** found bad block at %d, hash=%s (%s)\n", __func__,
+                             pindex->nHeight, pindex->GetBlockHash().ToString(), FormatStateMessage(state));
+            if (!check.strUndoError.empty())
+                return error("%s", check.strUndoError);
+            // check level 3: check for inconsistencies during memory-only disconnect of tip blocks
+            if (nCheckLevel >= 3 && pindex == pindexState && (coins.DynamicMemoryUsage() + pcoinsTip->DynamicMemoryUsage()) <= nCoinCacheUsage) {
+                assert(coins.GetBestBlock() == pindex->GetBlockHash());
+                DisconnectResult res = DisconnectBlock(block, pindex, coins, &assetCache, true, false);
+                if (res == DISCONNECT_FAILED) {
+                    return error("VerifyDB(): *** irrecoverable inconsistency in block data at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
+                }
+                pindexState = pindex->pprev;
+                if (res == DISCONNECT_UNCLEAN) {
+                    nGoodTransactions = 0;
+                    pindexFailure = pindex;
+                } else {
+                    nGoodTransactions += block.vtx.size();
+                }
             }
+            if (ShutdownRequested())
+                return true;
         }
-        if (ShutdownRequested())
-            return true;
     }
     if (pindexFailure)
         return error("VerifyDB(): *** coin database inconsistencies found (last %i blocks, %i good transactions before that)\n", chainActive.Height() - pindexFailure->nHeight + 1, nGoodTransactions);
@@ -5714,6 +6128,107 @@ bool DumpMempool(void)
     return true;
 }
 
+static const uint64_t SIGCACHE_DUMP_VERSION = 1;
+
+bool LoadValidationCaches()
+{
+    FILE* filestr = fsbridge::fopen(GetDataDir() / "sigcache.dat", "rb");
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        LogPrintf("Failed to open signature cache file from disk. Continuing anyway.\n");
+        return false;
+    }
+
+    int64_t start = GetTimeMicros();
+
+    uint256 sigNonce;
+    uint256 scriptNonce;
+    std::vector<uint256> vSigEntries;
+    std::vector<uint256> vScriptEntries;
+    try {
+        CHashVerifier<CAutoFile> verifier(&file);
+        uint64_t version;
+        verifier >> version;
+        if (version != SIGCACHE_DUMP_VERSION) {
+            return false;
+        }
+        unsigned char pchMsgTmp[4];
+        verifier >> FLATDATA(pchMsgTmp);
+        if (memcmp(pchMsgTmp, GetParams().MessageStart(), sizeof(pchMsgTmp))) {
+            LogPrintf("Signature cache file is for a different network. Continuing anyway.\n");
+            return false;
+        }
+        verifier >> sigNonce >> vSigEntries >> scriptNonce >> vScriptEntries;
+
+        // The cache entries vouch for signatures and scripts being valid, so don't use a damaged file
+        uint256 hashTmp;
+        file >> hashTmp;
+        if (hashTmp != verifier.GetHash()) {
+            LogPrintf("Signature cache file checksum mismatch. Continuing anyway.\n");
+            return false;
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to deserialize signature cache data on disk: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+
+    // Entries are salted with the nonce they were computed under, so adopt the saved nonces. Nothing has
+    // been cached under the random startup nonces yet, so no entries are lost by replacing them.
+    SetSignatureCacheState(sigNonce, vSigEntries);
+    {
+        LOCK(cs_main);
+        scriptExecutionCacheNonce = scriptNonce;
+        for (const uint256& entry : vScriptEntries)
+            scriptExecutionCache.insert(entry);
+    }
+
+    LogPrintf("Imported %u signature and %u script execution cache entries in %gs\n", vSigEntries.size(), vScriptEntries.size(), (GetTimeMicros() - start) * MICRO);
+    return true;
+}
+
+bool DumpValidationCaches()
+{
+    int64_t start = GetTimeMicros();
+
+    uint256 sigNonce;
+    uint256 scriptNonce;
+    std::vector<uint256> vSigEntries;
+    std::vector<uint256> vScriptEntries;
+    GetSignatureCacheState(sigNonce, vSigEntries);
+    {
+        LOCK(cs_main);
+        scriptNonce = scriptExecutionCacheNonce;
+        scriptExecutionCache.get_kept(vScriptEntries);
+    }
+
+    int64_t mid = GetTimeMicros();
+
+    try {
+        FILE* filestr = fsbridge::fopen(GetDataDir() / "sigcache.dat.new", "wb");
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+        CHashWriter hasher(SER_DISK, CLIENT_VERSION);
+
+        uint64_t version = SIGCACHE_DUMP_VERSION;
+        file << version << FLATDATA(GetParams().MessageStart()) << sigNonce << vSigEntries << scriptNonce << vScriptEntries;
+        hasher << version << FLATDATA(GetParams().MessageStart()) << sigNonce << vSigEntries << scriptNonce << vScriptEntries;
+        file << hasher.GetHash();
+
+        FileCommit(file.Get());
+        file.fclose();
+        RenameOver(GetDataDir() / "sigcache.dat.new", GetDataDir() / "sigcache.dat");
+        int64_t last = GetTimeMicros();
+        LogPrintf("Dumped %u signature and %u script execution cache entries: %gs to copy, %gs to dump\n", vSigEntries.size(), vScriptEntries.size(), (mid-start)*MICRO, (last-mid)*MICRO);
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump signature cache: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    return true;
+}
+
 //! Guess how far we are in the verification process at the given block index
 double GuessVerificationProgress(const ChainTxData& data, CBlockIndex *pindex) {
     if (pindex == nullptr)
@@ -52,6 +52,7 @@ class CBlockPolicyEstimator;
 class CTxMemPool;
 class CValidationState;
 class CTxUndo;
+struct CDiskTxPos;
 struct ChainTxData;
 
 class CAssetsDB;
@@ -91,13 +92,25 @@ static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
 static const unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
 /** The pre-allocation chunk size for rev?????.dat files (since 0.8) */
 static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
+/** Largest per-thread block read buffer kept around between ReadBlockFromDisk calls */
+static const unsigned int MAX_BLOCK_READ_BUFFER_RETAIN = 0x200000; // 2 MiB
 
 /** Maximum number of script-checking threads allowed */
 static const int MAX_SCRIPTCHECK_THREADS = 16;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
-/** Number of blocks that can be requested at any given time from a single peer. */
+/** Minimum number of inputs for a loose transaction's script checks to be run on the script-checking threads */
+static const unsigned int MEMPOOL_PARALLEL_SCRIPTCHECK_MIN_INPUTS = 16;
+/** Number of blocks that can be requested at any given time from a single peer whose download rate is not yet known. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
+/** Bounds on the per-peer in-flight block quota once a peer's download rate has been measured. */
+static const int MIN_BLOCKS_IN_TRANSIT_PER_PEER = 2;
+static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER_ADAPTIVE = 64;
+/** Seconds worth of blocks (at a peer's measured delivery rate) we try to keep requested from that peer. */
+static const int64_t BLOCK_DOWNLOAD_TARGET_TIME = 4;
+/** A block holding back the download window is re-requested from a faster peer once it has been
+ *  in flight for this many times that peer's average block latency. */
+static const int BLOCK_REREQUEST_LATENCY_FACTOR = 3;
 /** Timeout in seconds during which a peer must stall block download progress before being disconnected. */
 static const unsigned int BLOCK_STALLING_TIMEOUT = 2;
 /** Number of headers sent in one getheaders result. We rely on the assumption that if a peer sends
@@ -148,6 +161,8 @@ static const int64_t MAX_FEE_ESTIMATION_TIP_AGE = 3 * 60 * 60;
 static const bool DEFAULT_PERMIT_BAREMULTISIG = true;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
 static const bool DEFAULT_TXINDEX = false;
+/** Default for -txindexcache, the number of transactions read through the txindex kept in memory */
+static const unsigned int DEFAULT_TXINDEX_CACHE = 0;
 static const bool DEFAULT_ASSETINDEX = false;
 static const bool DEFAULT_ADDRESSINDEX = false;
 static const bool DEFAULT_TIMESTAMPINDEX = false;
@@ -159,6 +174,8 @@ static const int64_t DEFAULT_DB_MAX_FILE_SIZE = 2;
 static const unsigned int DEFAULT_BANSCORE_THRESHOLD = 100;
 /** Default for -persistmempool */
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
+/** Default for -persistsigcache */
+static const bool DEFAULT_PERSIST_SIGCACHE = false;
 /** Default for -mempoolreplacement */
 static const bool DEFAULT_ENABLE_REPLACEMENT = false;
 /** Default for using fee filter */
@@ -205,6 +222,8 @@ extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
 extern size_t nCoinCacheUsage;
+/** Number of transactions read through the txindex kept in memory. */
+extern unsigned int nTxIndexCacheSize;
 /** A fee rate smaller than this is considered zero fee (for relaying, mining and transaction creation) */
 extern CFeeRate minRelayTxFee;
 /** Absolute maximum transaction fee (in satoshis) used by wallet and mempool (rejects high fee in sendrawtransaction) */
@@ -241,6 +260,8 @@ static const unsigned int MIN_BLOCKS_TO_KEEP = 288;
 
 static const signed int DEFAULT_CHECKBLOCKS = 6;
 static const unsigned int DEFAULT_CHECKLEVEL = 3;
+/** How many blocks VerifyDB reads and checks in parallel before disconnecting them in order */
+static const unsigned int VERIFYDB_BATCH_BLOCKS = 64;
 
 // Require that user allocate at least 550MB for block & undo files (blk???.dat and rev???.dat)
 // At 1MB per block, 288 blocks = 288MB.
@@ -447,6 +468,8 @@ bool GetAddressUnspent(uint160 addressHash, int type,
 /** Functions for disk access for blocks */
 bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+/** Read the transaction at a txindex position, and the hash of the block it is in */
+bool ReadTransactionFromDisk(const CDiskTxPos& postx, CTransactionRef& txOut, uint256& hashBlock);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -513,6 +536,8 @@ extern CAssetsCache *passets;
 
 /** Global variable that point to the assets metadata LRU Cache (protected by cs_main) */
 extern CLRUCache<std::string, CDatabasedAssetData> *passetsCache;
+/** Network serialized assetdata payloads of recently requested assets, erased whenever the asset changes */
+extern CLRUCache<std::string, std::shared_ptr<const std::vector<unsigned char>>> *passetsDataPayloadCache;
 
 /** Global variable that points to the subscribed channel LRU Cache (protected by cs_main) */
 extern CLRUCache<std::string, CMessage> *pMessagesCache;
@@ -588,6 +613,12 @@ bool DumpMempool();
 /** Load the mempool from disk. */
 bool LoadMempool();
 
+/** Dump the signature and script execution caches to disk. */
+bool DumpValidationCaches();
+
+/** Load the signature and script execution caches from disk. Must be called before any script is verified. */
+bool LoadValidationCaches();
+
 /** RVN START */
 bool AreAssetsDeployed();
 
@@ -6,14 +6,24 @@
 
 #include "validationinterface.h"
 
+#include "assets/assets.h"
+#include "assets/messages.h"
+#include "chain.h"
+#include "consensus/validation.h"
 #include "init.h"
 #include "primitives/block.h"
 #include "scheduler.h"
 #include "sync.h"
 #include "util.h"
+#include "utiltime.h"
 
 #include <list>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #include <boost/signals2/signal.hpp>
 
@@ -21,6 +31,155 @@
 #include <boost/bind/bind.hpp>
 using namespace boost::placeholders;
 
+/**
+ * Stands in for one subscriber among the registered interfaces: every
+ * notification it is connected for is copied into an ordered queue and
+ * delivered to the subscriber on a thread of its own, so a slow subscriber
+ * only delays itself.
+ */
+class CValidationInterfaceQueue final : public CValidationInterface
+{
+private:
+    CValidationInterface* const pinterface;
+    const std::string strName;
+    const size_t nMaxDepth;
+
+    std::mutex cs;
+    std::condition_variable condQueued;
+    std::condition_variable condIdle;
+    //! (time queued, callback) in the order notifications were made
+    std::deque<std::pair<int64_t, std::function<void ()>>> queue;
+    bool fStop = false;
+    //! notifications queued and finished since the start, so Flush can wait for those queued before it
+    uint64_t nQueuedTotal = 0;
+    uint64_t nFinishedTotal = 0;
+    NotificationQueueInfo info;
+
+    std::thread thread;
+
+    void Enqueue(std::function<void ()> func, bool fDroppable)
+    {
+        {
+            std::lock_guard<std::mutex> lock(cs);
+            if (fDroppable && nMaxDepth && queue.size() >= nMaxDepth) {
+                info.nDropped++;
+                return;
+            }
+            queue.emplace_back(GetTimeMicros(), std::move(func));
+            nQueuedTotal++;
+            info.nMaxDepth = std::max(info.nMaxDepth, queue.size());
+        }
+        condQueued.notify_one();
+    }
+
+    void ThreadProcess()
+    {
+        while (true) {
+            std::function<void ()> callback;
+            {
+                std::unique_lock<std::mutex> lock(cs);
+                condQueued.wait(lock, [this] { return fStop || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                int64_t nLatency = GetTimeMicros() - queue.front().first;
+                info.nDelivered++;
+                info.nTotalLatency += nLatency;
+                info.nMaxLatency = std::max(info.nMaxLatency, nLatency);
+                callback = std::move(queue.front().second);
+                queue.pop_front();
+            }
+
+            try {
+                callback();
+            } catch (const std::exception& e) {
+                PrintExceptionContinue(&e, strName.c_str());
+            } catch (...) {
+                PrintExceptionContinue(nullptr, strName.c_str());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(cs);
+                nFinishedTotal++;
+            }
+            condIdle.notify_all();
+        }
+    }
+
+public:
+    CValidationInterfaceQueue(CValidationInterface* pinterfaceIn, const std::string& strNameIn, size_t nMaxDepthIn) :
+        pinterface(pinterfaceIn), strName(strNameIn), nMaxDepth(nMaxDepthIn), info()
+    {
+        info.strName = strName;
+        thread = std::thread(&TraceThread<std::function<void ()>>, strName.c_str(), std::function<void ()>(std::bind(&CValidationInterfaceQueue::ThreadProcess, this)));
+    }
+
+    //! Delivers whatever is still queued before returning
+    ~CValidationInterfaceQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(cs);
+            fStop = true;
+        }
+        condQueued.notify_one();
+        thread.join();
+    }
+
+    CValidationInterface* Interface() const { return pinterface; }
+
+    //! Wait until everything queued so far has been delivered
+    void Flush()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        const uint64_t nTarget = nQueuedTotal;
+        condIdle.wait(lock, [this, nTarget] { return nFinishedTotal >= nTarget; });
+    }
+
+    NotificationQueueInfo GetInfo()
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        NotificationQueueInfo ret = info;
+        ret.nDepth = queue.size();
+        return ret;
+    }
+
+protected:
+    void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override {
+        Enqueue([=] { pinterface->UpdatedBlockTip(pindexNew, pindexFork, fInitialDownload); }, false);
+    }
+    void TransactionAddedToMempool(const CTransactionRef &ptx) override {
+        Enqueue([=] { pinterface->TransactionAddedToMempool(ptx); }, true);
+    }
+    void BlockConnected(const std::shared_ptr<const CBlock> &pblock, const CBlockIndex *pindex, const std::vector<CTransactionRef> &vtxConflicted) override {
+        Enqueue([=] { pinterface->BlockConnected(pblock, pindex, vtxConflicted); }, false);
+    }
+    void BlockDisconnected(const std::shared_ptr<const CBlock> &pblock) override {
+        Enqueue([=] { pinterface->BlockDisconnected(pblock); }, false);
+    }
+    void SetBestChain(const CBlockLocator &locator) override {
+        Enqueue([=] { pinterface->SetBestChain(locator); }, false);
+    }
+    void Inventory(const uint256 &hash) override {
+        Enqueue([=] { pinterface->Inventory(hash); }, true);
+    }
+    void ResendWalletTransactions(int64_t nBestBlockTime, CConnman* connman) override {
+        Enqueue([=] { pinterface->ResendWalletTransactions(nBestBlockTime, connman); }, true);
+    }
+    void BlockChecked(const CBlock& block, const CValidationState& state) override {
+        // The block is only borrowed for the call, so a subscriber that wants it queued pays for a copy
+        std::shared_ptr<const CBlock> pblock = std::make_shared<const CBlock>(block);
+        Enqueue([=] { pinterface->BlockChecked(*pblock, state); }, false);
+    }
+    void NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& pblock) override {
+        Enqueue([=] { pinterface->NewPoWValidBlock(pindex, pblock); }, false);
+    }
+    void BlockFound(const uint256 &hash) override {
+        Enqueue([=] { pinterface->BlockFound(hash); }, false);
+    }
+    void NewAssetMessage(const CMessage &message) override {
+        Enqueue([=] { pinterface->NewAssetMessage(message); }, false);
+    }
+};
+
 struct MainSignalsInstance {
     boost::signals2::signal<void (const CBlockIndex *, const CBlockIndex *, bool fInitialDownload)> UpdatedBlockTip;
     boost::signals2::signal<void (const CTransactionRef &)> TransactionAddedToMempool;
@@ -41,6 +200,10 @@ struct MainSignalsInstance {
     // our own queue here :(
     SingleThreadedSchedulerClient m_schedulerClient;
 
+    // Subscribers registered with a queue of their own, and the queue standing in for each
+    std::mutex m_cs_queues;
+    std::map<CValidationInterface*, std::unique_ptr<CValidationInterfaceQueue>> m_queues;
+
     explicit MainSignalsInstance(CScheduler *pscheduler) : m_schedulerClient(pscheduler) {}
 };
 
@@ -57,6 +220,9 @@ void CMainSignals::UnregisterBackgroundSignalScheduler() {
 
 void CMainSignals::FlushBackgroundCallbacks() {
     m_internals->m_schedulerClient.EmptyQueue();
+    std::lock_guard<std::mutex> lock(m_internals->m_cs_queues);
+    for (const auto& queue : m_internals->m_queues)
+        queue.second->Flush();
 }
 
 CMainSignals& GetMainSignals()
@@ -64,22 +230,75 @@ CMainSignals& GetMainSignals()
     return g_signals;
 }
 
-void RegisterValidationInterface(CValidationInterface* pwalletIn) {
-    g_signals.m_internals->UpdatedBlockTip.connect(boost::bind(&CValidationInterface::UpdatedBlockTip, pwalletIn, _1, _2, _3));
-    g_signals.m_internals->TransactionAddedToMempool.connect(boost::bind(&CValidationInterface::TransactionAddedToMempool, pwalletIn, _1));
-    g_signals.m_internals->BlockConnected.connect(boost::bind(&CValidationInterface::BlockConnected, pwalletIn, _1, _2, _3));
-    g_signals.m_internals->BlockDisconnected.connect(boost::bind(&CValidationInterface::BlockDisconnected, pwalletIn, _1));
-    g_signals.m_internals->SetBestChain.connect(boost::bind(&CValidationInterface::SetBestChain, pwalletIn, _1));
-    g_signals.m_internals->Inventory.connect(boost::bind(&CValidationInterface::Inventory, pwalletIn, _1));
-    g_signals.m_internals->Broadcast.connect(boost::bind(&CValidationInterface::ResendWalletTransactions, pwalletIn, _1, _2));
-    g_signals.m_internals->BlockChecked.connect(boost::bind(&CValidationInterface::BlockChecked, pwalletIn, _1, _2));
-    g_signals.m_internals->NewPoWValidBlock.connect(boost::bind(&CValidationInterface::NewPoWValidBlock, pwalletIn, _1, _2));
-    g_signals.m_internals->BlockFound.connect(boost::bind(&CValidationInterface::BlockFound, pwalletIn, _1));
-    g_signals.m_internals->NewAssetMessage.connect(boost::bind(&CValidationInterface::NewAssetMessage, pwalletIn, _1));
+void RegisterValidationInterface(CValidationInterface* pwalletIn, unsigned int nNotifications) {
+    if (nNotifications & NOTIFY_UPDATED_BLOCK_TIP)
+        g_signals.m_internals->UpdatedBlockTip.connect(boost::bind(&CValidationInterface::UpdatedBlockTip, pwalletIn, _1, _2, _3));
+    if (nNotifications & NOTIFY_TRANSACTION_ADDED_TO_MEMPOOL)
+        g_signals.m_internals->TransactionAddedToMempool.connect(boost::bind(&CValidationInterface::TransactionAddedToMempool, pwalletIn, _1));
+    if (nNotifications & NOTIFY_BLOCK_CONNECTED)
+        g_signals.m_internals->BlockConnected.connect(boost::bind(&CValidationInterface::BlockConnected, pwalletIn, _1, _2, _3));
+    if (nNotifications & NOTIFY_BLOCK_DISCONNECTED)
+        g_signals.m_internals->BlockDisconnected.connect(boost::bind(&CValidationInterface::BlockDisconnected, pwalletIn, _1));
+    if (nNotifications & NOTIFY_SET_BEST_CHAIN)
+        g_signals.m_internals->SetBestChain.connect(boost::bind(&CValidationInterface::SetBestChain, pwalletIn, _1));
+    if (nNotifications & NOTIFY_INVENTORY)
+        g_signals.m_internals->Inventory.connect(boost::bind(&CValidationInterface::Inventory, pwalletIn, _1));
+    if (nNotifications & NOTIFY_RESEND_WALLET_TRANSACTIONS)
+        g_signals.m_internals->Broadcast.connect(boost::bind(&CValidationInterface::ResendWalletTransactions, pwalletIn, _1, _2));
+    if (nNotifications & NOTIFY_BLOCK_CHECKED)
+        g_signals.m_internals->BlockChecked.connect(boost::bind(&CValidationInterface::BlockChecked, pwalletIn, _1, _2));
+    if (nNotifications & NOTIFY_NEW_POW_VALID_BLOCK)
+        g_signals.m_internals->NewPoWValidBlock.connect(boost::bind(&CValidationInterface::NewPoWValidBlock, pwalletIn, _1, _2));
+    if (nNotifications & NOTIFY_BLOCK_FOUND)
+        g_signals.m_internals->BlockFound.connect(boost::bind(&CValidationInterface::BlockFound, pwalletIn, _1));
+    if (nNotifications & NOTIFY_NEW_ASSET_MESSAGE)
+        g_signals.m_internals->NewAssetMessage.connect(boost::bind(&CValidationInterface::NewAssetMessage, pwalletIn, _1));
 //    g_signals.m_internals->ScriptForMining.connect(boost::bind(&CValidationInterface::GetScriptForMining, pwalletIn, _1));
 }
 
+void RegisterValidationInterfaceQueued(CValidationInterface* pinterface, const std::string& strName, unsigned int nNotifications, size_t nMaxDepth) {
+    CValidationInterfaceQueue* pqueue = new CValidationInterfaceQueue(pinterface, strName, nMaxDepth);
+    {
+        std::lock_guard<std::mutex> lock(g_signals.m_internals->m_cs_queues);
+        assert(!g_signals.m_internals->m_queues.count(pinterface));
+        g_signals.m_internals->m_queues[pinterface].reset(pqueue);
+    }
+    // Callbacks left out are never queued, so e.g. BlockChecked doesn't copy the block for nothing
+    RegisterValidationInterface(pqueue, nNotifications);
+}
+
+void FlushValidationInterfaceQueue(CValidationInterface* pinterface) {
+    std::lock_guard<std::mutex> lock(g_signals.m_internals->m_cs_queues);
+    auto it = g_signals.m_internals->m_queues.find(pinterface);
+    if (it != g_signals.m_internals->m_queues.end())
+        it->second->Flush();
+}
+
+std::vector<NotificationQueueInfo> GetNotificationQueueInfo() {
+    std::vector<NotificationQueueInfo> vInfo;
+    std::lock_guard<std::mutex> lock(g_signals.m_internals->m_cs_queues);
+    for (const auto& queue : g_signals.m_internals->m_queues)
+        vInfo.push_back(queue.second->GetInfo());
+    return vInfo;
+}
+
 void UnregisterValidationInterface(CValidationInterface* pwalletIn) {
+    std::unique_ptr<CValidationInterfaceQueue> pqueue;
+    {
+        std::lock_guard<std::mutex> lock(g_signals.m_internals->m_cs_queues);
+        auto it = g_signals.m_internals->m_queues.find(pwalletIn);
+        if (it != g_signals.m_internals->m_queues.end()) {
+            pqueue = std::move(it->second);
+            g_signals.m_internals->m_queues.erase(it);
+        }
+    }
+    if (pqueue) {
+        // Stop queueing, then let the subscriber see what was already queued
+        UnregisterValidationInterface(pqueue.get());
+        pqueue.reset();
+        return;
+    }
+
     g_signals.m_internals->BlockChecked.disconnect(boost::bind(&CValidationInterface::BlockChecked, pwalletIn, _1, _2));
     g_signals.m_internals->Broadcast.disconnect(boost::bind(&CValidationInterface::ResendWalletTransactions, pwalletIn, _1, _2));
     g_signals.m_internals->Inventory.disconnect(boost::bind(&CValidationInterface::Inventory, pwalletIn, _1));
@@ -107,6 +326,12 @@ void UnregisterAllValidationInterfaces() {
     g_signals.m_internals->BlockFound.disconnect_all_slots();
     g_signals.m_internals->NewAssetMessage.disconnect_all_slots();
 //    g_signals.m_internals->ScriptForMining.disconnect_all_slots();
+
+    std::map<CValidationInterface*, std::unique_ptr<CValidationInterfaceQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lock(g_signals.m_internals->m_cs_queues);
+        queues.swap(g_signals.m_internals->m_queues);
+    }
 }
 
 void CMainSignals::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) {
@@ -8,6 +8,8 @@
 #define RAVEN_VALIDATIONINTERFACE_H
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "primitives/transaction.h" // CTransaction(Ref)
 
@@ -23,15 +25,64 @@ class uint256;
 class CScheduler;
 class CMessage;
 
+/** The CValidationInterface callbacks, for picking those a subscriber receives */
+enum ValidationNotifications : unsigned int {
+    NOTIFY_UPDATED_BLOCK_TIP            = (1U << 0),
+    NOTIFY_TRANSACTION_ADDED_TO_MEMPOOL = (1U << 1),
+    NOTIFY_BLOCK_CONNECTED              = (1U << 2),
+    NOTIFY_BLOCK_DISCONNECTED           = (1U << 3),
+    NOTIFY_SET_BEST_CHAIN               = (1U << 4),
+    NOTIFY_INVENTORY                    = (1U << 5),
+    NOTIFY_RESEND_WALLET_TRANSACTIONS   = (1U << 6),
+    NOTIFY_BLOCK_CHECKED                = (1U << 7),
+    NOTIFY_NEW_POW_VALID_BLOCK          = (1U << 8),
+    NOTIFY_BLOCK_FOUND                  = (1U << 9),
+    NOTIFY_NEW_ASSET_MESSAGE            = (1U << 10),
+    NOTIFY_ALL                          = (1U << 11) - 1,
+};
+
 // These functions dispatch to one or all registered wallets
 
-/** Register a wallet to receive updates from core */
-void RegisterValidationInterface(CValidationInterface* pwalletIn);
+/** Register a wallet to receive the updates in nNotifications from core */
+void RegisterValidationInterface(CValidationInterface* pwalletIn, unsigned int nNotifications = NOTIFY_ALL);
 /** Unregister a wallet from core */
 void UnregisterValidationInterface(CValidationInterface* pwalletIn);
 /** Unregister all wallets from core */
 void UnregisterAllValidationInterfaces();
 
+/** Transaction notifications a queued subscriber may fall behind by before further ones are dropped */
+static const size_t DEFAULT_NOTIFICATION_QUEUE_DEPTH = 10000;
+
+/**
+ * Register an interface to receive updates on a thread of its own, through an
+ * ordered queue, so that it neither delays validation nor other subscribers.
+ * Only the callbacks in nNotifications are queued; the others cost nothing.
+ * Once nMaxDepth notifications are waiting, further TransactionAddedToMempool,
+ * Inventory and ResendWalletTransactions ones are dropped; the others are
+ * always delivered. With nMaxDepth 0 nothing is dropped.
+ */
+void RegisterValidationInterfaceQueued(CValidationInterface* pinterface, const std::string& strName, unsigned int nNotifications, size_t nMaxDepth = DEFAULT_NOTIFICATION_QUEUE_DEPTH);
+/**
+ * Wait until the notifications queued so far for an interface have been
+ * delivered; returns at once for one registered without a queue. Don't hold
+ * locks its callbacks take, such as cs_main.
+ */
+void FlushValidationInterfaceQueue(CValidationInterface* pinterface);
+
+/** Delivery statistics of one queued subscriber */
+struct NotificationQueueInfo
+{
+    std::string strName;
+    size_t nDepth;            //!< notifications waiting now
+    size_t nMaxDepth;         //!< most notifications ever waiting at once
+    uint64_t nDelivered;      //!< notifications delivered
+    uint64_t nDropped;        //!< transaction notifications dropped because the queue was full
+    int64_t nTotalLatency;    //!< sum over delivered notifications of the time spent waiting, in microseconds
+    int64_t nMaxLatency;      //!< longest a delivered notification waited, in microseconds
+};
+
+std::vector<NotificationQueueInfo> GetNotificationQueueInfo();
+
 class CValidationInterface {
 protected:
     /**
@@ -74,9 +125,10 @@ protected:
 
 //    virtual void GetScriptForMining(std::shared_ptr<CReserveScript>&) {};
 
-    friend void ::RegisterValidationInterface(CValidationInterface*);
+    friend void ::RegisterValidationInterface(CValidationInterface*, unsigned int);
     friend void ::UnregisterValidationInterface(CValidationInterface*);
     friend void ::UnregisterAllValidationInterfaces();
+    friend class CValidationInterfaceQueue;
 };
 
 struct MainSignalsInstance;
@@ -85,9 +137,12 @@ class CMainSignals {
 private:
     std::unique_ptr<MainSignalsInstance> m_internals;
 
-    friend void ::RegisterValidationInterface(CValidationInterface*);
+    friend void ::RegisterValidationInterface(CValidationInterface*, unsigned int);
     friend void ::UnregisterValidationInterface(CValidationInterface*);
     friend void ::UnregisterAllValidationInterfaces();
+    friend void ::RegisterValidationInterfaceQueued(CValidationInterface*, const std::string&, unsigned int, size_t);
+    friend void ::FlushValidationInterfaceQueue(CValidationInterface*);
+    friend std::vector<NotificationQueueInfo> (::GetNotificationQueueInfo)();
 
 public:
     /** Register a CScheduler to give callbacks which should run in the background (may only be called once) */
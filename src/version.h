@@ -10,7 +10,7 @@
  * network protocol versioning
  */
 
-static const int PROTOCOL_VERSION = 70028;
+static const int PROTOCOL_VERSION = 70029;
 
 //! initial proto version, to be increased after version/verack negotiation
 static const int INIT_PROTO_VERSION = 209;
@@ -60,5 +60,8 @@ static const int ASSETDATA_VERSION_UPDATED = 70020;
 //! In this version, 'rip5 (messaging and restricted assets)' was introduced
 static const int MESSAGING_RESTRICTED_ASSETS_VERSION = 70026;
 
+//! getassetdata is answered with a single massetdata message starting with this version
+static const int ASSETDATA_BATCH_VERSION = 70029;
+
 
 #endif // RAVEN_VERSION_H
@@ -10,6 +10,7 @@
 #include "util.h"
 #include "utilmoneystr.h"
 #include "validation.h"
+#include "validationinterface.h"
 #include "wallet/wallet.h"
 #include "wallet/rpcwallet.h"
 
@@ -276,6 +277,8 @@ void FlushWallets() {
 
 void StopWallets() {
     for (CWalletRef pwallet : vpwallets) {
+        // Deliver what is still queued for it before its database closes
+        UnregisterValidationInterface(pwallet);
         pwallet->Flush(true);
     }
 }
@@ -24,6 +24,7 @@
 #include "util.h"
 #include "utiltime.h"
 #include "utilmoneystr.h"
+#include "validationinterface.h"
 #include "wallet/coincontrol.h"
 #include "wallet/feebumper.h"
 #include "wallet/wallet.h"
@@ -37,7 +38,7 @@
 
 static const std::string WALLET_ENDPOINT_BASE = "/wallet/";
 
-CWallet *GetWalletForJSONRPCRequest(const JSONRPCRequest& request)
+static CWallet *FindWalletForJSONRPCRequest(const JSONRPCRequest& request)
 {
     if (request.URI.substr(0, WALLET_ENDPOINT_BASE.size()) == WALLET_ENDPOINT_BASE) {
         // wallet endpoint was used
@@ -52,6 +53,16 @@ CWallet *GetWalletForJSONRPCRequest(const JSONRPCRequest& request)
     return ::vpwallets.size() == 1 || (request.fHelp && ::vpwallets.size() > 0) ? ::vpwallets[0] : nullptr;
 }
 
+CWallet *GetWalletForJSONRPCRequest(const JSONRPCRequest& request)
+{
+    CWallet *pwallet = FindWalletForJSONRPCRequest(request);
+    // The wallet hears of blocks and transactions through a queue; let it catch up with
+    // those validated so far, so the call sees them
+    if (pwallet && !request.fHelp)
+        FlushValidationInterfaceQueue(pwallet);
+    return pwallet;
+}
+
 
 std::string HelpRequiringPassphrase(CWallet * const pwallet)
 {
@@ -3151,20 +3151,20 @@ bool CWallet::SignTransaction(CMutableTransaction &tx)
 
     // sign the new tx
     CTransaction txNewConst(tx);
-    int nIn = 0;
+    std::vector<CTxOut> vSpent;
     for (const auto& input : tx.vin) {
         std::map<uint256, CWalletTx>::const_iterator mi = mapWallet.find(input.prevout.hash);
         if(mi == mapWallet.end() || input.prevout.n >= mi->second.tx->vout.size()) {
             return false;
         }
-        const CScript& scriptPubKey = mi->second.tx->vout[input.prevout.n].scriptPubKey;
-        const CAmount& amount = mi->second.tx->vout[input.prevout.n].nValue;
-        SignatureData sigdata;
-        if (!ProduceSignature(TransactionSignatureCreator(this, &txNewConst, nIn, amount, SIGHASH_ALL), scriptPubKey, sigdata)) {
-            return false;
-        }
-        UpdateTransaction(tx, nIn, sigdata);
-        nIn++;
+        vSpent.push_back(mi->second.tx->vout[input.prevout.n]);
+    }
+    std::vector<SignatureData> vSigData;
+    if (!ProduceSignatures(*this, txNewConst, vSpent, SIGHASH_ALL, vSigData, nScriptCheckThreads)) {
+        return false;
+    }
+    for (unsigned int nIn = 0; nIn < tx.vin.size(); nIn++) {
+        UpdateTransaction(tx, nIn, vSigData[nIn]);
     }
     return true;
 }
@@ -3772,41 +3772,25 @@ bool CWallet::CreateTransactionAll(const std::vector<CRecipient>& vecSend, CWall
         if (sign)
         {
             CTransaction txNewConst(txNew);
-            int nIn = 0;
+            std::vector<CTxOut> vSpent;
             for (const auto& coin : setCoins)
-            {
-                const CScript& scriptPubKey = coin.txout.scriptPubKey;
-                SignatureData sigdata;
-
-                if (!ProduceSignature(TransactionSignatureCreator(this, &txNewConst, nIn, coin.txout.nValue, SIGHASH_ALL), scriptPubKey, sigdata))
-                {
-                    strFailReason = _("Signing transaction failed");
-                    return false;
-                } else {
-                    UpdateTransaction(txNew, nIn, sigdata);
-                }
-
-                nIn++;
-            }
+                vSpent.push_back(coin.txout);
             /** RVN START */
             if (AreAssetsDeployed()) {
-                for (const auto &asset : setAssets) {
-                    const CScript &scriptPubKey = asset.txout.scriptPubKey;
-                    SignatureData sigdata;
-
-                    if (!ProduceSignature(
-                            TransactionSignatureCreator(this, &txNewConst, nIn, asset.txout.nValue, SIGHASH_ALL),
-                            scriptPubKey, sigdata)) {
-                        strFailReason = _("Signing asset transaction failed");
-                        return false;
-                    } else {
-                        UpdateTransaction(txNew, nIn, sigdata);
-                    }
-
-                    nIn++;
-                }
+                for (const auto &asset : setAssets)
+                    vSpent.push_back(asset.txout);
             }
             /** RVN END */
+
+            std::vector<SignatureData> vSigData;
+            unsigned int nFailedIn;
+            if (!ProduceSignatures(*this, txNewConst, vSpent, SIGHASH_ALL, vSigData, nScriptCheckThreads, &nFailedIn))
+            {
+                strFailReason = nFailedIn < setCoins.size() ? _("Signing transaction failed") : _("Signing asset transaction failed");
+                return false;
+            }
+            for (unsigned int nIn = 0; nIn < txNew.vin.size(); nIn++)
+                UpdateTransaction(txNew, nIn, vSigData[nIn]);
         }
 
         // Embed the constructed transaction data in wtxNew.
@@ -4498,19 +4482,24 @@ void CWallet::GetScriptForMining(std::shared_ptr<CReserveScript> &script)
 void CWallet::LockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
-    setLockedCoins.insert(output);
+    if (setLockedCoins.insert(output).second)
+        NotifyCoinLockChanged(this, output, true);
 }
 
 void CWallet::UnlockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
-    setLockedCoins.erase(output);
+    if (setLockedCoins.erase(output))
+        NotifyCoinLockChanged(this, output, false);
 }
 
 void CWallet::UnlockAllCoins()
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
-    setLockedCoins.clear();
+    std::set<COutPoint> setUnlocked;
+    setUnlocked.swap(setLockedCoins);
+    for (const COutPoint& output : setUnlocked)
+        NotifyCoinLockChanged(this, output, false);
 }
 
 bool CWallet::IsLockedCoin(uint256 hash, unsigned int n) const
@@ -4823,7 +4812,10 @@ CWallet* CWallet:: CreateWalletFromFile(const std::string walletFile)
 
     LogPrintf(" wallet      %15dms\n", GetTimeMillis() - nStart);
 
-    RegisterValidationInterface(walletInstance);
+    // Wallet RPCs wait for the queue to catch up, see GetWalletForJSONRPCRequest
+    RegisterValidationInterfaceQueued(walletInstance, "wallet",
+            NOTIFY_TRANSACTION_ADDED_TO_MEMPOOL | NOTIFY_BLOCK_CONNECTED | NOTIFY_BLOCK_DISCONNECTED |
+            NOTIFY_SET_BEST_CHAIN | NOTIFY_INVENTORY | NOTIFY_RESEND_WALLET_TRANSACTIONS, 0);
 
     // Try to top up keypool. No-op if the wallet is locked.
     walletInstance->TopUpKeyPool();
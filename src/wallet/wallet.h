@@ -1160,6 +1160,12 @@ public:
     boost::signals2::signal<void (CWallet *wallet, std::string& address, std::string& asset_name,
                                   int type, uint32_t date)> NotifyMyRestrictedAssetsChanged;
 
+    /**
+     * Wallet coin locked or unlocked.
+     * @note called with lock cs_wallet held.
+     */
+    boost::signals2::signal<void (CWallet *wallet, const COutPoint &output, bool fLocked)> NotifyCoinLockChanged;
+
     /** Show progress e.g. for rescan */
     boost::signals2::signal<void (const std::string &title, int nProgress)> ShowProgress;
 
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+# Copyright (c) 2017-2020 The Raven Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+"""
+Test how getassetdata requests are answered.
+
+- Peers at ASSETDATA_BATCH_VERSION or later get one massetdata message per
+  request, older peers one assetdata message per asset. Both carry the same
+  serialized entries.
+- Unknown but valid names are answered with a _NF entry, invalid names are
+  skipped, oversized requests are rejected and oversized names get the peer
+  disconnected.
+- Cached answers are dropped when the block that issued the asset is
+  disconnected, and found again once it is reconnected.
+
+Assets are issued with raw transactions spending anyone-can-spend coinbases,
+so the test doesn't need a wallet.
+"""
+
+from test_framework.mininode import NodeConn, NodeConnCB, NetworkThread, MsgGetAssetData, CTransaction, from_hex, to_hex, mininode_lock
+from test_framework.address import script_to_p2sh
+from test_framework.script import CScript, OP_TRUE
+from test_framework.test_framework import RavenTestFramework
+from test_framework.util import assert_equal, p2p_port, wait_until
+
+ASSETDATA_BATCH_VERSION = 70029
+MAX_ASSET_INV_SZ = 1024
+MAX_ASSET_LENGTH = 32
+BURN_ADDRESS = "n1issueAssetXXXXXXXXXXXXXXXXWdnemQ"
+HOLDER_ADDRESS = "mneYUmWYsuk7kySiURxCi3AGxrAqZxLgPZ"
+NOT_FOUND = b"_NF"
+
+
+class AssetDataPeer(NodeConnCB):
+    """Collects the asset data entries received, in order."""
+
+    def __init__(self):
+        super().__init__()
+        self.entries = []
+
+    def on_assetdata(self, conn, message):
+        self.entries.append(message.asset_data)
+
+    def on_massetdata(self, conn, message):
+        self.entries.extend(message.asset_data)
+
+    def request(self, names):
+        """Send a getassetdata for names and return the entries the node answers with."""
+        with mininode_lock:
+            self.entries = []
+            count = {"assetdata": self.message_count["assetdata"], "massetdata": self.message_count["massetdata"]}
+        self.send_message(MsgGetAssetData(names))
+        self.sync_with_ping()
+        with mininode_lock:
+            return list(self.entries), {c: self.message_count[c] - n for c, n in count.items()}
+
+
+class AssetDataTest(RavenTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+
+    def issue(self, name, units):
+        """Issue name from the next mature anyone-can-spend coinbase, returning the transaction id."""
+        node = self.nodes[0]
+        coinbase = node.getblock(node.getblockhash(self.next_coinbase), 2)['tx'][0]
+        self.next_coinbase += 1
+
+        raw = node.createrawtransaction([{"txid": coinbase['txid'], "vout": 0}], {
+            BURN_ADDRESS: 500,
+            self.anyone_address: float(coinbase['vout'][0]['value']) - 500 - 0.01,
+            HOLDER_ADDRESS: {"issue": {"asset_name": name, "asset_quantity": 1000, "units": units, "reissuable": 1, "has_ipfs": 0}}})
+        tx = from_hex(CTransaction(), raw)
+        tx.vin[0].scriptSig = CScript([self.anyone_script])
+        return node.sendrawtransaction(to_hex(tx))
+
+    def connect_peer(self, protocol_version):
+        peer = AssetDataPeer()
+        peer.add_connection(NodeConn('127.0.0.1', p2p_port(0), self.nodes[0], peer, protocol_version=protocol_version))
+        return peer
+
+    def run_test(self):
+        node = self.nodes[0]
+        assert_equal(node.getnetworkinfo()['protocolversion'], ASSETDATA_BATCH_VERSION)
+
+        self.log.info("Activating assets and issuing from anyone-can-spend coinbases...")
+        self.anyone_script = CScript([OP_TRUE])
+        self.anyone_address = script_to_p2sh(self.anyone_script)
+        node.generatetoaddress(432, self.anyone_address)
+        assert_equal("active", node.getblockchaininfo()['bip9_softforks']['assets']['status'])
+        self.next_coinbase = 1
+
+        for name, units in (("ASSET_A", 0), ("ASSET_B", 2), ("ASSET_C", 8)):
+            self.issue(name, units)
+        node.generatetoaddress(1, self.anyone_address)
+        issued_height = node.getblockcount()
+        self.issue("ASSET_D", 4)
+        late_block = node.generatetoaddress(1, self.anyone_address)[0]
+        assert_equal(node.getassetdata("ASSET_D")["units"], 4)
+
+        old_peer = self.connect_peer(ASSETDATA_BATCH_VERSION - 1)
+        new_peer = self.connect_peer(ASSETDATA_BATCH_VERSION)
+        NetworkThread().start()
+        old_peer.wait_for_verack()
+        new_peer.wait_for_verack()
+
+        names = [b"ASSET_A", b"ASSET_B", b"NO_SUCH_ASSET", b"not a valid name", b"ASSET_C"]
+
+        self.log.info("Batching peers get one massetdata message...")
+        batched, counts = new_peer.request(names)
+        assert_equal(counts, {"assetdata": 0, "massetdata": 1})
+        # The invalid name is skipped, the unknown one is answered as not found
+        assert_equal([e.name for e in batched], [b"ASSET_A", b"ASSET_B", NOT_FOUND, b"ASSET_C"])
+        assert_equal([e.units for e in batched if e.name != NOT_FOUND], [0, 2, 8])
+        assert_equal(batched[0].amount, 1000 * 100000000)
+        assert_equal(batched[0].height, issued_height)
+
+        self.log.info("Older peers get one assetdata message per asset, with the same entries...")
+        single, counts = old_peer.request(names)
+        assert_equal(counts, {"assetdata": 4, "massetdata": 0})
+        assert_equal([e.serialize() for e in single], [e.serialize() for e in batched])
+
+        self.log.info("Full requests are answered in one message, larger ones are rejected...")
+        full, counts = new_peer.request([b"ASSET_A", b"NO_SUCH_ASSET"] * (MAX_ASSET_INV_SZ // 2))
+        assert_equal(counts, {"assetdata": 0, "massetdata": 1})
+        assert_equal(len(full), MAX_ASSET_INV_SZ)
+        assert_equal(full[-2].serialize(), batched[0].serialize())
+        assert_equal(full[-1].name, NOT_FOUND)
+        _, counts = new_peer.request([b"ASSET_A"] * (MAX_ASSET_INV_SZ + 1))
+        assert_equal(counts, {"assetdata": 0, "massetdata": 0})
+        assert new_peer.connected
+
+        self.log.info("Cached answers follow the asset being disconnected and reconnected...")
+        entries, _ = new_peer.request([b"ASSET_D", b"ASSET_A"])
+        assert_equal([(e.name, e.units) for e in entries], [(b"ASSET_D", 4), (b"ASSET_A", 0)])
+        node.invalidateblock(late_block)
+        entries, _ = new_peer.request([b"ASSET_D", b"ASSET_A"])
+        assert_equal([e.name for e in entries], [NOT_FOUND, b"ASSET_A"])
+        node.reconsiderblock(late_block)
+        entries, _ = new_peer.request([b"ASSET_D"])
+        assert_equal([(e.name, e.units, e.height) for e in entries], [(b"ASSET_D", 4, issued_height + 1)])
+
+        self.log.info("Names longer than any asset name get the peer disconnected...")
+        new_peer.send_message(MsgGetAssetData([b"A" * (MAX_ASSET_LENGTH + 1)]))
+        new_peer.wait_for_disconnect()
+        assert old_peer.connected
+        wait_until(lambda: len(node.getpeerinfo()) == 1, err_msg="peer disconnected")
+
+
+if __name__ == '__main__':
+    AssetDataTest().main()
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+# Copyright (c) 2017-2020 The Raven Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+"""
+Test that block download quotas follow each peer's measured delivery rate.
+
+- node1 mines a chain longer than the block download window.
+- A slow peer announces the chain to node0, withholds the first block it is
+  asked for and delivers a few of the others with an artificial delay. Its
+  in-flight quota drops below the default.
+- A fast peer announces the same chain and answers every request at once.
+  Its quota rises above the default, and once the withheld block holds the
+  download window open, node0 re-requests it from the fast peer while the
+  slow peer is still connected. Blocks the slow peer is later asked for near
+  the tip are taken over the same way rather than timing out.
+"""
+
+import time
+from test_framework.mininode import NodeConn, NodeConnCB, NetworkThread, MsgGeneric, NODE_NETWORK, NODE_WITNESS, mininode_lock
+from test_framework.messages import ser_compact_size
+from test_framework.test_framework import RavenTestFramework
+from test_framework.util import assert_equal, assert_greater_than, hex_str_to_bytes, p2p_port, wait_until
+
+NUM_BLOCKS = 1100                # more than BLOCK_DOWNLOAD_WINDOW (1024)
+MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16
+SLOW_DELIVERY_INTERVAL = 0.5     # seconds between blocks delivered by the slow peer
+SLOW_DELIVERED_BLOCKS = 6
+
+
+class BlockServer(NodeConnCB):
+    """Announces a prepared chain and serves its blocks from raw serializations."""
+
+    def __init__(self, blocks, headers, answer_getdata):
+        super().__init__()
+        self.blocks = blocks
+        self.headers = headers
+        self.answer_getdata = answer_getdata
+        self.requested = []
+
+    def on_getdata(self, conn, message):
+        for inv in message.inv:
+            if inv.hash not in self.blocks:
+                continue
+            self.requested.append(inv.hash)
+            if self.answer_getdata:
+                conn.send_message(MsgGeneric(b"block", self.blocks[inv.hash]))
+
+    def announce(self):
+        self.send_message(MsgGeneric(b"headers", ser_compact_size(len(self.headers)) + b"".join(h + b"\x00" for h in self.headers)))
+
+    def send_block(self, block_hash):
+        self.send_message(MsgGeneric(b"block", self.blocks[block_hash]))
+
+
+class BlockDownloadRateTest(RavenTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+
+    def setup_network(self):
+        # node0 syncs only from the test peers
+        self.setup_nodes()
+
+    def peer_info(self, peer):
+        port = peer.connection.socket.getsockname()[1]
+        return next(p for p in self.nodes[0].getpeerinfo() if p['addr'] == '127.0.0.1:%d' % port)
+
+    def run_test(self):
+        node0, node1 = self.nodes[0], self.nodes[1]
+
+        self.log.info("Mining %d blocks on node1..." % NUM_BLOCKS)
+        hashes = node1.generatetoaddress(NUM_BLOCKS, 'mneYUmWYsuk7kySiURxCi3AGxrAqZxLgPZ')
+        blocks = {int(h, 16): hex_str_to_bytes(node1.getblock(h, False)) for h in hashes}
+        headers = [hex_str_to_bytes(node1.getblockheader(h, False)) for h in hashes]
+        first = int(hashes[0], 16)
+
+        slow_peer = BlockServer(blocks, headers, answer_getdata=False)
+        fast_peer = BlockServer(blocks, headers, answer_getdata=True)
+        connections = [NodeConn('127.0.0.1', p2p_port(0), node0, slow_peer, services=NODE_NETWORK | NODE_WITNESS)]
+        slow_peer.add_connection(connections[0])
+        NetworkThread().start()
+        slow_peer.wait_for_verack()
+
+        self.log.info("Slow peer is asked for the default quota of blocks...")
+        slow_peer.announce()
+        wait_until(lambda: len(slow_peer.requested) == MAX_BLOCKS_IN_TRANSIT_PER_PEER, err_msg="slow peer requests", lock=mininode_lock)
+        assert_equal(self.peer_info(slow_peer)['inflight_quota'], MAX_BLOCKS_IN_TRANSIT_PER_PEER)
+        with mininode_lock:
+            assert_equal(slow_peer.requested[0], first)
+            delayed = slow_peer.requested[1:SLOW_DELIVERED_BLOCKS + 1]
+
+        self.log.info("Slow peer withholds the first block and delivers %d others every %.1fs..." % (SLOW_DELIVERED_BLOCKS, SLOW_DELIVERY_INTERVAL))
+        for block_hash in delayed:
+            time.sleep(SLOW_DELIVERY_INTERVAL)
+            slow_peer.send_block(block_hash)
+        slow_peer.sync_with_ping()
+        slow_info = self.peer_info(slow_peer)
+        assert_greater_than(MAX_BLOCKS_IN_TRANSIT_PER_PEER, slow_info['inflight_quota'])
+        assert_greater_than(slow_info['block_latency'], SLOW_DELIVERY_INTERVAL)
+        assert_equal(node0.getblockcount(), 0)
+
+        self.log.info("Fast peer fills its larger quota and takes over the withheld block...")
+        connections.append(NodeConn('127.0.0.1', p2p_port(0), node0, fast_peer, services=NODE_NETWORK | NODE_WITNESS))
+        fast_peer.add_connection(connections[1])
+        fast_peer.wait_for_verack()
+        fast_peer.announce()
+        wait_until(lambda: first in fast_peer.requested, err_msg="withheld block re-requested", timeout=60, lock=mininode_lock)
+        assert slow_peer.connected
+        fast_info = self.peer_info(fast_peer)
+        assert_greater_than(fast_info['inflight_quota'], MAX_BLOCKS_IN_TRANSIT_PER_PEER)
+        assert_greater_than(slow_info['block_latency'], fast_info['block_latency'])
+
+        self.log.info("node0 syncs the whole chain without waiting out the slow peer's block download timeout...")
+        wait_until(lambda: node0.getblockcount() == NUM_BLOCKS, err_msg="node0 synced", timeout=30)
+        assert_equal(node0.getbestblockhash(), hashes[-1])
+        assert slow_peer.connected
+
+if __name__ == '__main__':
+    BlockDownloadRateTest().main()
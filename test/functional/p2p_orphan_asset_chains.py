@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+# Copyright (c) 2017-2020 The Raven Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+"""Test that chains of asset transfers arriving out of order are kept in the orphan pool and resolved together"""
+
+from test_framework.mininode import NodeConn, NodeConnCB, NetworkThread, MsgTx, CTransaction, CTxIn, CTxOut, COutPoint, from_hex
+from test_framework.script import CScript, OP_HASH160, OP_EQUAL, hash160
+from test_framework.test_framework import RavenTestFramework
+from test_framework.util import assert_equal, disconnect_all_nodes, p2p_port, wait_until
+
+import random
+
+CHAIN_LENGTH = 20
+MAX_ORPHANS = 40
+
+class OrphanAssetChainTest(RavenTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [[], ['-maxorphantx=%d' % MAX_ORPHANS]]
+
+    def activate_assets(self):
+        self.log.info("Generating RVN and activating assets...")
+        n0, n1 = self.nodes[0], self.nodes[1]
+
+        n0.generate(1)
+        self.sync_all()
+        n0.generate(216)
+        self.sync_all()
+        n1.generate(216)
+        self.sync_all()
+        assert_equal("active", n0.getblockchaininfo()['bip9_softforks']['assets']['status'])
+
+    def build_transfer_chain(self, asset_name):
+        """Issue an asset on node 0 and spend it through a chain of unconfirmed transfers node 1 never sees"""
+        n0 = self.nodes[0]
+        n0.issue(asset_name, 1000)
+        n0.generate(1)
+        self.sync_all()
+        disconnect_all_nodes(self.nodes)
+
+        txids = []
+        for _ in range(CHAIN_LENGTH):
+            txids += n0.transfer(asset_name, 1, n0.getnewaddress())
+        assert_equal(len(txids), CHAIN_LENGTH)
+        return txids, [from_hex(CTransaction(), n0.getrawtransaction(txid)) for txid in txids]
+
+    def flood_orphan(self):
+        """A standard transaction spending an output nobody has seen, larger than an asset transfer"""
+        tx = CTransaction()
+        tx.vin.append(CTxIn(COutPoint(random.getrandbits(256), 0), CScript([b'\x00' * 500, b'\x00' * 500])))
+        tx.vout.append(CTxOut(100000000, CScript([OP_HASH160, hash160(b'orphan'), OP_EQUAL])))
+        tx.rehash()
+        return tx
+
+    def run_test(self):
+        self.activate_assets()
+        n1 = self.nodes[1]
+
+        txids, txs = self.build_transfer_chain("ORPHAN_CHAIN")
+
+        chain_peer = NodeConnCB()
+        flood_peer = NodeConnCB()
+        connections = [NodeConn('127.0.0.1', p2p_port(1), n1, chain_peer),
+                       NodeConn('127.0.0.1', p2p_port(1), n1, flood_peer)]
+        chain_peer.add_connection(connections[0])
+        flood_peer.add_connection(connections[1])
+        NetworkThread().start()
+        chain_peer.wait_for_verack()
+        flood_peer.wait_for_verack()
+
+        self.log.info("Relaying the transfer chain tail first, without its root...")
+        for tx in reversed(txs[1:]):
+            chain_peer.send_message(MsgTx(tx))
+        chain_peer.sync_with_ping()
+        info = n1.getmempoolinfo()
+        assert_equal(info['size'], 0)
+        assert_equal(info['orphans'], CHAIN_LENGTH - 1)
+
+        self.log.info("Flooding orphans from another peer past -maxorphantx...")
+        for _ in range(2 * MAX_ORPHANS):
+            flood_peer.send_message(MsgTx(self.flood_orphan()))
+        flood_peer.sync_with_ping()
+        info = n1.getmempoolinfo()
+        assert_equal(info['orphans'], MAX_ORPHANS)
+        assert_equal(info['orphansevicted'], MAX_ORPHANS + CHAIN_LENGTH - 1)
+
+        self.log.info("Relaying the root resolves the whole chain in one pass...")
+        chain_peer.send_and_ping(MsgTx(txs[0]))
+        wait_until(lambda: n1.getmempoolinfo()['size'] == CHAIN_LENGTH, err_msg="chain accepted", timeout=30)
+        assert_equal(sorted(n1.getrawmempool()), sorted(txids))
+        info = n1.getmempoolinfo()
+        assert_equal(info['orphansresolved'], CHAIN_LENGTH - 1)
+        assert_equal(info['orphansremoved'], 0)
+        assert_equal(info['orphans'], MAX_ORPHANS - (CHAIN_LENGTH - 1))
+
+if __name__ == '__main__':
+    OrphanAssetChainTest().main()
@@ -1646,3 +1646,92 @@ class MsgWitnessBlocktxn(MsgBlockTxn):
         r = b""
         r += self.block_transactions.serialize(with_witness=True)
         return r
+
+
+class CAssetData:
+    """Asset metadata as sent in assetdata and massetdata messages. A name of b"_NF" means not found."""
+    __slots__ = ("name", "amount", "units", "reissuable", "has_ipfs", "ipfs", "height")
+
+    def __init__(self):
+        self.name = b""
+        self.amount = 0
+        self.units = 0
+        self.reissuable = 0
+        self.has_ipfs = 0
+        self.ipfs = b""
+        self.height = 0
+
+    def deserialize(self, f):
+        self.name = deser_string(f)
+        self.amount = struct.unpack("<q", f.read(8))[0]
+        self.units = struct.unpack("<b", f.read(1))[0]
+        self.reissuable = struct.unpack("<b", f.read(1))[0]
+        self.has_ipfs = struct.unpack("<b", f.read(1))[0]
+        self.ipfs = deser_string(f)
+        self.height = struct.unpack("<i", f.read(4))[0]
+
+    def serialize(self):
+        r = b""
+        r += ser_string(self.name)
+        r += struct.pack("<q", self.amount)
+        r += struct.pack("<b", self.units)
+        r += struct.pack("<b", self.reissuable)
+        r += struct.pack("<b", self.has_ipfs)
+        r += ser_string(self.ipfs)
+        r += struct.pack("<i", self.height)
+        return r
+
+    def __repr__(self):
+        return "CAssetData(name=%s amount=%i units=%i reissuable=%i has_ipfs=%i height=%i)" \
+               % (self.name, self.amount, self.units, self.reissuable, self.has_ipfs, self.height)
+
+
+class MsgGetAssetData:
+    __slots__ = "names"
+    command = b"getassetdata"
+
+    def __init__(self, names=None):
+        self.names = names or []
+
+    def deserialize(self, f):
+        self.names = deser_string_vector(f)
+
+    def serialize(self):
+        return ser_string_vector(self.names)
+
+    def __repr__(self):
+        return "msg_getassetdata(names=%s)" % (repr(self.names))
+
+
+class MsgAssetData:
+    __slots__ = "asset_data"
+    command = b"assetdata"
+
+    def __init__(self, asset_data=None):
+        self.asset_data = asset_data or CAssetData()
+
+    def deserialize(self, f):
+        self.asset_data.deserialize(f)
+
+    def serialize(self):
+        return self.asset_data.serialize()
+
+    def __repr__(self):
+        return "msg_assetdata(asset_data=%s)" % (repr(self.asset_data))
+
+
+class MsgMultiAssetData:
+    __slots__ = "asset_data"
+    command = b"massetdata"
+
+    def __init__(self, asset_data=None):
+        self.asset_data = asset_data or []
+
+    def deserialize(self, f):
+        self.asset_data = deser_vector(f, CAssetData)
+
+    def serialize(self):
+        return ser_vector(self.asset_data)
+
+    def __repr__(self):
+        return "msg_massetdata(asset_data=%s)" % (repr(self.asset_data))
@@ -112,6 +112,9 @@ class NodeConnCB:
     def on_alert(self, conn, message):
         pass
 
+    def on_assetdata(self, conn, message):
+        pass
+
     def on_block(self, conn, message):
         pass
 
@@ -127,6 +130,9 @@ class NodeConnCB:
     def on_getaddr(self, conn, message):
         pass
 
+    def on_getassetdata(self, conn, message):
+        pass
+
     def on_getblocks(self, conn, message):
         pass
 
@@ -142,6 +148,9 @@ class NodeConnCB:
     def on_headers(self, conn, message):
         pass
 
+    def on_massetdata(self, conn, message):
+        pass
+
     def on_mempool(self, conn):
         pass
 
@@ -270,7 +279,10 @@ class NodeConn(asyncore.dispatcher):
         b"sendcmpct": MsgSendCmpct,
         b"cmpctblock": MsgCmpctBlock,
         b"getblocktxn": MsgGetBlockTxn,
-        b"blocktxn": MsgBlockTxn
+        b"blocktxn": MsgBlockTxn,
+        b"getassetdata": MsgGetAssetData,
+        b"assetdata": MsgAssetData,
+        b"massetdata": MsgMultiAssetData
     }
 
     MAGIC_BYTES = {
@@ -279,7 +291,7 @@ class NodeConn(asyncore.dispatcher):
         "regtest": b"\x43\x52\x4f\x57",  # regtest
     }
 
-    def __init__(self, dstaddr, dstport, rpc, callback, net="regtest", services=NODE_NETWORK, send_version=True):
+    def __init__(self, dstaddr, dstport, rpc, callback, net="regtest", services=NODE_NETWORK, send_version=True, protocol_version=MY_VERSION):
         asyncore.dispatcher.__init__(self, map=mininode_socket_map)
         self.dstaddr = dstaddr
         self.dstport = dstport
@@ -299,6 +311,7 @@ class NodeConn(asyncore.dispatcher):
         if send_version:
             # stuff version msg into sendbuf
             vt = MsgVersion()
+            vt.nVersion = protocol_version
             vt.nServices = services
             vt.addrTo.ip = self.dstaddr
             vt.addrTo.port = self.dstport
@@ -88,6 +88,9 @@ BASE_SCRIPTS= [
     'feature_messaging.py',
     'feature_assets_reorg.py',
     'feature_assets_mempool.py',
+    'p2p_orphan_asset_chains.py',
+    'p2p_block_download_rate.py',
+    'p2p_assetdata.py',
     'feature_restricted_assets.py',
     'feature_raw_restricted_assets.py',
     'wallet_bip44.py',